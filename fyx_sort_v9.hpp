@@ -187,11 +187,15 @@ namespace static_checks {
 #include <condition_variable>
 #include <limits>
 #include <new>
+#include <memory>
 #include <deque>
 #include <random>
 #include <tuple>
 #include <cassert>
 #include <chrono>
+#include <string>
+#include <string_view>
+#include <stdexcept>
 
 #if defined(_MSC_VER) || defined(__MINGW32__)
     #include <malloc.h>
@@ -252,6 +256,51 @@ namespace static_checks {
     #define FYX_SIMD_WIDTH 8
 #endif
 
+// 运行时ISA分派: GCC/Clang在x86上借助target属性为AVX2/AVX-512各编译一份内核，
+// 首次使用时按cpu::Features选定；编译期已开启的指令集不加属性、直接调用
+#if defined(FYX_X86) && (defined(__GNUC__) || defined(__clang__)) && !defined(FYX_NO_RUNTIME_DISPATCH)
+    #define FYX_RUNTIME_DISPATCH 1
+#endif
+
+// 内核需要F/DQ/BW/VL全套；编译期只开了部分AVX-512时仍按target属性编译
+#if defined(FYX_AVX512_FULL)
+    #define FYX_AVX512_KERNELS 1
+    #define FYX_TARGET_AVX512
+#elif defined(FYX_RUNTIME_DISPATCH)
+    #define FYX_AVX512_KERNELS 1
+    #define FYX_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512bw,avx512vl,avx2,bmi,bmi2,popcnt")))
+#elif defined(FYX_AVX512)
+    #define FYX_AVX512_KERNELS 1
+    #define FYX_TARGET_AVX512
+#endif
+
+#if defined(FYX_AVX2)
+    #define FYX_AVX2_KERNELS 1
+    #define FYX_TARGET_AVX2
+#elif defined(FYX_RUNTIME_DISPATCH)
+    #define FYX_AVX2_KERNELS 1
+    #define FYX_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#endif
+
+// SSE4.2内核: x86-64基线构建 (无AVX2) 的向量层；运行时分派下同样编译一份，供不支持AVX2的CPU使用
+#if defined(FYX_SSE42)
+    #define FYX_SSE42_KERNELS 1
+    #define FYX_TARGET_SSE42
+#elif defined(FYX_RUNTIME_DISPATCH)
+    #define FYX_SSE42_KERNELS 1
+    #define FYX_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#endif
+
+// 冲突检测(AVX512CD)直方图内核: 编译期已开启直接调用，否则在运行时分派下单独编译，
+// 使用前再按cpu::Features确认CPU支持
+#if defined(FYX_AVX512_KERNELS) && defined(__AVX512CD__)
+    #define FYX_AVX512CD_KERNELS 1
+    #define FYX_TARGET_AVX512CD FYX_TARGET_AVX512
+#elif defined(FYX_AVX512_KERNELS) && defined(FYX_RUNTIME_DISPATCH)
+    #define FYX_AVX512CD_KERNELS 1
+    #define FYX_TARGET_AVX512CD __attribute__((target("avx512f,avx512cd,avx512dq,avx512bw,avx512vl,avx2,bmi,bmi2,popcnt")))
+#endif
+
 // C++版本检测
 #if __cplusplus >= 202002L
     #define FYX_CPP20 1
@@ -276,6 +325,7 @@ namespace cpu {
         bool avx512dq = false;
         bool avx512bw = false;
         bool avx512vl = false;
+        bool avx512cd = false;
         bool popcnt = false;
         bool bmi1 = false;
         bool bmi2 = false;
@@ -314,29 +364,39 @@ namespace cpu {
                 f.avx512dq = (cpuinfo[1] & (1 << 17)) != 0;
                 f.avx512bw = (cpuinfo[1] & (1 << 30)) != 0;
                 f.avx512vl = (cpuinfo[1] & (1u << 31)) != 0;
+                f.avx512cd = (cpuinfo[1] & (1 << 28)) != 0;
             }
     #elif defined(__GNUC__) || defined(__clang__)
             unsigned int eax, ebx, ecx, edx;
             if (__get_cpuid(0, &eax, &ebx, &ecx, &edx)) {
                 unsigned int max_id = eax;
                 
+                // 操作系统须通过XCR0开启YMM/ZMM状态保存，否则即使CPU支持也不可用
+                bool os_ymm = false, os_zmm = false;
                 if (max_id >= 1) {
                     __get_cpuid(1, &eax, &ebx, &ecx, &edx);
                     f.sse2 = (edx & (1 << 26)) != 0;
                     f.sse42 = (ecx & (1 << 20)) != 0;
-                    f.avx = (ecx & (1 << 28)) != 0;
                     f.popcnt = (ecx & (1 << 23)) != 0;
+                    if (ecx & (1 << 27)) {
+                        unsigned int xcr0_lo, xcr0_hi;
+                        __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+                        os_ymm = (xcr0_lo & 0x06) == 0x06;
+                        os_zmm = (xcr0_lo & 0xE6) == 0xE6;
+                    }
+                    f.avx = os_ymm && (ecx & (1 << 28)) != 0;
                 }
                 
                 if (max_id >= 7) {
                     __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
-                    f.avx2 = (ebx & (1 << 5)) != 0;
+                    f.avx2 = os_ymm && (ebx & (1 << 5)) != 0;
                     f.bmi1 = (ebx & (1 << 3)) != 0;
                     f.bmi2 = (ebx & (1 << 8)) != 0;
-                    f.avx512f = (ebx & (1 << 16)) != 0;
-                    f.avx512dq = (ebx & (1 << 17)) != 0;
-                    f.avx512bw = (ebx & (1 << 30)) != 0;
-                    f.avx512vl = (ebx & (1u << 31)) != 0;
+                    f.avx512f = os_zmm && (ebx & (1 << 16)) != 0;
+                    f.avx512dq = os_zmm && (ebx & (1 << 17)) != 0;
+                    f.avx512bw = os_zmm && (ebx & (1 << 30)) != 0;
+                    f.avx512vl = os_zmm && (ebx & (1u << 31)) != 0;
+                    f.avx512cd = os_zmm && (ebx & (1 << 28)) != 0;
                 }
             }
     #endif
@@ -359,6 +419,9 @@ namespace cpu {
             f.avx512bw = true;
             f.avx512vl = true;
     #endif
+#endif
+#ifdef __AVX512CD__
+            f.avx512cd = true;
 #endif
             f.initialized = true;
         }
@@ -414,6 +477,29 @@ namespace config {
     inline constexpr size_t COUNTING_MAX_RANGE = 1000000;
     inline constexpr size_t COUNTING_MIN_SIZE = 256;
     
+    // 选择算法阈值
+    inline constexpr size_t SELECT_CUTOFF = 512;          // 小区间交给std::nth_element
+    inline constexpr size_t PARTIAL_SORT_HEAP_K = 16;      // k很小时堆方法更快
+    inline constexpr size_t PARTIAL_SORT_HEAP_RATIO = 256; // k <= n/256时同样走堆方法
+    inline constexpr size_t PARTIAL_SORT_MIN_SIZE = 1024;
+    
+    // 字符串排序阈值
+    inline constexpr size_t STRING_INSERTION_THRESHOLD = 16;  // 从当前深度起的插入排序
+    inline constexpr size_t STRING_MKQS_THRESHOLD = 512;      // 小于此值用多键快排代替257桶MSD
+    inline constexpr size_t STRING_PREFIX_MIN_SIZE = 4096;    // 前缀缓存(8字节键+下标)路径的最小规模
+    inline constexpr size_t BYTES_RADIX_THRESHOLD = 64;       // 定长字节键: 小桶改用memcmp比较排序
+    
+    // 向量化快排阈值
+    inline constexpr size_t VQSORT_MIN_SIZE = 256;  // 更小的数组标量pdq已足够快
+    inline constexpr size_t VQSORT_BASE = 32;       // 分区到此规模后交给排序网络
+    inline constexpr size_t SIMD_RANK_SORT_LIMIT = 64; // 整数小数组的SIMD计数名次排序上限
+    inline constexpr size_t SIMD_NETWORK_LIMIT = 256;  // 补齐双调网络可处理的最大长度
+    
+    // 直方图内核选择 (分散计数器 vs AVX-512冲突检测，后者需定义FYX_CONFLICT_HISTOGRAM)
+    inline constexpr size_t HIST_CONFLICT_MIN_SIZE = 4096;  // 更小的输入不值得采样
+    inline constexpr size_t HIST_SKEW_SAMPLES = 64;         // 判断数字分布倾斜的采样数
+    inline constexpr size_t HIST_SKEW_THRESHOLD = 48;       // 采样中单一数字占到3/4即视为倾斜
+    
     // 内存安全阈值
     inline constexpr size_t MAX_ALLOC_SIZE = size_t(1) << 40; // 1TB
     
@@ -473,6 +559,7 @@ struct Options {
     bool force_comparison = false;
     bool adaptive = true;          // 自适应算法选择
     bool prefetch_aggressive = true; // 激进预取
+    bool transform_keys = true;    // 基数排序前把浮点/有符号键原地换成无符号键，结束后换回
     
     static Options defaults() { return {}; }
     static Options sequential() { Options o; o.parallel = false; return o; }
@@ -487,6 +574,16 @@ struct Options {
     }
 };
 
+// 主排序器 (第二十八部分)，后续的组合算法需要回调完整排序
+template<typename T> struct Sorter;
+
+// C字符串按内容比较 (std::less<const char*>比较的是地址)
+struct CStringLess {
+    bool operator()(const char* a, const char* b) const noexcept {
+        return std::strcmp(a, b) < 0;
+    }
+};
+
 namespace detail {
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -832,6 +929,15 @@ namespace iter_traits {
     template<typename It>
     struct is_contiguous_impl<It, std::enable_if_t<std::is_pointer_v<It>>> : std::true_type {};
     
+    // std::vector的迭代器同样是连续存储（vector<bool>除外）
+    template<typename It>
+    struct is_contiguous_impl<It, std::enable_if_t<
+        !std::is_pointer_v<It> &&
+        !std::is_same_v<typename std::iterator_traits<It>::value_type, bool> &&
+        (std::is_same_v<It, typename std::vector<typename std::iterator_traits<It>::value_type>::iterator> ||
+         std::is_same_v<It, typename std::vector<typename std::iterator_traits<It>::value_type>::const_iterator>)>>
+        : std::true_type {};
+    
     template<typename It>
     inline constexpr bool is_contiguous_v = is_contiguous_impl<It>::value || std::is_pointer_v<It>;
     
@@ -873,6 +979,11 @@ namespace traits {
         std::is_same_v<std::decay_t<Cmp>, std::less<T>> ||
         std::is_same_v<std::decay_t<Cmp>, std::less<>>;
     
+    template<typename T, typename Cmp>
+    inline constexpr bool is_default_greater_v = 
+        std::is_same_v<std::decay_t<Cmp>, std::greater<T>> ||
+        std::is_same_v<std::decay_t<Cmp>, std::greater<>>;
+    
     template<typename T>
     inline constexpr bool is_trivially_movable_v = 
         std::is_trivially_copyable_v<T> || 
@@ -883,6 +994,35 @@ namespace traits {
         std::is_trivially_copyable_v<T> && 
         (sizeof(T) == 4 || sizeof(T) == 8) &&
         (std::is_integral_v<T> || std::is_floating_point_v<T>);
+    
+    // 按宽度和符号映射到定宽整数 (char/long long等与intN_t共用SIMD原语)
+    template<size_t S, bool Signed> struct fixed_int;
+    template<> struct fixed_int<1, true>  { using type = int8_t; };
+    template<> struct fixed_int<1, false> { using type = uint8_t; };
+    template<> struct fixed_int<2, true>  { using type = int16_t; };
+    template<> struct fixed_int<2, false> { using type = uint16_t; };
+    template<> struct fixed_int<4, true>  { using type = int32_t; };
+    template<> struct fixed_int<4, false> { using type = uint32_t; };
+    template<> struct fixed_int<8, true>  { using type = int64_t; };
+    template<> struct fixed_int<8, false> { using type = uint64_t; };
+    
+    template<typename T, typename = void>
+    struct lane { using type = T; };
+    
+    template<typename T>
+    struct lane<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>> {
+        using type = typename fixed_int<sizeof(T), std::is_signed_v<T>>::type;
+    };
+    
+    template<typename T>
+    using lane_t = typename lane<T>::type;
+    
+    // 有SIMD小数组排序的类型: 8~64位整数 (除bool) 以及float/double
+    template<typename T>
+    inline constexpr bool has_simd_small_sort_v =
+        (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8) ||
+        std::is_same_v<T, float> || std::is_same_v<T, double>;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -900,7 +1040,7 @@ namespace ops {
     
     template<typename T, typename Cmp>
     FYX_INLINE void cswap(T& a, T& b, Cmp& cmp) noexcept {
-        if (cmp(b, a)) swap(a, b);
+        if (cmp(b, a)) ops::swap(a, b);
     }
     
     // 无分支条件交换
@@ -968,6 +1108,7 @@ namespace keymap {
     struct Mapper<T, std::enable_if_t<std::is_unsigned_v<T>>> {
         using Key = T;
         static FYX_INLINE Key to_key(T v) noexcept { return v; }
+        static FYX_INLINE T from_key(Key k) noexcept { return k; }
     };
     
     template<typename T>
@@ -977,6 +1118,9 @@ namespace keymap {
         static FYX_INLINE Key to_key(T v) noexcept { 
             return static_cast<Key>(v) ^ FLIP; 
         }
+        static FYX_INLINE T from_key(Key k) noexcept {
+            return static_cast<T>(static_cast<Key>(k ^ FLIP));
+        }
     };
     
     template<> struct Mapper<float> {
@@ -987,6 +1131,12 @@ namespace keymap {
             Key mask = -static_cast<Key>(k >> 31) | 0x80000000U;
             return k ^ mask;
         }
+        static FYX_INLINE float from_key(Key k) noexcept {
+            k ^= (k >> 31) ? 0x80000000U : 0xFFFFFFFFU;
+            float v;
+            std::memcpy(&v, &k, sizeof(v));
+            return v;
+        }
     };
     
     template<> struct Mapper<double> {
@@ -997,39 +1147,116 @@ namespace keymap {
             Key mask = -static_cast<Key>(k >> 63) | 0x8000000000000000ULL;
             return k ^ mask;
         }
+        static FYX_INLINE double from_key(Key k) noexcept {
+            k ^= (k >> 63) ? 0x8000000000000000ULL : ~0ULL;
+            double v;
+            std::memcpy(&v, &k, sizeof(v));
+            return v;
+        }
     };
+    
+    // 无符号整数本身即是键；其余类型可先换成键再按无符号排序
+    template<typename T>
+    inline constexpr bool needs_transform_v = !std::is_same_v<T, typename Mapper<T>::Key>;
+    
+    // 键变换的两端: 正向T → Key，逆向Key → T
+    template<typename T, bool Inverse>
+    using xform_src_t = std::conditional_t<Inverse, typename Mapper<T>::Key, T>;
+    template<typename T, bool Inverse>
+    using xform_dst_t = std::conditional_t<Inverse, T, typename Mapper<T>::Key>;
+    
+    // 变换的标量版本。两端各按自己的类型访问: 有符号整数与对应的无符号类型可以互相别名，
+    // src与dst可以是同一块内存；浮点对象不能经整数左值访问，键必须放在单独的Key数组里
+    template<typename T, bool Inverse>
+    FYX_INLINE void transform_at(const xform_src_t<T, Inverse>* src, xform_dst_t<T, Inverse>* dst) noexcept {
+        if constexpr (Inverse) *dst = Mapper<T>::from_key(*src);
+        else *dst = Mapper<T>::to_key(*src);
+    }
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
 // 第十一部分: 预计算SIMD置换表 (修复版 - 条件编译)
 // ═══════════════════════════════════════════════════════════════════════════
 
-#ifdef FYX_AVX512
+#if defined(FYX_AVX512_KERNELS) || defined(FYX_AVX2_KERNELS)
 namespace simd_tables {
+    // 双调排序网络每一层的blend掩码: 第i位为1表示该通道取较大值
+    // 规则: ((i & j) != 0) ^ ((i & k) != 0)，k为当前双调序列长度，j为比较距离
+    // 表内只存整数，构造时不执行任何向量指令，仅有AVX2的CPU上同样可用
     struct alignas(64) PrecomputedTables {
-        __m512i rev_idx_16;
-        __m512i rev_idx_8;
+        alignas(64) int32_t rev_idx_16[16];
+        alignas(64) int64_t rev_idx_8[8];
         uint16_t blend_AAAA;
         uint16_t blend_CCCC;
         uint16_t blend_F0F0;
         uint16_t blend_FF00;
+        uint16_t blend_6666;   // k=2,  j=1
+        uint16_t blend_3C3C;   // k=4,  j=2
+        uint16_t blend_5A5A;   // k=4,  j=1
+        uint16_t blend_0FF0;   // k=8,  j=4
+        uint16_t blend_33CC;   // k=8,  j=2
+        uint16_t blend_55AA;   // k=8,  j=1
         uint8_t blend_AA;
         uint8_t blend_CC;
         uint8_t blend_F0;
+        uint8_t blend_66;
+        uint8_t blend_3C;
+        uint8_t blend_5A;
+        
+        // AVX2分区置换表 (代替AVX-512的压缩存储): 以比较掩码为下标，
+        // 置位通道(>=枢轴)依次排到高端，其余通道依次排到低端，供vpermd使用
+        alignas(32) uint32_t part_perm_32[256][8];   // 8x32位通道
+        alignas(32) uint32_t part_perm_64[16][8];    // 4x64位通道，每通道两个32位下标
         
         PrecomputedTables() noexcept {
-            rev_idx_16 = _mm512_set_epi32(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
-            rev_idx_8 = _mm512_set_epi64(0,1,2,3,4,5,6,7);
+            for (int i = 0; i < 16; ++i) rev_idx_16[i] = 15 - i;
+            for (int i = 0; i < 8; ++i) rev_idx_8[i] = 7 - i;
             blend_AAAA = 0xAAAA;
             blend_CCCC = 0xCCCC;
             blend_F0F0 = 0xF0F0;
             blend_FF00 = 0xFF00;
+            blend_6666 = 0x6666;
+            blend_3C3C = 0x3C3C;
+            blend_5A5A = 0x5A5A;
+            blend_0FF0 = 0x0FF0;
+            blend_33CC = 0x33CC;
+            blend_55AA = 0x55AA;
             blend_AA = 0xAA;
             blend_CC = 0xCC;
             blend_F0 = 0xF0;
+            blend_66 = 0x66;
+            blend_3C = 0x3C;
+            blend_5A = 0x5A;
+            
+            for (uint32_t m = 0; m < 256; ++m) {
+                uint32_t lo = 0, hi = 8 - static_cast<uint32_t>(__builtin_popcount(m));
+                for (uint32_t j = 0; j < 8; ++j) {
+                    if (m & (1u << j)) part_perm_32[m][hi++] = j;
+                    else part_perm_32[m][lo++] = j;
+                }
+            }
+            for (uint32_t m = 0; m < 16; ++m) {
+                uint32_t lo = 0, hi = 4 - static_cast<uint32_t>(__builtin_popcount(m));
+                for (uint32_t j = 0; j < 4; ++j) {
+                    uint32_t& pos = (m & (1u << j)) ? hi : lo;
+                    part_perm_64[m][2 * pos] = 2 * j;
+                    part_perm_64[m][2 * pos + 1] = 2 * j + 1;
+                    ++pos;
+                }
+            }
         }
     };
     
+    // 双调合并的blend掩码: 第j个通道在(j & D) != 0时取较大值
+    template<size_t W, size_t D>
+    constexpr uint64_t lane_bit_mask() noexcept {
+        uint64_t m = 0;
+        for (size_t j = 0; j < W; ++j) {
+            if (j & D) m |= uint64_t(1) << j;
+        }
+        return m;
+    }
+    
     // 线程安全的单例获取
     inline const PrecomputedTables& get_tables() noexcept {
         // C++11保证静态局部变量线程安全初始化
@@ -1037,10 +1264,10 @@ namespace simd_tables {
         return tables;
     }
 }
-#endif // FYX_AVX512
+#endif // FYX_AVX512_KERNELS || FYX_AVX2_KERNELS
 
-// 为非AVX512平台提供空实现
-#ifndef FYX_AVX512
+// 为无x86 SIMD内核的平台提供空实现
+#if !defined(FYX_AVX512_KERNELS) && !defined(FYX_AVX2_KERNELS)
 namespace simd_tables {
     struct PrecomputedTables {};
     inline const PrecomputedTables& get_tables() noexcept {
@@ -1054,70 +1281,70 @@ namespace simd_tables {
 // 第十二部分: AVX-512 SIMD核心
 // ═══════════════════════════════════════════════════════════════════════════
 
-#ifdef FYX_AVX512
+#ifdef FYX_AVX512_KERNELS
+// GCC的_mm512_undefined_*()用自初始化的__Y实现，内联进target属性内核后误报未初始化，仅在本区段关闭
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 namespace simd512 {
     using namespace simd_tables;
     
-    // 16x int32 排序网络 (优化版)
-    FYX_INLINE __m512i sort_16xi32(__m512i v) noexcept {
+    // 16x int32 排序网络 (双调排序，10层)
+    FYX_INLINE FYX_TARGET_AVX512 __m512i sort_16xi32(__m512i v) noexcept {
         __m512i t, mn, mx;
         const auto& tbl = get_tables();
         
-        // Layer 1
+        // k=2
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_6666, mn, mx);
         
-        // Layer 2
+        // k=4
         t = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_3C3C, mn, mx);
         
-        // Layer 3
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_5A5A, mn, mx);
         
-        // Layer 4
+        // k=8
         t = _mm512_shuffle_i32x4(v, v, 0xB1);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_F0F0, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_0FF0, mn, mx);
         
-        // Layer 5
         t = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_33CC, mn, mx);
         
-        // Layer 6
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_55AA, mn, mx);
         
-        // Layer 7
+        // k=16
         t = _mm512_shuffle_i32x4(v, v, 0x4E);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
         v = _mm512_mask_blend_epi32(tbl.blend_FF00, mn, mx);
         
-        // Layer 8
         t = _mm512_shuffle_i32x4(v, v, 0xB1);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
         v = _mm512_mask_blend_epi32(tbl.blend_F0F0, mn, mx);
         
-        // Layer 9
         t = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
         v = _mm512_mask_blend_epi32(tbl.blend_CCCC, mn, mx);
         
-        // Layer 10
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epi32(v, t);
         mx = _mm512_max_epi32(v, t);
@@ -1126,8 +1353,8 @@ namespace simd512 {
         return v;
     }
     
-    // 16元素合并 (优化版)
-    FYX_INLINE void bitonic_merge_16(__m512i& v) noexcept {
+    // 16元素双调合并 (输入为双调序列，输出升序)
+    FYX_INLINE FYX_TARGET_AVX512 void bitonic_merge_16(__m512i& v) noexcept {
         __m512i t, mn, mx;
         const auto& tbl = get_tables();
         
@@ -1152,84 +1379,68 @@ namespace simd512 {
         v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
     }
     
-    // 32x int32 排序 (优化版)
-    FYX_INLINE void sort_32xi32(int32_t* arr) noexcept {
+    // 合并两个已排序的16元素向量: 结果 v0 <= v1
+    FYX_INLINE FYX_TARGET_AVX512 void merge_2x16(__m512i& v0, __m512i& v1) noexcept {
         const auto& tbl = get_tables();
-        
-        __m512i v0 = _mm512_loadu_si512(arr);
-        __m512i v1 = _mm512_loadu_si512(arr + 16);
-        
-        v0 = sort_16xi32(v0);
-        v1 = sort_16xi32(v1);
-        
-        v1 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v1);
-        
+        v1 = _mm512_permutexvar_epi32(_mm512_load_si512(tbl.rev_idx_16), v1);
+        __m512i mn = _mm512_min_epi32(v0, v1);
+        __m512i mx = _mm512_max_epi32(v0, v1);
+        v0 = mn;
+        v1 = mx;
+        bitonic_merge_16(v0);
+        bitonic_merge_16(v1);
+    }
+    
+    // 32元素双调序列合并 (v0,v1 组成双调序列)
+    FYX_INLINE FYX_TARGET_AVX512 void bitonic_merge_32(__m512i& v0, __m512i& v1) noexcept {
         __m512i mn = _mm512_min_epi32(v0, v1);
         __m512i mx = _mm512_max_epi32(v0, v1);
         v0 = mn;
         v1 = mx;
-        
         bitonic_merge_16(v0);
         bitonic_merge_16(v1);
+    }
+    
+    // 合并两个已排序的32元素序列 (v0,v1) 与 (v2,v3)
+    FYX_INLINE FYX_TARGET_AVX512 void merge_2x32(__m512i& v0, __m512i& v1, __m512i& v2, __m512i& v3) noexcept {
+        const auto& tbl = get_tables();
+        __m512i r2 = _mm512_permutexvar_epi32(_mm512_load_si512(tbl.rev_idx_16), v3);
+        __m512i r3 = _mm512_permutexvar_epi32(_mm512_load_si512(tbl.rev_idx_16), v2);
+        
+        __m512i t0 = _mm512_min_epi32(v0, r2);
+        __m512i t2 = _mm512_max_epi32(v0, r2);
+        __m512i t1 = _mm512_min_epi32(v1, r3);
+        __m512i t3 = _mm512_max_epi32(v1, r3);
+        
+        bitonic_merge_32(t0, t1);
+        bitonic_merge_32(t2, t3);
+        v0 = t0; v1 = t1; v2 = t2; v3 = t3;
+    }
+    
+    // 32x int32 排序 (优化版)
+    FYX_INLINE FYX_TARGET_AVX512 void sort_32xi32(int32_t* arr) noexcept {
+        __m512i v0 = sort_16xi32(_mm512_loadu_si512(arr));
+        __m512i v1 = sort_16xi32(_mm512_loadu_si512(arr + 16));
+        
+        merge_2x16(v0, v1);
         
         _mm512_storeu_si512(arr, v0);
         _mm512_storeu_si512(arr + 16, v1);
     }
     
     // 64x int32 排序 (优化版)
-    FYX_NOINLINE void sort_64xi32(int32_t* arr) noexcept {
-        const auto& tbl = get_tables();
-        
-        // 预取
-        FYX_PREFETCH_T0(arr + 64);
-        
+    FYX_NOINLINE FYX_TARGET_AVX512 void sort_64xi32(int32_t* arr) noexcept {
         __m512i v0 = sort_16xi32(_mm512_loadu_si512(arr));
         __m512i v1 = sort_16xi32(_mm512_loadu_si512(arr + 16));
         __m512i v2 = sort_16xi32(_mm512_loadu_si512(arr + 32));
         __m512i v3 = sort_16xi32(_mm512_loadu_si512(arr + 48));
         
-        // 阶段1
-        v1 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v1);
-        v3 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v3);
-        
-        __m512i t0 = _mm512_min_epi32(v0, v1);
-        __m512i t1 = _mm512_max_epi32(v0, v1);
-        __m512i t2 = _mm512_min_epi32(v2, v3);
-        __m512i t3 = _mm512_max_epi32(v2, v3);
-        
-        bitonic_merge_16(t0);
-        bitonic_merge_16(t1);
-        bitonic_merge_16(t2);
-        bitonic_merge_16(t3);
-        
-        v0 = t0; v1 = t1; v2 = t2; v3 = t3;
-        
-        // 阶段2
-        v2 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v2);
-        v3 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v3);
-        
-        t0 = _mm512_min_epi32(v0, v3);
-        t3 = _mm512_max_epi32(v0, v3);
-        t1 = _mm512_min_epi32(v1, v2);
-        t2 = _mm512_max_epi32(v1, v2);
-        
-        v0 = t0; v1 = t1; v2 = t2; v3 = t3;
+        // 阶段1: 两两合并为32元素有序段
+        merge_2x16(v0, v1);
+        merge_2x16(v2, v3);
         
-        v1 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v1);
-        __m512i mn01 = _mm512_min_epi32(v0, v1);
-        __m512i mx01 = _mm512_max_epi32(v0, v1);
-        bitonic_merge_16(mn01);
-        bitonic_merge_16(mx01);
-        v0 = mn01;
-        v1 = mx01;
-        
-        v3 = _mm512_permutexvar_epi32(tbl.rev_idx_16, v3);
-        __m512i mn23 = _mm512_min_epi32(v2, v3);
-        __m512i mx23 = _mm512_max_epi32(v2, v3);
-        bitonic_merge_16(mn23);
-        bitonic_merge_16(mx23);
-        v2 = mn23;
-        v3 = mx23;
+        // 阶段2: 合并两个32元素有序段
+        merge_2x32(v0, v1, v2, v3);
         
         _mm512_storeu_si512(arr, v0);
         _mm512_storeu_si512(arr + 16, v1);
@@ -1238,62 +1449,70 @@ namespace simd512 {
     }
     
     // 128x int32 排序
-    FYX_NOINLINE void sort_128xi32(int32_t* arr) noexcept {
+    FYX_NOINLINE FYX_TARGET_AVX512 void sort_128xi32(int32_t* arr) noexcept {
         sort_64xi32(arr);
         sort_64xi32(arr + 64);
         
-        // 归并两个64元素排序块
+        // 归并两个64元素排序块: 后半段反转后逐对取min/max
         const auto& tbl = get_tables();
-        
-        for (int i = 3; i >= 0; --i) {
-            __m512i a = _mm512_loadu_si512(arr + 48 + i * 16 - 48);
-            __m512i b = _mm512_loadu_si512(arr + 64 + (3 - i) * 16);
-            b = _mm512_permutexvar_epi32(tbl.rev_idx_16, b);
-            
-            __m512i mn = _mm512_min_epi32(a, b);
-            __m512i mx = _mm512_max_epi32(a, b);
-            
-            bitonic_merge_16(mn);
-            bitonic_merge_16(mx);
-            
-            _mm512_storeu_si512(arr + i * 16, mn);
-            _mm512_storeu_si512(arr + 64 + (3 - i) * 16, 
-                _mm512_permutexvar_epi32(tbl.rev_idx_16, mx));
+        __m512i v[8];
+        for (int i = 0; i < 4; ++i) {
+            v[i] = _mm512_loadu_si512(arr + i * 16);
+            v[4 + i] = _mm512_permutexvar_epi32(_mm512_load_si512(tbl.rev_idx_16),
+                           _mm512_loadu_si512(arr + 64 + (3 - i) * 16));
+        }
+        for (int i = 0; i < 4; ++i) {
+            __m512i mn = _mm512_min_epi32(v[i], v[4 + i]);
+            __m512i mx = _mm512_max_epi32(v[i], v[4 + i]);
+            v[i] = mn;
+            v[4 + i] = mx;
+        }
+        
+        // 两个64元素双调序列: 距离32、16的半清洗，再做16元素合并
+        for (int h = 0; h < 8; h += 4) {
+            for (int i = 0; i < 2; ++i) {
+                __m512i mn = _mm512_min_epi32(v[h + i], v[h + i + 2]);
+                __m512i mx = _mm512_max_epi32(v[h + i], v[h + i + 2]);
+                v[h + i] = mn;
+                v[h + i + 2] = mx;
+            }
+            bitonic_merge_32(v[h], v[h + 1]);
+            bitonic_merge_32(v[h + 2], v[h + 3]);
         }
         
-        // 最终合并
-        sort_64xi32(arr);
-        sort_64xi32(arr + 64);
+        for (int i = 0; i < 8; ++i) {
+            _mm512_storeu_si512(arr + i * 16, v[i]);
+        }
     }
     
     // 16x uint32 排序
-    FYX_INLINE __m512i sort_16xu32(__m512i v) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 __m512i sort_16xu32(__m512i v) noexcept {
         __m512i t, mn, mx;
         const auto& tbl = get_tables();
         
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_6666, mn, mx);
         
         t = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_3C3C, mn, mx);
         
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_5A5A, mn, mx);
         
         t = _mm512_shuffle_i32x4(v, v, 0xB1);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_F0F0, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_0FF0, mn, mx);
         
         t = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_33CC, mn, mx);
         
         t = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
-        v = _mm512_mask_blend_epi32(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_epi32(tbl.blend_55AA, mn, mx);
         
         t = _mm512_shuffle_i32x4(v, v, 0x4E);
         mn = _mm512_min_epu32(v, t); mx = _mm512_max_epu32(v, t);
@@ -1315,26 +1534,24 @@ namespace simd512 {
     }
     
     // 8x int64 排序
-    FYX_INLINE __m512i sort_8xi64(__m512i v) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 __m512i sort_8xi64(__m512i v) noexcept {
         __m512i t, mn, mx;
         const auto& tbl = get_tables();
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epi64(v, t);
         mx = _mm512_max_epi64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_66, mn, mx);
         
         t = _mm512_permutex_epi64(v, 0x4E);
         mn = _mm512_min_epi64(v, t);
         mx = _mm512_max_epi64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_CC, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_3C, mn, mx);
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epi64(v, t);
         mx = _mm512_max_epi64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_5A, mn, mx);
         
         t = _mm512_shuffle_i64x2(v, v, 0x4E);
         mn = _mm512_min_epi64(v, t);
@@ -1346,8 +1563,7 @@ namespace simd512 {
         mx = _mm512_max_epi64(v, t);
         v = _mm512_mask_blend_epi64(tbl.blend_CC, mn, mx);
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epi64(v, t);
         mx = _mm512_max_epi64(v, t);
         v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
@@ -1356,26 +1572,24 @@ namespace simd512 {
     }
     
     // 8x uint64 排序
-    FYX_INLINE __m512i sort_8xu64(__m512i v) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 __m512i sort_8xu64(__m512i v) noexcept {
         __m512i t, mn, mx;
         const auto& tbl = get_tables();
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epu64(v, t);
         mx = _mm512_max_epu64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_66, mn, mx);
         
         t = _mm512_permutex_epi64(v, 0x4E);
         mn = _mm512_min_epu64(v, t);
         mx = _mm512_max_epu64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_CC, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_3C, mn, mx);
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epu64(v, t);
         mx = _mm512_max_epu64(v, t);
-        v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_epi64(tbl.blend_5A, mn, mx);
         
         t = _mm512_shuffle_i64x2(v, v, 0x4E);
         mn = _mm512_min_epu64(v, t);
@@ -1387,8 +1601,7 @@ namespace simd512 {
         mx = _mm512_max_epu64(v, t);
         v = _mm512_mask_blend_epi64(tbl.blend_CC, mn, mx);
         
-        t = _mm512_shuffle_i64x2(v, v, 0xB1);
-        t = _mm512_permutex_epi64(t, 0x4E);
+        t = _mm512_permutex_epi64(v, 0xB1);
         mn = _mm512_min_epu64(v, t);
         mx = _mm512_max_epu64(v, t);
         v = _mm512_mask_blend_epi64(tbl.blend_AA, mn, mx);
@@ -1397,24 +1610,24 @@ namespace simd512 {
     }
     
     // 8x double 排序
-    FYX_INLINE __m512d sort_8xf64(__m512d v) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 __m512d sort_8xf64(__m512d v) noexcept {
         __m512d t, mn, mx;
         const auto& tbl = get_tables();
         
         t = _mm512_shuffle_pd(v, v, 0x55);
         mn = _mm512_min_pd(v, t);
         mx = _mm512_max_pd(v, t);
-        v = _mm512_mask_blend_pd(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_pd(tbl.blend_66, mn, mx);
         
         t = _mm512_permutex_pd(v, 0x4E);
         mn = _mm512_min_pd(v, t);
         mx = _mm512_max_pd(v, t);
-        v = _mm512_mask_blend_pd(tbl.blend_CC, mn, mx);
+        v = _mm512_mask_blend_pd(tbl.blend_3C, mn, mx);
         
         t = _mm512_shuffle_pd(v, v, 0x55);
         mn = _mm512_min_pd(v, t);
         mx = _mm512_max_pd(v, t);
-        v = _mm512_mask_blend_pd(tbl.blend_AA, mn, mx);
+        v = _mm512_mask_blend_pd(tbl.blend_5A, mn, mx);
         
         t = _mm512_shuffle_f64x2(v, v, 0x4E);
         mn = _mm512_min_pd(v, t);
@@ -1435,39 +1648,39 @@ namespace simd512 {
     }
     
     // 16x float 排序
-    FYX_INLINE __m512 sort_16xf32(__m512 v) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 __m512 sort_16xf32(__m512 v) noexcept {
         __m512 t, mn, mx;
         const auto& tbl = get_tables();
         
         t = _mm512_shuffle_ps(v, v, 0xB1);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_6666, mn, mx);
         
         t = _mm512_shuffle_ps(v, v, 0x4E);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_3C3C, mn, mx);
         
         t = _mm512_shuffle_ps(v, v, 0xB1);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_5A5A, mn, mx);
         
         t = _mm512_shuffle_f32x4(v, v, 0xB1);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_F0F0, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_0FF0, mn, mx);
         
         t = _mm512_shuffle_ps(v, v, 0x4E);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_CCCC, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_33CC, mn, mx);
         
         t = _mm512_shuffle_ps(v, v, 0xB1);
         mn = _mm512_min_ps(v, t);
         mx = _mm512_max_ps(v, t);
-        v = _mm512_mask_blend_ps(tbl.blend_AAAA, mn, mx);
+        v = _mm512_mask_blend_ps(tbl.blend_55AA, mn, mx);
         
         t = _mm512_shuffle_f32x4(v, v, 0x4E);
         mn = _mm512_min_ps(v, t);
@@ -1492,8 +1705,30 @@ namespace simd512 {
         return v;
     }
     
+    // 8x double 双调序列合并
+    FYX_INLINE FYX_TARGET_AVX512 void bitonic_merge_8xf64(__m512d& v) noexcept {
+        const auto& tbl = get_tables();
+        __m512d t, mn, mx;
+        const __m512i idx4 = _mm512_set_epi64(3,2,1,0,7,6,5,4);
+        
+        t = _mm512_permutexvar_pd(idx4, v);
+        mn = _mm512_min_pd(v, t);
+        mx = _mm512_max_pd(v, t);
+        v = _mm512_mask_blend_pd(tbl.blend_F0, mn, mx);
+        
+        t = _mm512_permutex_pd(v, 0x4E);
+        mn = _mm512_min_pd(v, t);
+        mx = _mm512_max_pd(v, t);
+        v = _mm512_mask_blend_pd(tbl.blend_CC, mn, mx);
+        
+        t = _mm512_shuffle_pd(v, v, 0x55);
+        mn = _mm512_min_pd(v, t);
+        mx = _mm512_max_pd(v, t);
+        v = _mm512_mask_blend_pd(tbl.blend_AA, mn, mx);
+    }
+    
     // 16x double 排序
-    FYX_INLINE void sort_16xf64(double* arr) noexcept {
+    FYX_INLINE FYX_TARGET_AVX512 void sort_16xf64(double* arr) noexcept {
         const auto& tbl = get_tables();
         
         __m512d v0 = _mm512_loadu_pd(arr);
@@ -1502,35 +1737,15 @@ namespace simd512 {
         v0 = sort_8xf64(v0);
         v1 = sort_8xf64(v1);
         
-        v1 = _mm512_permutexvar_pd(tbl.rev_idx_8, v1);
+        v1 = _mm512_permutexvar_pd(_mm512_load_si512(tbl.rev_idx_8), v1);
         
         __m512d mn = _mm512_min_pd(v0, v1);
         __m512d mx = _mm512_max_pd(v0, v1);
         v0 = mn;
         v1 = mx;
         
-        auto merge8 = [&tbl](__m512d& v) {
-            __m512d t, mn, mx;
-            const __m512i idx4 = _mm512_set_epi64(3,2,1,0,7,6,5,4);
-            
-            t = _mm512_permutexvar_pd(idx4, v);
-            mn = _mm512_min_pd(v, t);
-            mx = _mm512_max_pd(v, t);
-            v = _mm512_mask_blend_pd(tbl.blend_F0, mn, mx);
-            
-            t = _mm512_permutex_pd(v, 0x4E);
-            mn = _mm512_min_pd(v, t);
-            mx = _mm512_max_pd(v, t);
-            v = _mm512_mask_blend_pd(tbl.blend_CC, mn, mx);
-            
-            t = _mm512_shuffle_pd(v, v, 0x55);
-            mn = _mm512_min_pd(v, t);
-            mx = _mm512_max_pd(v, t);
-            v = _mm512_mask_blend_pd(tbl.blend_AA, mn, mx);
-        };
-        
-        merge8(v0);
-        merge8(v1);
+        bitonic_merge_8xf64(v0);
+        bitonic_merge_8xf64(v1);
         
         _mm512_storeu_pd(arr, v0);
         _mm512_storeu_pd(arr + 8, v1);
@@ -1538,7 +1753,7 @@ namespace simd512 {
     
     // MinMax (优化版 - 带多级预取)
     template<typename T>
-    std::pair<T, T> find_minmax_512(const T* data, size_t n) noexcept {
+    FYX_TARGET_AVX512 std::pair<T, T> find_minmax_512(const T* data, size_t n) noexcept {
         if (FYX_UNLIKELY(n == 0)) return {T{}, T{}};
         if (FYX_UNLIKELY(n == 1)) return {data[0], data[0]};
         
@@ -1797,10 +2012,10 @@ namespace simd512 {
         }
     }
     
-    // 直方图 (优化版)
+    // 直方图: 分散计数器版本，4组计数表轮流自增，隔开同一桶的相邻写入
     template<typename T>
-    FYX_NOINLINE void histogram_512(const T* FYX_RESTRICT data, size_t n, 
-                                     size_t* FYX_RESTRICT counts, int shift) noexcept {
+    FYX_NOINLINE FYX_TARGET_AVX512 void histogram_split_512(const T* FYX_RESTRICT data, size_t n, 
+                                                             size_t* FYX_RESTRICT counts, int shift) noexcept {
         using M = keymap::Mapper<T>;
         constexpr size_t MASK = 255;
         
@@ -1831,10 +2046,135 @@ namespace simd512 {
         }
     }
     
+#ifdef FYX_AVX512CD_KERNELS
+    // 16个32位通道各自的置位数 (冲突位最多15个): 半字节查表，再把每通道低两字节相加
+    FYX_INLINE FYX_TARGET_AVX512CD __m512i conflict_count_16(__m512i c) noexcept {
+        const __m512i lut = _mm512_broadcast_i32x4(
+            _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+        const __m512i nib = _mm512_set1_epi8(0x0F);
+        __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(c, nib));
+        __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(c, 4), nib));
+        return _mm512_maddubs_epi16(_mm512_add_epi8(lo, hi), _mm512_set1_epi8(1));
+    }
+    
+    template<typename T>
+    FYX_INLINE FYX_TARGET_AVX512CD __m512i key_8x64(__m512i k) noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            return _mm512_xor_si512(k, _mm512_or_si512(_mm512_srai_epi64(k, 63),
+                                                       _mm512_set1_epi64(INT64_MIN)));
+        } else if constexpr (std::is_signed_v<T>) {
+            return _mm512_xor_si512(k, _mm512_set1_epi64(INT64_MIN));
+        } else {
+            return k;
+        }
+    }
+    
+    // 读取16个元素并按keymap::Mapper取第shift位起的8位数字，结果为16x32位通道
+    template<typename T>
+    FYX_INLINE FYX_TARGET_AVX512CD __m512i load_digits_16(const T* p, __m128i sh) noexcept {
+        const __m512i mask = _mm512_set1_epi32(255);
+        if constexpr (sizeof(T) == 1) {
+            __m512i k = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if constexpr (std::is_signed_v<T>) k = _mm512_xor_si512(k, _mm512_set1_epi32(0x80));
+            return _mm512_and_si512(_mm512_srl_epi32(k, sh), mask);
+        } else if constexpr (sizeof(T) == 2) {
+            __m512i k = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+            if constexpr (std::is_signed_v<T>) k = _mm512_xor_si512(k, _mm512_set1_epi32(0x8000));
+            return _mm512_and_si512(_mm512_srl_epi32(k, sh), mask);
+        } else if constexpr (sizeof(T) == 4) {
+            __m512i k = _mm512_loadu_si512(p);
+            if constexpr (std::is_floating_point_v<T>) {
+                k = _mm512_xor_si512(k, _mm512_or_si512(_mm512_srai_epi32(k, 31),
+                                                        _mm512_set1_epi32(INT32_MIN)));
+            } else if constexpr (std::is_signed_v<T>) {
+                k = _mm512_xor_si512(k, _mm512_set1_epi32(INT32_MIN));
+            }
+            return _mm512_and_si512(_mm512_srl_epi32(k, sh), mask);
+        } else {
+            __m256i lo = _mm512_cvtepi64_epi32(_mm512_srl_epi64(key_8x64<T>(_mm512_loadu_si512(p)), sh));
+            __m256i hi = _mm512_cvtepi64_epi32(_mm512_srl_epi64(key_8x64<T>(_mm512_loadu_si512(p + 8)), sh));
+            return _mm512_and_si512(_mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1), mask);
+        }
+    }
+    
+    // 直方图: 冲突检测版本。vpconflictd标出与更低通道相同的数字，聚集旧计数、
+    // 加上各通道的重复数后分散写回；同一下标由最高通道最后写入，恰好带着完整增量。
+    // 两组计数表交替使用，隔开相邻两批之间对同一地址的分散→聚集依赖
+    template<typename T>
+    FYX_NOINLINE FYX_TARGET_AVX512CD void histogram_conflict_512(const T* FYX_RESTRICT data, size_t n,
+                                                                  size_t* FYX_RESTRICT counts, int shift) noexcept {
+        using M = keymap::Mapper<T>;
+        constexpr size_t MASK = 255;
+        constexpr size_t CHUNK = size_t(1) << 30;  // 32位计数器，分块汇总防止溢出
+        
+        alignas(64) uint32_t local[2][256];
+        alignas(64) size_t total[256] = {};
+        const __m128i sh = _mm_cvtsi32_si128(shift);
+        const __m512i one = _mm512_set1_epi32(1);
+        const __m512i second = _mm512_set1_epi32(256);
+        
+        for (size_t base = 0; base < n; base += CHUNK) {
+            const T* p = data + base;
+            size_t len = std::min(CHUNK, n - base);
+            std::memset(local, 0, sizeof(local));
+            
+            size_t i = 0;
+            for (; i + 32 <= len; i += 32) {
+                FYX_PREFETCH_T0(p + i + 128);
+                __m512i d0 = load_digits_16(p + i, sh);
+                __m512i d1 = _mm512_add_epi32(load_digits_16(p + i + 16, sh), second);
+                __m512i c0 = _mm512_add_epi32(conflict_count_16(_mm512_conflict_epi32(d0)), one);
+                __m512i c1 = _mm512_add_epi32(conflict_count_16(_mm512_conflict_epi32(d1)), one);
+                __m512i o0 = _mm512_i32gather_epi32(d0, &local[0][0], 4);
+                _mm512_i32scatter_epi32(&local[0][0], d0, _mm512_add_epi32(o0, c0), 4);
+                __m512i o1 = _mm512_i32gather_epi32(d1, &local[0][0], 4);
+                _mm512_i32scatter_epi32(&local[0][0], d1, _mm512_add_epi32(o1, c1), 4);
+            }
+            for (; i < len; ++i) {
+                ++local[0][(M::to_key(p[i]) >> shift) & MASK];
+            }
+            for (size_t b = 0; b < 256; ++b) {
+                total[b] += size_t(local[0][b]) + local[1][b];
+            }
+        }
+        std::memcpy(counts, total, sizeof(total));
+    }
+#endif // FYX_AVX512CD_KERNELS
+    
+    // 抽样判断数字分布是否倾斜: 少数桶占多数时分散计数器反复自增同一地址，
+    // 受存储转发延迟所限；寄存器内先合并重复的冲突检测版本针对的就是这种情况
+    template<typename T>
+    bool histogram_skewed(const T* data, size_t n, int shift) noexcept {
+        using M = keymap::Mapper<T>;
+        uint8_t freq[256] = {};
+        size_t step = n / config::HIST_SKEW_SAMPLES;
+        for (size_t s = 0; s < config::HIST_SKEW_SAMPLES; ++s) {
+            size_t b = (M::to_key(data[s * step]) >> shift) & 255;
+            if (++freq[b] >= config::HIST_SKEW_THRESHOLD) return true;
+        }
+        return false;
+    }
+    
+    // 直方图: 默认只用分散计数器——实测冲突检测版本在均匀和倾斜分布上都更慢
+    // (聚集/分散的延迟抵消了合并重复的收益)。定义FYX_CONFLICT_HISTOGRAM后，
+    // 倾斜分布且CPU支持AVX512CD时改用冲突检测，供在其他微架构上复测
+    template<typename T>
+    FYX_NOINLINE FYX_TARGET_AVX512 void histogram_512(const T* FYX_RESTRICT data, size_t n, 
+                                                       size_t* FYX_RESTRICT counts, int shift) noexcept {
+#if defined(FYX_AVX512CD_KERNELS) && defined(FYX_CONFLICT_HISTOGRAM)
+        static const bool has_cd = cpu::get_features().avx512cd;
+        if (has_cd && n >= config::HIST_CONFLICT_MIN_SIZE && histogram_skewed(data, n, shift)) {
+            histogram_conflict_512(data, n, counts, shift);
+            return;
+        }
+#endif
+        histogram_split_512(data, n, counts, shift);
+    }
+    
     // 散布 (优化版)
     template<typename T>
-    FYX_NOINLINE void scatter_512(const T* FYX_RESTRICT src, T* FYX_RESTRICT dst, 
-                                   size_t n, size_t* FYX_RESTRICT offsets, int shift) noexcept {
+    FYX_NOINLINE FYX_TARGET_AVX512 void scatter_512(const T* FYX_RESTRICT src, T* FYX_RESTRICT dst, 
+                                                     size_t n, size_t* FYX_RESTRICT offsets, int shift) noexcept {
         using M = keymap::Mapper<T>;
         constexpr size_t MASK = 255;
         
@@ -1892,95 +2232,573 @@ namespace simd512 {
             dst[offsets[b]++] = v;
         }
     }
-}
-#endif // FYX_AVX512
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第十三部分: AVX2 SIMD核心
-// ═══════════════════════════════════════════════════════════════════════════
-
-#ifdef FYX_AVX2
-namespace simd256 {
-    FYX_INLINE __m256i sort_8xi32(__m256i v) noexcept {
-        __m256i t, mn, mx;
-        
-        t = _mm256_shuffle_epi32(v, 0xB1);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xAA);
-        
-        t = _mm256_shuffle_epi32(v, 0x1B);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xCC);
-        
-        t = _mm256_shuffle_epi32(v, 0xB1);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xAA);
-        
-        t = _mm256_permute2x128_si256(v, v, 0x01);
-        t = _mm256_shuffle_epi32(t, 0x1B);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xF0);
-        
-        t = _mm256_shuffle_epi32(v, 0x4E);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xCC);
-        
-        t = _mm256_shuffle_epi32(v, 0xB1);
-        mn = _mm256_min_epi32(v, t);
-        mx = _mm256_max_epi32(v, t);
-        v = _mm256_blend_epi32(mn, mx, 0xAA);
-        
-        return v;
+    
+    // 键变换 (与keymap::Mapper一致): 浮点负数全部取反、非负数只翻符号位，有符号整数只翻符号位
+    template<typename T, bool Inverse>
+    FYX_INLINE FYX_TARGET_AVX512 __m512i key_transform_512(__m512i v) noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            __m512i s = _mm512_srai_epi32(v, 31);
+            if constexpr (Inverse) s = _mm512_xor_si512(s, _mm512_set1_epi32(-1));
+            return _mm512_xor_si512(v, _mm512_or_si512(s, _mm512_set1_epi32(INT32_MIN)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            __m512i s = _mm512_srai_epi64(v, 63);
+            if constexpr (Inverse) s = _mm512_xor_si512(s, _mm512_set1_epi64(-1));
+            return _mm512_xor_si512(v, _mm512_or_si512(s, _mm512_set1_epi64(INT64_MIN)));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) return _mm512_xor_si512(v, _mm512_set1_epi8(INT8_MIN));
+            else if constexpr (sizeof(T) == 2) return _mm512_xor_si512(v, _mm512_set1_epi16(INT16_MIN));
+            else if constexpr (sizeof(T) == 4) return _mm512_xor_si512(v, _mm512_set1_epi32(INT32_MIN));
+            else return _mm512_xor_si512(v, _mm512_set1_epi64(INT64_MIN));
+        } else {
+            return v;
+        }
     }
     
-    FYX_INLINE void sort_16xi32(int32_t* arr) noexcept {
-        __m256i v0 = _mm256_loadu_si256((__m256i*)arr);
-        __m256i v1 = _mm256_loadu_si256((__m256i*)(arr + 8));
-        
-        v0 = sort_8xi32(v0);
-        v1 = sort_8xi32(v1);
-        
-        v1 = _mm256_permute2x128_si256(v1, v1, 0x01);
-        v1 = _mm256_shuffle_epi32(v1, 0x1B);
-        
-        __m256i mn = _mm256_min_epi32(v0, v1);
-        __m256i mx = _mm256_max_epi32(v0, v1);
-        v0 = mn;
-        v1 = mx;
-        
-        auto merge8 = [](__m256i& v) {
-            __m256i t, mn, mx;
-            
-            t = _mm256_permute2x128_si256(v, v, 0x01);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xF0);
-            
-            t = _mm256_shuffle_epi32(v, 0x4E);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xCC);
-            
-            t = _mm256_shuffle_epi32(v, 0xB1);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xAA);
-        };
-        
-        merge8(v0);
-        merge8(v1);
-        
-        _mm256_storeu_si256((__m256i*)arr, v0);
-        _mm256_storeu_si256((__m256i*)(arr + 8), v1);
+    // 把整个数组换成保序无符号键 (Inverse时换回原值)，基数排序前后各做一遍；
+    // 整数可原地 (src == dst)，浮点写进单独的键数组 (见keymap::transform_at)
+    template<typename T, bool Inverse>
+    FYX_NOINLINE FYX_TARGET_AVX512 void transform_keys_512(const keymap::xform_src_t<T, Inverse>* src,
+                                                            keymap::xform_dst_t<T, Inverse>* dst, size_t n) noexcept {
+        constexpr size_t W = 64 / sizeof(T);
+        size_t i = 0;
+        for (; i + W <= n; i += W) {
+            __m512i v = _mm512_loadu_si512(src + i);
+            _mm512_storeu_si512(dst + i, key_transform_512<T, Inverse>(v));
+        }
+        for (; i < n; ++i) keymap::transform_at<T, Inverse>(src + i, dst + i);
+    }
+
+    // 相邻下降检测: 直接得到通道位掩码 (8/16位通道用AVX512BW比较)
+    template<typename T, bool Rev = false>
+    FYX_INLINE FYX_TARGET_AVX512 uint64_t descent_mask_512(const T* p) noexcept {
+        const T* lo = Rev ? p : p + 1;
+        const T* hi = Rev ? p + 1 : p;
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm512_cmp_ps_mask(_mm512_loadu_ps(lo), _mm512_loadu_ps(hi), _CMP_LT_OQ);
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm512_cmp_pd_mask(_mm512_loadu_pd(lo), _mm512_loadu_pd(hi), _CMP_LT_OQ);
+        } else {
+            __m512i x = _mm512_loadu_si512(lo), y = _mm512_loadu_si512(hi);
+            if constexpr (std::is_signed_v<T>) {
+                if constexpr (sizeof(T) == 1) return _mm512_cmplt_epi8_mask(x, y);
+                else if constexpr (sizeof(T) == 2) return _mm512_cmplt_epi16_mask(x, y);
+                else if constexpr (sizeof(T) == 4) return _mm512_cmplt_epi32_mask(x, y);
+                else return _mm512_cmplt_epi64_mask(x, y);
+            } else {
+                if constexpr (sizeof(T) == 1) return _mm512_cmplt_epu8_mask(x, y);
+                else if constexpr (sizeof(T) == 2) return _mm512_cmplt_epu16_mask(x, y);
+                else if constexpr (sizeof(T) == 4) return _mm512_cmplt_epu32_mask(x, y);
+                else return _mm512_cmplt_epu64_mask(x, y);
+            }
+        }
     }
     
-    FYX_INLINE void sort_32xi32(int32_t* arr) noexcept {
-        sort_16xi32(arr);
+    // 最长非降 (Rev: 非增) 前缀；每轮扫4个向量，掩码全零时只有一次分支
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_AVX512 size_t sorted_prefix_512(const T* a, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 64 / sizeof(T);
+            for (; i + 4 * W < n; i += 4 * W) {
+                uint64_t m0 = descent_mask_512<T, Rev>(a + i);
+                uint64_t m1 = descent_mask_512<T, Rev>(a + i + W);
+                uint64_t m2 = descent_mask_512<T, Rev>(a + i + 2 * W);
+                uint64_t m3 = descent_mask_512<T, Rev>(a + i + 3 * W);
+                if (FYX_UNLIKELY((m0 | m1) | (m2 | m3))) {
+                    if (m0) return i + static_cast<size_t>(__builtin_ctzll(m0)) + 1;
+                    if (m1) return i + W + static_cast<size_t>(__builtin_ctzll(m1)) + 1;
+                    if (m2) return i + 2 * W + static_cast<size_t>(__builtin_ctzll(m2)) + 1;
+                    return i + 3 * W + static_cast<size_t>(__builtin_ctzll(m3)) + 1;
+                }
+            }
+            for (; i + W < n; i += W) {
+                uint64_t m = descent_mask_512<T, Rev>(a + i);
+                if (m) return i + static_cast<size_t>(__builtin_ctzll(m)) + 1;
+            }
+        }
+        for (; i + 1 < n; ++i) {
+            if (Rev ? a[i] < a[i + 1] : a[i + 1] < a[i]) return i + 1;
+        }
+        return n;
+    }
+    
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_AVX512 size_t count_descents_512(const T* a, size_t n) noexcept {
+        size_t i = 0, cnt = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 64 / sizeof(T);
+            for (; i + 2 * W < n; i += 2 * W) {
+                cnt += static_cast<size_t>(_mm_popcnt_u64(descent_mask_512<T, Rev>(a + i)));
+                cnt += static_cast<size_t>(_mm_popcnt_u64(descent_mask_512<T, Rev>(a + i + W)));
+            }
+        }
+        for (; i + 1 < n; ++i) {
+            cnt += Rev ? (a[i] < a[i + 1]) : (a[i + 1] < a[i]);
+        }
+        return cnt;
+    }
+
+    // 通道i与通道i^D交换的置换
+    template<size_t D>
+    FYX_INLINE FYX_TARGET_AVX512 __m512i xor_lanes_32(__m512i x) noexcept {
+        const __m512i idx = _mm512_xor_si512(
+            _mm512_set_epi32(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0), _mm512_set1_epi32(static_cast<int>(D)));
+        return _mm512_permutexvar_epi32(idx, x);
+    }
+    
+    template<size_t D>
+    FYX_INLINE FYX_TARGET_AVX512 __m512i xor_lanes_64(__m512i x) noexcept {
+        const __m512i idx = _mm512_xor_si512(
+            _mm512_set_epi64(7,6,5,4,3,2,1,0), _mm512_set1_epi64(static_cast<long long>(D)));
+        return _mm512_permutexvar_epi64(idx, x);
+    }
+    
+    // 向量化快排分区原语: ge/gt给出应放到右侧的通道 (浮点NaN一律视为大)
+    template<typename T> struct VecOps;
+    
+    template<> struct VecOps<int32_t> {
+        using reg = __m512i;
+        using mask = __mmask16;
+        static constexpr size_t W = 16;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const int32_t* p) noexcept { return _mm512_loadu_si512(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(int32_t v) noexcept { return _mm512_set1_epi32(v); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmpge_epi32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmpgt_epi32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(int32_t* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_epi32(p, m, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epi32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const int32_t* p) noexcept { return _mm512_maskz_loadu_epi32(m, p); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX512 void store(int32_t* p, reg x) noexcept { _mm512_storeu_si512(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg min(reg x, reg y) noexcept { return _mm512_min_epi32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg max(reg x, reg y) noexcept { return _mm512_max_epi32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_epi32(_mm512_load_si512(get_tables().rev_idx_16), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return xor_lanes_32<D>(x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_epi32(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const int32_t* p) noexcept { return _mm512_mask_loadu_epi32(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(int32_t* p, size_t k, reg x) noexcept { _mm512_mask_storeu_epi32(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+    };
+    
+    template<> struct VecOps<uint32_t> {
+        using reg = __m512i;
+        using mask = __mmask16;
+        static constexpr size_t W = 16;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const uint32_t* p) noexcept { return _mm512_loadu_si512(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(uint32_t v) noexcept { return _mm512_set1_epi32(static_cast<int32_t>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmpge_epu32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmpgt_epu32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(uint32_t* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_epi32(p, m, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epu32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi32_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const uint32_t* p) noexcept { return _mm512_maskz_loadu_epi32(m, p); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX512 void store(uint32_t* p, reg x) noexcept { _mm512_storeu_si512(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg min(reg x, reg y) noexcept { return _mm512_min_epu32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg max(reg x, reg y) noexcept { return _mm512_max_epu32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_epi32(_mm512_load_si512(get_tables().rev_idx_16), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return xor_lanes_32<D>(x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_epi32(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const uint32_t* p) noexcept { return _mm512_mask_loadu_epi32(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(uint32_t* p, size_t k, reg x) noexcept { _mm512_mask_storeu_epi32(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+    };
+    
+    template<> struct VecOps<int64_t> {
+        using reg = __m512i;
+        using mask = __mmask8;
+        static constexpr size_t W = 8;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const int64_t* p) noexcept { return _mm512_loadu_si512(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(int64_t v) noexcept { return _mm512_set1_epi64(v); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmpge_epi64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmpgt_epi64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(int64_t* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_epi64(p, m, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epi64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const int64_t* p) noexcept { return _mm512_maskz_loadu_epi64(m, p); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX512 void store(int64_t* p, reg x) noexcept { _mm512_storeu_si512(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg min(reg x, reg y) noexcept { return _mm512_min_epi64(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg max(reg x, reg y) noexcept { return _mm512_max_epi64(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_epi64(_mm512_load_si512(get_tables().rev_idx_8), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return xor_lanes_64<D>(x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_epi64(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const int64_t* p) noexcept { return _mm512_mask_loadu_epi64(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(int64_t* p, size_t k, reg x) noexcept { _mm512_mask_storeu_epi64(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+    };
+    
+    template<> struct VecOps<uint64_t> {
+        using reg = __m512i;
+        using mask = __mmask8;
+        static constexpr size_t W = 8;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const uint64_t* p) noexcept { return _mm512_loadu_si512(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(uint64_t v) noexcept { return _mm512_set1_epi64(static_cast<int64_t>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmpge_epu64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmpgt_epu64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(uint64_t* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_epi64(p, m, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epu64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi64_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const uint64_t* p) noexcept { return _mm512_maskz_loadu_epi64(m, p); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX512 void store(uint64_t* p, reg x) noexcept { _mm512_storeu_si512(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg min(reg x, reg y) noexcept { return _mm512_min_epu64(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg max(reg x, reg y) noexcept { return _mm512_max_epu64(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_epi64(_mm512_load_si512(get_tables().rev_idx_8), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return xor_lanes_64<D>(x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_epi64(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const uint64_t* p) noexcept { return _mm512_mask_loadu_epi64(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(uint64_t* p, size_t k, reg x) noexcept { _mm512_mask_storeu_epi64(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+    };
+    
+    template<> struct VecOps<float> {
+        using reg = __m512;
+        using mask = __mmask16;
+        static constexpr size_t W = 16;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const float* p) noexcept { return _mm512_loadu_ps(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(float v) noexcept { return _mm512_set1_ps(v); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmp_ps_mask(x, p, _CMP_NLT_UQ); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmp_ps_mask(x, p, _CMP_NLE_UQ); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(float* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_ps(p, m, x); }
+        // 补齐网络用 (NaN由调用方先剔除)。min_ps/max_ps对(-0.0, +0.0)都返回第二个操作数，
+        // 比较交换不是置换，所以网络在保序整数键上跑: 负数翻转除符号位外的各位 (自逆)
+        using key = VecOps<int32_t>;
+        static FYX_INLINE FYX_TARGET_AVX512 key::reg to_key(reg x) noexcept {
+            __m512i s = _mm512_castps_si512(x);
+            return _mm512_xor_si512(s, _mm512_srli_epi32(_mm512_srai_epi32(s, 31), 1));
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 reg from_key(key::reg k) noexcept {
+            return _mm512_castsi512_ps(_mm512_xor_si512(k, _mm512_srli_epi32(_mm512_srai_epi32(k, 31), 1)));
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 void store(float* p, reg x) noexcept { _mm512_storeu_ps(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_ps(_mm512_load_si512(get_tables().rev_idx_16), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return _mm512_castsi512_ps(xor_lanes_32<D>(_mm512_castps_si512(x))); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_ps(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const float* p) noexcept { return _mm512_mask_loadu_ps(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(float* p, size_t k, reg x) noexcept { _mm512_mask_storeu_ps(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask unordered(reg x) noexcept { return _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q); }
+    };
+    
+    template<> struct VecOps<double> {
+        using reg = __m512d;
+        using mask = __mmask8;
+        static constexpr size_t W = 8;
+        static FYX_INLINE FYX_TARGET_AVX512 reg load(const double* p) noexcept { return _mm512_loadu_pd(p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(double v) noexcept { return _mm512_set1_pd(v); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask ge(reg x, reg p) noexcept { return _mm512_cmp_pd_mask(x, p, _CMP_NLT_UQ); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask gt(reg x, reg p) noexcept { return _mm512_cmp_pd_mask(x, p, _CMP_NLE_UQ); }
+        static FYX_INLINE FYX_TARGET_AVX512 void compress_store(double* p, mask m, reg x) noexcept { _mm512_mask_compressstoreu_pd(p, m, x); }
+        // 补齐网络用 (NaN由调用方先剔除)，同float走保序整数键
+        using key = VecOps<int64_t>;
+        static FYX_INLINE FYX_TARGET_AVX512 key::reg to_key(reg x) noexcept {
+            __m512i s = _mm512_castpd_si512(x);
+            return _mm512_xor_si512(s, _mm512_srli_epi64(_mm512_srai_epi64(s, 63), 1));
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 reg from_key(key::reg k) noexcept {
+            return _mm512_castsi512_pd(_mm512_xor_si512(k, _mm512_srli_epi64(_mm512_srai_epi64(k, 63), 1)));
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 void store(double* p, reg x) noexcept { _mm512_storeu_pd(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg reverse(reg x) noexcept { return _mm512_permutexvar_pd(_mm512_load_si512(get_tables().rev_idx_8), x); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg xor_perm(reg x) noexcept { return _mm512_castsi512_pd(xor_lanes_64<D>(_mm512_castpd_si512(x))); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX512 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm512_mask_blend_pd(static_cast<mask>(lane_bit_mask<W, D>()), lo, hi);
+        }
+        static FYX_INLINE FYX_TARGET_AVX512 reg mask_load(reg src, size_t k, const double* p) noexcept { return _mm512_mask_loadu_pd(src, static_cast<mask>((uint64_t(1) << k) - 1), p); }
+        static FYX_INLINE FYX_TARGET_AVX512 void mask_store(double* p, size_t k, reg x) noexcept { _mm512_mask_storeu_pd(p, static_cast<mask>((uint64_t(1) << k) - 1), x); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask unordered(reg x) noexcept { return _mm512_cmp_pd_mask(x, x, _CMP_UNORD_Q); }
+    };
+    
+    // 8/16位通道只用于计数名次排序 (需要AVX-512BW)
+    template<> struct VecOps<int8_t> {
+        using reg = __m512i;
+        using mask = __mmask64;
+        static constexpr size_t W = 64;
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(int8_t v) noexcept { return _mm512_set1_epi8(static_cast<char>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epi8_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi8_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const int8_t* p) noexcept { return _mm512_maskz_loadu_epi8(m, p); }
+    };
+    
+    template<> struct VecOps<uint8_t> {
+        using reg = __m512i;
+        using mask = __mmask64;
+        static constexpr size_t W = 64;
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(uint8_t v) noexcept { return _mm512_set1_epi8(static_cast<char>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epu8_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi8_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const uint8_t* p) noexcept { return _mm512_maskz_loadu_epi8(m, p); }
+    };
+    
+    template<> struct VecOps<int16_t> {
+        using reg = __m512i;
+        using mask = __mmask32;
+        static constexpr size_t W = 32;
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(int16_t v) noexcept { return _mm512_set1_epi16(static_cast<short>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epi16_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi16_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const int16_t* p) noexcept { return _mm512_maskz_loadu_epi16(m, p); }
+    };
+    
+    template<> struct VecOps<uint16_t> {
+        using reg = __m512i;
+        using mask = __mmask32;
+        static constexpr size_t W = 32;
+        static FYX_INLINE FYX_TARGET_AVX512 reg set1(uint16_t v) noexcept { return _mm512_set1_epi16(static_cast<short>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask lt(reg x, reg p) noexcept { return _mm512_cmplt_epu16_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 mask eq(reg x, reg p) noexcept { return _mm512_cmpeq_epi16_mask(x, p); }
+        static FYX_INLINE FYX_TARGET_AVX512 reg maskz_load(mask m, const uint16_t* p) noexcept { return _mm512_maskz_loadu_epi16(m, p); }
+    };
+    
+    // 计数名次排序: 名次 = 比它小的个数 + 在它之前与它相等的个数。
+    // 每个元素一次广播比较即可定位，不需要通道置换，8/16位通道和任意长度都适用
+    template<typename T>
+    FYX_TARGET_AVX512 void rank_sort_512(T* a, size_t n) noexcept {
+        using L = traits::lane_t<T>;
+        using V = VecOps<L>;
+        constexpr size_t W = V::W;
+        constexpr size_t MAXV = (config::SIMD_RANK_SORT_LIMIT + W - 1) / W;
+        
+        const size_t nv = (n + W - 1) / W;
+        const size_t tail = n - (nv - 1) * W;
+        const uint64_t last_valid = tail == 64 ? ~uint64_t(0) : (uint64_t(1) << tail) - 1;
+        typename V::reg x[MAXV] = {};
+        for (size_t v = 0; v < nv; ++v) {
+            uint64_t m = v + 1 < nv ? ~uint64_t(0) : last_valid;
+            x[v] = V::maskz_load(static_cast<typename V::mask>(m), reinterpret_cast<const L*>(a + v * W));
+        }
+        
+        T out[config::SIMD_RANK_SORT_LIMIT];
+        for (size_t i = 0; i < n; ++i) {
+            const typename V::reg p = V::set1(static_cast<L>(a[i]));
+            const size_t iv = i / W;
+            size_t r = 0;
+            for (size_t v = 0; v < nv; ++v) {
+                uint64_t lt = static_cast<uint64_t>(V::lt(x[v], p));
+                if (v + 1 == nv) lt &= last_valid;
+                r += static_cast<size_t>(__builtin_popcountll(lt));
+                if (v <= iv) {
+                    uint64_t eq = static_cast<uint64_t>(V::eq(x[v], p));
+                    if (v == iv) eq &= (uint64_t(1) << (i % W)) - 1;
+                    r += static_cast<size_t>(__builtin_popcountll(eq));
+                }
+            }
+            out[r] = a[i];
+        }
+        std::memcpy(a, out, n * sizeof(T));
+    }
+    
+    // 双调清洗: 对双调序列逐层做距离D的比较交换，得到升序
+    template<typename V, size_t D>
+    FYX_INLINE FYX_TARGET_AVX512 void bitonic_clean(typename V::reg& x) noexcept {
+        if constexpr (D > 0) {
+            typename V::reg t = V::template xor_perm<D>(x);
+            x = V::template blend_hi<D>(V::min(x, t), V::max(x, t));
+            bitonic_clean<V, D / 2>(x);
+        }
+    }
+    
+    // 两个升序向量归并: 结束后lo为较小的W个、hi为较大的W个，各自升序
+    template<typename V>
+    FYX_INLINE FYX_TARGET_AVX512 void merge_pair(typename V::reg& lo, typename V::reg& hi) noexcept {
+        typename V::reg r = V::reverse(hi);
+        typename V::reg l = V::min(lo, r);
+        typename V::reg h = V::max(lo, r);
+        bitonic_clean<V, V::W / 2>(l);
+        bitonic_clean<V, V::W / 2>(h);
+        lo = l;
+        hi = h;
+    }
+
+    // 寄存器内双调排序: 块长S从2倍增到W，每级先镜像比较 (i与i^(S-1)) 再清洗
+    template<typename V, size_t S = 2>
+    FYX_INLINE FYX_TARGET_AVX512 void sort_reg(typename V::reg& x) noexcept {
+        if constexpr (S <= V::W) {
+            typename V::reg t = V::template xor_perm<S - 1>(x);
+            x = V::template blend_hi<S / 2>(V::min(x, t), V::max(x, t));
+            bitonic_clean<V, S / 4>(x);
+            sort_reg<V, S * 2>(x);
+        }
+    }
+    
+    // NV个寄存器 (2的幂) 整体排序: 各自排好后按块倍增归并，
+    // 块内镜像比较 + 寄存器间半清洗 + 寄存器内清洗
+    template<typename V, size_t NV>
+    FYX_INLINE FYX_TARGET_AVX512 void sort_regs(typename V::reg* x) noexcept {
+        for (size_t v = 0; v < NV; ++v) sort_reg<V>(x[v]);
+        for (size_t b = 2; b <= NV; b *= 2) {
+            for (size_t base = 0; base < NV; base += b) {
+                for (size_t j = 0; j < b / 2; ++j) {
+                    typename V::reg r = V::reverse(x[base + b - 1 - j]);
+                    typename V::reg h = V::max(x[base + j], r);
+                    x[base + j] = V::min(x[base + j], r);
+                    x[base + b - 1 - j] = V::reverse(h);
+                }
+            }
+            for (size_t d = b / 4; d > 0; d /= 2) {
+                for (size_t j = 0; j < NV; ++j) {
+                    if (j & d) continue;
+                    typename V::reg h = V::max(x[j], x[j + d]);
+                    x[j] = V::min(x[j], x[j + d]);
+                    x[j + d] = h;
+                }
+            }
+            for (size_t v = 0; v < NV; ++v) bitonic_clean<V, V::W / 2>(x[v]);
+        }
+    }
+    
+    // 任意长度 (≤ NV*W) 的补齐网络: 不足的通道和寄存器填类型最大值，
+    // 掩码载入/写回只碰前n个元素。浮点含NaN时返回false，交给标量路径；
+    // 其余浮点在保序整数键上排序，±0按位原样保留
+    template<size_t NV, typename L>
+    FYX_NOINLINE FYX_TARGET_AVX512 bool sort_padded_512(L* a, size_t n) noexcept {
+        using V = VecOps<L>;
+        constexpr size_t W = V::W;
+        const typename V::reg pad = V::set1(std::is_floating_point_v<L> ?
+            std::numeric_limits<L>::infinity() : std::numeric_limits<L>::max());
+        typename V::reg x[NV];
+        const size_t full = n / W, tail = n % W;
+        for (size_t v = 0; v < NV; ++v) {
+            if (v < full) x[v] = V::load(a + v * W);
+            else if (v == full && tail) x[v] = V::mask_load(pad, tail, a + v * W);
+            else x[v] = pad;
+        }
+        if constexpr (std::is_floating_point_v<L>) {
+            uint64_t nan = 0;
+            for (size_t v = 0; v < NV; ++v) nan |= static_cast<uint64_t>(V::unordered(x[v]));
+            if (nan) return false;
+            typename V::key::reg k[NV];
+            for (size_t v = 0; v < NV; ++v) k[v] = V::to_key(x[v]);
+            sort_regs<typename V::key, NV>(k);
+            for (size_t v = 0; v < NV; ++v) x[v] = V::from_key(k[v]);
+        } else {
+            sort_regs<V, NV>(x);
+        }
+        for (size_t v = 0; v < full; ++v) V::store(a + v * W, x[v]);
+        if (tail) V::mask_store(a + full * W, tail, x[full]);
+        return true;
+    }
+    
+    // 按寄存器个数向上取2的幂选网络规模，n ≤ config::SIMD_NETWORK_LIMIT
+    template<typename L>
+    FYX_TARGET_AVX512 bool sort_network_512(L* a, size_t n) noexcept {
+        constexpr size_t W = VecOps<L>::W;
+        constexpr size_t MAXV = config::SIMD_NETWORK_LIMIT / W;
+        const size_t nv = (n + W - 1) / W;
+        if (nv <= 1) return sort_padded_512<1>(a, n);
+        if (nv <= 2) return sort_padded_512<2>(a, n);
+        if (nv <= 4) return sort_padded_512<4>(a, n);
+        if (nv <= 8) return sort_padded_512<8>(a, n);
+        if constexpr (MAXV >= 16) { if (nv <= 16) return sort_padded_512<16>(a, n); }
+        if constexpr (MAXV >= 32) { if (nv <= 32) return sort_padded_512<32>(a, n); }
+        if constexpr (MAXV >= 64) { if (nv <= 64) return sort_padded_512<64>(a, n); }
+        return false;
+    }
+}
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+#endif // FYX_AVX512_KERNELS
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十三部分: AVX2 SIMD核心
+// ═══════════════════════════════════════════════════════════════════════════
+
+#ifdef FYX_AVX2_KERNELS
+namespace simd256 {
+    using namespace simd_tables;
+    
+    FYX_INLINE FYX_TARGET_AVX2 __m256i sort_8xi32(__m256i v) noexcept {
+        __m256i t, mn, mx;
+        
+        t = _mm256_shuffle_epi32(v, 0xB1);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xAA);
+        
+        t = _mm256_shuffle_epi32(v, 0x1B);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xCC);
+        
+        t = _mm256_shuffle_epi32(v, 0xB1);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xAA);
+        
+        t = _mm256_permute2x128_si256(v, v, 0x01);
+        t = _mm256_shuffle_epi32(t, 0x1B);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xF0);
+        
+        t = _mm256_shuffle_epi32(v, 0x4E);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xCC);
+        
+        t = _mm256_shuffle_epi32(v, 0xB1);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xAA);
+        
+        return v;
+    }
+    
+    // 8元素双调序列合并 (距离4/2/1三层)
+    FYX_INLINE FYX_TARGET_AVX2 void bitonic_merge_8(__m256i& v) noexcept {
+        __m256i t, mn, mx;
+        
+        t = _mm256_permute2x128_si256(v, v, 0x01);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xF0);
+        
+        t = _mm256_shuffle_epi32(v, 0x4E);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xCC);
+        
+        t = _mm256_shuffle_epi32(v, 0xB1);
+        mn = _mm256_min_epi32(v, t);
+        mx = _mm256_max_epi32(v, t);
+        v = _mm256_blend_epi32(mn, mx, 0xAA);
+    }
+    
+    FYX_INLINE FYX_TARGET_AVX2 void sort_16xi32(int32_t* arr) noexcept {
+        __m256i v0 = _mm256_loadu_si256((__m256i*)arr);
+        __m256i v1 = _mm256_loadu_si256((__m256i*)(arr + 8));
+        
+        v0 = sort_8xi32(v0);
+        v1 = sort_8xi32(v1);
+        
+        v1 = _mm256_permute2x128_si256(v1, v1, 0x01);
+        v1 = _mm256_shuffle_epi32(v1, 0x1B);
+        
+        __m256i mn = _mm256_min_epi32(v0, v1);
+        __m256i mx = _mm256_max_epi32(v0, v1);
+        v0 = mn;
+        v1 = mx;
+        
+        bitonic_merge_8(v0);
+        bitonic_merge_8(v1);
+        
+        _mm256_storeu_si256((__m256i*)arr, v0);
+        _mm256_storeu_si256((__m256i*)(arr + 8), v1);
+    }
+    
+    FYX_INLINE FYX_TARGET_AVX2 void sort_32xi32(int32_t* arr) noexcept {
+        sort_16xi32(arr);
         sort_16xi32(arr + 16);
         
         __m256i a0 = _mm256_loadu_si256((__m256i*)(arr));
@@ -2004,42 +2822,20 @@ namespace simd256 {
         a0 = mn0; a1 = mn1;
         b0 = mx0; b1 = mx1;
         
-        auto merge8 = [](__m256i& v) {
-            __m256i t, mn, mx;
-            
-            t = _mm256_permute2x128_si256(v, v, 0x01);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xF0);
-            
-            t = _mm256_shuffle_epi32(v, 0x4E);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xCC);
-            
-            t = _mm256_shuffle_epi32(v, 0xB1);
-            mn = _mm256_min_epi32(v, t);
-            mx = _mm256_max_epi32(v, t);
-            v = _mm256_blend_epi32(mn, mx, 0xAA);
-        };
-        
-        __m256i t0 = _mm256_permute2x128_si256(a0, a1, 0x20);
-        __m256i t1 = _mm256_permute2x128_si256(a0, a1, 0x31);
-        __m256i mnt = _mm256_min_epi32(t0, t1);
-        __m256i mxt = _mm256_max_epi32(t0, t1);
-        a0 = _mm256_permute2x128_si256(mnt, mxt, 0x20);
-        a1 = _mm256_permute2x128_si256(mnt, mxt, 0x31);
-        merge8(a0);
-        merge8(a1);
-        
-        t0 = _mm256_permute2x128_si256(b0, b1, 0x20);
-        t1 = _mm256_permute2x128_si256(b0, b1, 0x31);
-        mnt = _mm256_min_epi32(t0, t1);
-        mxt = _mm256_max_epi32(t0, t1);
-        b0 = _mm256_permute2x128_si256(mnt, mxt, 0x20);
-        b1 = _mm256_permute2x128_si256(mnt, mxt, 0x31);
-        merge8(b0);
-        merge8(b1);
+        // 两个16元素双调序列: 先做距离8的半清洗，再各自8元素合并
+        __m256i mnt = _mm256_min_epi32(a0, a1);
+        __m256i mxt = _mm256_max_epi32(a0, a1);
+        a0 = mnt;
+        a1 = mxt;
+        bitonic_merge_8(a0);
+        bitonic_merge_8(a1);
+        
+        mnt = _mm256_min_epi32(b0, b1);
+        mxt = _mm256_max_epi32(b0, b1);
+        b0 = mnt;
+        b1 = mxt;
+        bitonic_merge_8(b0);
+        bitonic_merge_8(b1);
         
         _mm256_storeu_si256((__m256i*)(arr), a0);
         _mm256_storeu_si256((__m256i*)(arr + 8), a1);
@@ -2048,7 +2844,7 @@ namespace simd256 {
     }
     
     template<typename T>
-    std::pair<T, T> find_minmax_256(const T* data, size_t n) noexcept {
+    FYX_TARGET_AVX2 std::pair<T, T> find_minmax_256(const T* data, size_t n) noexcept {
         if (n == 0) return {T{}, T{}};
         if (n == 1) return {data[0], data[0]};
         
@@ -2126,8 +2922,8 @@ namespace simd256 {
     }
     
     template<typename T>
-    FYX_NOINLINE void histogram_256(const T* FYX_RESTRICT data, size_t n, 
-                                     size_t* FYX_RESTRICT counts, int shift) noexcept {
+    FYX_NOINLINE FYX_TARGET_AVX2 void histogram_256(const T* FYX_RESTRICT data, size_t n, 
+                                                     size_t* FYX_RESTRICT counts, int shift) noexcept {
         using M = keymap::Mapper<T>;
         constexpr size_t MASK = 255;
         
@@ -2157,8 +2953,8 @@ namespace simd256 {
     }
     
     template<typename T>
-    FYX_NOINLINE void scatter_256(const T* FYX_RESTRICT src, T* FYX_RESTRICT dst, 
-                                   size_t n, size_t* FYX_RESTRICT offsets, int shift) noexcept {
+    FYX_NOINLINE FYX_TARGET_AVX2 void scatter_256(const T* FYX_RESTRICT src, T* FYX_RESTRICT dst, 
+                                                   size_t n, size_t* FYX_RESTRICT offsets, int shift) noexcept {
         using M = keymap::Mapper<T>;
         constexpr size_t MASK = 255;
         
@@ -2194,1580 +2990,5163 @@ namespace simd256 {
             dst[offsets[b]++] = v;
         }
     }
-}
-#endif // FYX_AVX2
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第十四部分: 统一SIMD接口
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace simd {
-    template<typename T>
-    FYX_INLINE std::pair<T, T> find_minmax(const T* data, size_t n) noexcept {
-#ifdef FYX_AVX512
-        return simd512::find_minmax_512(data, n);
-#elif defined(FYX_AVX2)
-        return simd256::find_minmax_256(data, n);
-#else
-        if (n == 0) return {T{}, T{}};
-        T mn = data[0], mx = data[0];
-        for (size_t i = 1; i < n; ++i) {
-            if (data[i] < mn) mn = data[i];
-            if (data[i] > mx) mx = data[i];
+    
+    // 键变换，同simd512::key_transform_512；AVX2没有64位算术右移，符号掩码用比较代替
+    template<typename T, bool Inverse>
+    FYX_INLINE FYX_TARGET_AVX2 __m256i key_transform_256(__m256i v) noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            __m256i s = _mm256_srai_epi32(v, 31);
+            if constexpr (Inverse) s = _mm256_xor_si256(s, _mm256_set1_epi32(-1));
+            return _mm256_xor_si256(v, _mm256_or_si256(s, _mm256_set1_epi32(INT32_MIN)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            __m256i s = _mm256_cmpgt_epi64(_mm256_setzero_si256(), v);
+            if constexpr (Inverse) s = _mm256_xor_si256(s, _mm256_set1_epi64x(-1));
+            return _mm256_xor_si256(v, _mm256_or_si256(s, _mm256_set1_epi64x(INT64_MIN)));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) return _mm256_xor_si256(v, _mm256_set1_epi8(INT8_MIN));
+            else if constexpr (sizeof(T) == 2) return _mm256_xor_si256(v, _mm256_set1_epi16(INT16_MIN));
+            else if constexpr (sizeof(T) == 4) return _mm256_xor_si256(v, _mm256_set1_epi32(INT32_MIN));
+            else return _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN));
+        } else {
+            return v;
         }
-        return {mn, mx};
-#endif
     }
     
-    template<typename T>
-    FYX_INLINE void histogram(const T* data, size_t n, size_t* counts, int shift) noexcept {
-#ifdef FYX_AVX512
-        simd512::histogram_512(data, n, counts, shift);
-#elif defined(FYX_AVX2)
-        simd256::histogram_256(data, n, counts, shift);
-#else
-        using M = keymap::Mapper<T>;
-        for (size_t i = 0; i < n; ++i) {
-            ++counts[(M::to_key(data[i]) >> shift) & 255];
+    template<typename T, bool Inverse>
+    FYX_NOINLINE FYX_TARGET_AVX2 void transform_keys_256(const keymap::xform_src_t<T, Inverse>* src,
+                                                          keymap::xform_dst_t<T, Inverse>* dst, size_t n) noexcept {
+        constexpr size_t W = 32 / sizeof(T);
+        size_t i = 0;
+        for (; i + W <= n; i += W) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), key_transform_256<T, Inverse>(v));
         }
-#endif
+        for (; i < n; ++i) keymap::transform_at<T, Inverse>(src + i, dst + i);
     }
-    
-    template<typename T>
-    FYX_INLINE void scatter(const T* src, T* dst, size_t n, size_t* offsets, int shift) noexcept {
-#ifdef FYX_AVX512
-        simd512::scatter_512(src, dst, n, offsets, shift);
-#elif defined(FYX_AVX2)
-        simd256::scatter_256(src, dst, n, offsets, shift);
-#else
-        using M = keymap::Mapper<T>;
-        for (size_t i = 0; i < n; ++i) {
-            T v = src[i];
-            size_t b = (M::to_key(v) >> shift) & 255;
-            dst[offsets[b]++] = v;
+
+    // 相邻下降检测，同simd128::descent_mask (每通道sizeof(T)个字节位)
+    template<typename T, bool Rev = false>
+    FYX_INLINE FYX_TARGET_AVX2 uint32_t descent_mask_256(const T* p) noexcept {
+        const T* lo = Rev ? p : p + 1;
+        const T* hi = Rev ? p + 1 : p;
+        int m;
+        if constexpr (std::is_same_v<T, float>) {
+            m = _mm256_movemask_epi8(_mm256_castps_si256(
+                _mm256_cmp_ps(_mm256_loadu_ps(lo), _mm256_loadu_ps(hi), _CMP_LT_OQ)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            m = _mm256_movemask_epi8(_mm256_castpd_si256(
+                _mm256_cmp_pd(_mm256_loadu_pd(lo), _mm256_loadu_pd(hi), _CMP_LT_OQ)));
+        } else {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lo));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hi));
+            if constexpr (std::is_unsigned_v<T>) {
+                __m256i flip;
+                if constexpr (sizeof(T) == 1) flip = _mm256_set1_epi8(INT8_MIN);
+                else if constexpr (sizeof(T) == 2) flip = _mm256_set1_epi16(INT16_MIN);
+                else if constexpr (sizeof(T) == 4) flip = _mm256_set1_epi32(INT32_MIN);
+                else flip = _mm256_set1_epi64x(INT64_MIN);
+                x = _mm256_xor_si256(x, flip);
+                y = _mm256_xor_si256(y, flip);
+            }
+            if constexpr (sizeof(T) == 1) m = _mm256_movemask_epi8(_mm256_cmpgt_epi8(y, x));
+            else if constexpr (sizeof(T) == 2) m = _mm256_movemask_epi8(_mm256_cmpgt_epi16(y, x));
+            else if constexpr (sizeof(T) == 4) m = _mm256_movemask_epi8(_mm256_cmpgt_epi32(y, x));
+            else m = _mm256_movemask_epi8(_mm256_cmpgt_epi64(y, x));
         }
-#endif
+        return static_cast<uint32_t>(m);
     }
     
-    template<typename T>
-    FYX_INLINE void sort_small_simd(T* arr, size_t n) noexcept {
-        if constexpr (std::is_same_v<T, int32_t>) {
-#ifdef FYX_AVX512
-            if (n == 128) { simd512::sort_128xi32(arr); return; }
-            if (n == 64) { simd512::sort_64xi32(arr); return; }
-            if (n == 32) { simd512::sort_32xi32(arr); return; }
-            if (n == 16) {
-                __m512i v = simd512::sort_16xi32(_mm512_loadu_si512(arr));
-                _mm512_storeu_si512(arr, v);
-                return;
+    template<typename T, bool Rev>
+    FYX_INLINE FYX_TARGET_AVX2 uint64_t descent_mask_256x2(const T* p) noexcept {
+        constexpr size_t W = 32 / sizeof(T);
+        return static_cast<uint64_t>(descent_mask_256<T, Rev>(p)) |
+               (static_cast<uint64_t>(descent_mask_256<T, Rev>(p + W)) << 32);
+    }
+    
+    // 最长非降 (Rev: 非增) 前缀；每轮扫4个向量，有下降时再定位
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_AVX2 size_t sorted_prefix_256(const T* a, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 32 / sizeof(T);
+            for (; i + 4 * W < n; i += 4 * W) {
+                uint64_t m0 = descent_mask_256x2<T, Rev>(a + i);
+                uint64_t m1 = descent_mask_256x2<T, Rev>(a + i + 2 * W);
+                if (FYX_UNLIKELY(m0 | m1)) {
+                    if (m0) return i + static_cast<size_t>(__builtin_ctzll(m0)) / sizeof(T) + 1;
+                    return i + 2 * W + static_cast<size_t>(__builtin_ctzll(m1)) / sizeof(T) + 1;
+                }
             }
-#endif
-#ifdef FYX_AVX2
-            if (n == 32) { simd256::sort_32xi32(arr); return; }
-            if (n == 16) { simd256::sort_16xi32(arr); return; }
-            if (n == 8) {
-                __m256i v = simd256::sort_8xi32(_mm256_loadu_si256((__m256i*)arr));
-                _mm256_storeu_si256((__m256i*)arr, v);
-                return;
+            for (; i + W < n; i += W) {
+                uint32_t m = descent_mask_256<T, Rev>(a + i);
+                if (m) return i + static_cast<size_t>(__builtin_ctz(m)) / sizeof(T) + 1;
             }
-#endif
         }
-        else if constexpr (std::is_same_v<T, double>) {
-#ifdef FYX_AVX512
-            if (n == 16) { simd512::sort_16xf64(arr); return; }
-            if (n == 8) {
-                __m512d v = simd512::sort_8xf64(_mm512_loadu_pd(arr));
-                _mm512_storeu_pd(arr, v);
-                return;
-            }
-#endif
+        for (; i + 1 < n; ++i) {
+            if (Rev ? a[i] < a[i + 1] : a[i + 1] < a[i]) return i + 1;
         }
-        else if constexpr (std::is_same_v<T, float>) {
-#ifdef FYX_AVX512
-            if (n == 16) {
-                __m512 v = simd512::sort_16xf32(_mm512_loadu_ps(arr));
-                _mm512_storeu_ps(arr, v);
-                return;
+        return n;
+    }
+    
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_AVX2 size_t count_descents_256(const T* a, size_t n) noexcept {
+        size_t i = 0, bits = 0, cnt = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 32 / sizeof(T);
+            for (; i + 2 * W < n; i += 2 * W) {
+                bits += static_cast<size_t>(_mm_popcnt_u64(descent_mask_256x2<T, Rev>(a + i)));
             }
-#endif
+            cnt = bits / sizeof(T);
         }
+        for (; i + 1 < n; ++i) {
+            cnt += Rev ? (a[i] < a[i + 1]) : (a[i + 1] < a[i]);
+        }
+        return cnt;
     }
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第十五部分: 排序网络
-// ═══════════════════════════════════════════════════════════════════════════
 
-namespace sortnet {
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort2(T* a, Cmp& c) noexcept { 
-        ops::cswap(a[0], a[1], c); 
-    }
+    // 向量化快排分区原语: 比较结果转成位掩码，再查表把右侧通道置换到高端
+    template<typename T> struct VecOps;
+    
+    template<> struct VecOps<int32_t> {
+        using reg = __m256i;
+        using mask = unsigned;
+        static constexpr size_t W = 8;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const int32_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(int32_t* p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(int32_t v) noexcept { return _mm256_set1_epi32(v); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, x)))) & 0xFFu; }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, p)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_32[m])));
+        }
+        // 计数名次排序用: 逐字节掩码，每个通道占sizeof(T)位
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(p, x))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, p))); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX2 reg min(reg x, reg y) noexcept { return _mm256_min_epi32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg max(reg x, reg y) noexcept { return _mm256_max_epi32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7,6,5,4,3,2,1,0)); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0^D, 1^D, 2^D, 3^D, 4^D, 5^D, 6^D, 7^D));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm256_blend_epi32(lo, hi, static_cast<int>(lane_bit_mask<8, D>()));
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(k)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const int32_t* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_epi8(src, _mm256_maskload_epi32(reinterpret_cast<const int*>(p), m), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(int32_t* p, size_t k, reg x) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int*>(p), lane_mask(k), x); }
+    };
     
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort3(T* a, Cmp& c) noexcept {
-        ops::cswap(a[1], a[2], c); 
-        ops::cswap(a[0], a[2], c); 
-        ops::cswap(a[0], a[1], c);
-    }
+    template<> struct VecOps<uint32_t> {
+        using reg = __m256i;
+        using mask = unsigned;
+        static constexpr size_t W = 8;
+        // 无符号比较: 翻转符号位后按有符号比较
+        static FYX_INLINE FYX_TARGET_AVX2 reg flip(reg x) noexcept { return _mm256_xor_si256(x, _mm256_set1_epi32(INT32_MIN)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const uint32_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(uint32_t* p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(uint32_t v) noexcept { return _mm256_set1_epi32(static_cast<int32_t>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(flip(p), flip(x))))) & 0xFFu; }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(flip(x), flip(p))))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_32[m])));
+        }
+        // 计数名次排序用: 逐字节掩码，每个通道占sizeof(T)位
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi32(flip(p), flip(x)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, p))); }
+        // 流式双调归并用
+        static FYX_INLINE FYX_TARGET_AVX2 reg min(reg x, reg y) noexcept { return _mm256_min_epu32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg max(reg x, reg y) noexcept { return _mm256_max_epu32(x, y); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(7,6,5,4,3,2,1,0)); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0^D, 1^D, 2^D, 3^D, 4^D, 5^D, 6^D, 7^D));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm256_blend_epi32(lo, hi, static_cast<int>(lane_bit_mask<8, D>()));
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(k)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const uint32_t* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_epi8(src, _mm256_maskload_epi32(reinterpret_cast<const int*>(p), m), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(uint32_t* p, size_t k, reg x) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int*>(p), lane_mask(k), x); }
+    };
     
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort4(T* a, Cmp& c) noexcept {
-        ops::cswap(a[0], a[1], c); ops::cswap(a[2], a[3], c);
-        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
-        ops::cswap(a[1], a[2], c);
-    }
+    template<> struct VecOps<int64_t> {
+        using reg = __m256i;
+        using mask = unsigned;
+        static constexpr size_t W = 4;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const int64_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(int64_t* p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(int64_t v) noexcept { return _mm256_set1_epi64x(v); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(p, x)))) & 0xFu; }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(x, p)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_64[m])));
+        }
+        // 计数名次排序用: 逐字节掩码，每个通道占sizeof(T)位
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi64(p, x))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(x, p))); }
+        // 流式双调归并用
+        // AVX2没有64位min/max，用比较+混合代替
+        static FYX_INLINE FYX_TARGET_AVX2 reg min(reg x, reg y) noexcept { return _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(x, y)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg max(reg x, reg y) noexcept { return _mm256_blendv_epi8(y, x, _mm256_cmpgt_epi64(x, y)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permute4x64_epi64(x, 0x1B); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permute4x64_epi64(x, static_cast<int>((0^D) | (1^D) << 2 | (2^D) << 4 | (3^D) << 6));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            constexpr uint64_t m = lane_bit_mask<4, D>();
+            return _mm256_blend_epi32(lo, hi, static_cast<int>((m & 1) * 3 | (m & 2) * 6 | (m & 4) * 12 | (m & 8) * 24));
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(k)), _mm256_setr_epi64x(0, 1, 2, 3)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const int64_t* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_epi8(src, _mm256_maskload_epi64(reinterpret_cast<const long long*>(p), m), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(int64_t* p, size_t k, reg x) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long*>(p), lane_mask(k), x); }
+    };
     
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort5(T* a, Cmp& c) noexcept {
-        ops::cswap(a[0], a[1], c); ops::cswap(a[3], a[4], c);
-        ops::cswap(a[2], a[4], c); ops::cswap(a[2], a[3], c);
-        ops::cswap(a[1], a[4], c); ops::cswap(a[0], a[3], c);
-        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
-        ops::cswap(a[1], a[2], c);
+    template<> struct VecOps<uint64_t> {
+        using reg = __m256i;
+        using mask = unsigned;
+        static constexpr size_t W = 4;
+        static FYX_INLINE FYX_TARGET_AVX2 reg flip(reg x) noexcept { return _mm256_xor_si256(x, _mm256_set1_epi64x(INT64_MIN)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const uint64_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(uint64_t* p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(uint64_t v) noexcept { return _mm256_set1_epi64x(static_cast<int64_t>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(flip(p), flip(x))))) & 0xFu; }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(flip(x), flip(p))))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_permutevar8x32_epi32(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_64[m])));
+        }
+        // 计数名次排序用: 逐字节掩码，每个通道占sizeof(T)位
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi64(flip(p), flip(x)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(x, p))); }
+        // 流式双调归并用
+        // AVX2没有64位min/max，用比较+混合代替
+        static FYX_INLINE FYX_TARGET_AVX2 reg min(reg x, reg y) noexcept { return _mm256_blendv_epi8(x, y, _mm256_cmpgt_epi64(flip(x), flip(y))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg max(reg x, reg y) noexcept { return _mm256_blendv_epi8(y, x, _mm256_cmpgt_epi64(flip(x), flip(y))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permute4x64_epi64(x, 0x1B); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permute4x64_epi64(x, static_cast<int>((0^D) | (1^D) << 2 | (2^D) << 4 | (3^D) << 6));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            constexpr uint64_t m = lane_bit_mask<4, D>();
+            return _mm256_blend_epi32(lo, hi, static_cast<int>((m & 1) * 3 | (m & 2) * 6 | (m & 4) * 12 | (m & 8) * 24));
+        }
+        // 补齐网络用: 只载入/写回前k个通道，其余通道取src
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(k)), _mm256_setr_epi64x(0, 1, 2, 3)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const uint64_t* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_epi8(src, _mm256_maskload_epi64(reinterpret_cast<const long long*>(p), m), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(uint64_t* p, size_t k, reg x) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long*>(p), lane_mask(k), x); }
+    };
+    
+    template<> struct VecOps<float> {
+        using reg = __m256;
+        using mask = unsigned;
+        static constexpr size_t W = 8;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(float* p, reg x) noexcept { _mm256_storeu_ps(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(float v) noexcept { return _mm256_set1_ps(v); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, p, _CMP_NLT_UQ))); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, p, _CMP_NLE_UQ))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_permutevar8x32_ps(x, _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_32[m])));
+        }
+        // 补齐网络用 (NaN由调用方先剔除)。min_ps/max_ps对±0不构成置换，网络在保序整数键上跑
+        using key = VecOps<int32_t>;
+        static FYX_INLINE FYX_TARGET_AVX2 key::reg to_key(reg x) noexcept {
+            __m256i s = _mm256_castps_si256(x);
+            return _mm256_xor_si256(s, _mm256_srli_epi32(_mm256_srai_epi32(s, 31), 1));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg from_key(key::reg k) noexcept {
+            return _mm256_castsi256_ps(_mm256_xor_si256(k, _mm256_srli_epi32(_mm256_srai_epi32(k, 31), 1)));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(7,6,5,4,3,2,1,0)); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0^D, 1^D, 2^D, 3^D, 4^D, 5^D, 6^D, 7^D));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm256_blend_ps(lo, hi, static_cast<int>(lane_bit_mask<8, D>()));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(k)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const float* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_ps(src, _mm256_maskload_ps(p, _mm256_castps_si256(m)), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(float* p, size_t k, reg x) noexcept { _mm256_maskstore_ps(p, _mm256_castps_si256(lane_mask(k)), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 unsigned unordered(reg x) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(x, x, _CMP_UNORD_Q))); }
+    };
+    
+    template<> struct VecOps<double> {
+        using reg = __m256d;
+        using mask = unsigned;
+        static constexpr size_t W = 4;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+        static FYX_INLINE FYX_TARGET_AVX2 void store(double* p, reg x) noexcept { _mm256_storeu_pd(p, x); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(double v) noexcept { return _mm256_set1_pd(v); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask ge(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, p, _CMP_NLT_UQ))); }
+        static FYX_INLINE FYX_TARGET_AVX2 mask gt(reg x, reg p) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, p, _CMP_NLE_UQ))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg permute(reg x, mask m) noexcept {
+            return _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(x), _mm256_load_si256(reinterpret_cast<const __m256i*>(get_tables().part_perm_64[m]))));
+        }
+        // 补齐网络用 (NaN由调用方先剔除)，同float走保序整数键；AVX2没有64位算术右移，用比较取符号
+        using key = VecOps<int64_t>;
+        static FYX_INLINE FYX_TARGET_AVX2 key::reg to_key(reg x) noexcept {
+            __m256i s = _mm256_castpd_si256(x);
+            return _mm256_xor_si256(s, _mm256_srli_epi64(_mm256_cmpgt_epi64(_mm256_setzero_si256(), s), 1));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg from_key(key::reg k) noexcept {
+            return _mm256_castsi256_pd(_mm256_xor_si256(k, _mm256_srli_epi64(_mm256_cmpgt_epi64(_mm256_setzero_si256(), k), 1)));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg reverse(reg x) noexcept { return _mm256_permute4x64_pd(x, 0x1B); }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg xor_perm(reg x) noexcept {
+            return _mm256_permute4x64_pd(x, static_cast<int>((0^D) | (1^D) << 2 | (2^D) << 4 | (3^D) << 6));
+        }
+        template<size_t D> static FYX_INLINE FYX_TARGET_AVX2 reg blend_hi(reg lo, reg hi) noexcept {
+            return _mm256_blend_pd(lo, hi, static_cast<int>(lane_bit_mask<4, D>()));
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 reg lane_mask(size_t k) noexcept { return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(k)), _mm256_setr_epi64x(0, 1, 2, 3))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg mask_load(reg src, size_t k, const double* p) noexcept {
+            reg m = lane_mask(k);
+            return _mm256_blendv_pd(src, _mm256_maskload_pd(p, _mm256_castpd_si256(m)), m);
+        }
+        static FYX_INLINE FYX_TARGET_AVX2 void mask_store(double* p, size_t k, reg x) noexcept { _mm256_maskstore_pd(p, _mm256_castpd_si256(lane_mask(k)), x); }
+        static FYX_INLINE FYX_TARGET_AVX2 unsigned unordered(reg x) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(x, x, _CMP_UNORD_Q))); }
+    };
+    
+    // 8/16位通道只用于计数名次排序
+    template<> struct VecOps<int8_t> {
+        using reg = __m256i;
+        static constexpr size_t W = 32;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const int8_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(int8_t v) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(p, x))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, p))); }
+    };
+    
+    template<> struct VecOps<uint8_t> {
+        using reg = __m256i;
+        static constexpr size_t W = 32;
+        static FYX_INLINE FYX_TARGET_AVX2 reg flip(reg x) noexcept { return _mm256_xor_si256(x, _mm256_set1_epi8(static_cast<char>(0x80))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const uint8_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(uint8_t v) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(flip(p), flip(x)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, p))); }
+    };
+    
+    template<> struct VecOps<int16_t> {
+        using reg = __m256i;
+        static constexpr size_t W = 16;
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const int16_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(int16_t v) noexcept { return _mm256_set1_epi16(static_cast<short>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi16(p, x))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, p))); }
+    };
+    
+    template<> struct VecOps<uint16_t> {
+        using reg = __m256i;
+        static constexpr size_t W = 16;
+        static FYX_INLINE FYX_TARGET_AVX2 reg flip(reg x) noexcept { return _mm256_xor_si256(x, _mm256_set1_epi16(static_cast<short>(0x8000))); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg load(const uint16_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static FYX_INLINE FYX_TARGET_AVX2 reg set1(uint16_t v) noexcept { return _mm256_set1_epi16(static_cast<short>(v)); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t lt(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi16(flip(p), flip(x)))); }
+        static FYX_INLINE FYX_TARGET_AVX2 uint32_t eq(reg x, reg p) noexcept { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, p))); }
+    };
+    
+    // 计数名次排序 (同simd512::rank_sort_512)，尾部补零后用字节掩码剔除
+    template<typename T>
+    FYX_TARGET_AVX2 void rank_sort_256(T* a, size_t n) noexcept {
+        using L = traits::lane_t<T>;
+        using V = VecOps<L>;
+        constexpr size_t W = V::W;
+        constexpr size_t MAXV = (config::SIMD_RANK_SORT_LIMIT + W - 1) / W;
+        
+        alignas(32) L buf[MAXV * W] = {};
+        std::memcpy(buf, a, n * sizeof(T));
+        const size_t nv = (n + W - 1) / W;
+        const size_t tail_bytes = (n - (nv - 1) * W) * sizeof(T);
+        const uint32_t last_valid = tail_bytes == 32 ? ~uint32_t(0) : (uint32_t(1) << tail_bytes) - 1;
+        typename V::reg x[MAXV] = {};
+        for (size_t v = 0; v < nv; ++v) x[v] = V::load(buf + v * W);
+        
+        T out[config::SIMD_RANK_SORT_LIMIT];
+        for (size_t i = 0; i < n; ++i) {
+            const typename V::reg p = V::set1(buf[i]);
+            const size_t iv = i / W;
+            size_t r = 0;
+            for (size_t v = 0; v < nv; ++v) {
+                uint32_t lt = V::lt(x[v], p);
+                if (v + 1 == nv) lt &= last_valid;
+                r += static_cast<size_t>(__builtin_popcount(lt));
+                if (v <= iv) {
+                    uint32_t eq = V::eq(x[v], p);
+                    if (v == iv) eq &= (uint32_t(1) << ((i % W) * sizeof(T))) - 1;
+                    r += static_cast<size_t>(__builtin_popcount(eq));
+                }
+            }
+            out[r / sizeof(T)] = a[i];
+        }
+        std::memcpy(a, out, n * sizeof(T));
     }
     
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort6(T* a, Cmp& c) noexcept {
-        ops::cswap(a[1], a[2], c); ops::cswap(a[4], a[5], c);
-        ops::cswap(a[0], a[2], c); ops::cswap(a[3], a[5], c);
-        ops::cswap(a[0], a[1], c); ops::cswap(a[3], a[4], c);
-        ops::cswap(a[2], a[5], c); ops::cswap(a[0], a[3], c);
-        ops::cswap(a[1], a[4], c); ops::cswap(a[2], a[4], c);
-        ops::cswap(a[1], a[3], c); ops::cswap(a[2], a[3], c);
+    // 双调清洗: 对双调序列逐层做距离D的比较交换，得到升序
+    template<typename V, size_t D>
+    FYX_INLINE FYX_TARGET_AVX2 void bitonic_clean(typename V::reg& x) noexcept {
+        if constexpr (D > 0) {
+            typename V::reg t = V::template xor_perm<D>(x);
+            x = V::template blend_hi<D>(V::min(x, t), V::max(x, t));
+            bitonic_clean<V, D / 2>(x);
+        }
     }
     
-    template<typename T, typename Cmp>
-    FYX_INLINE void sort8(T* a, Cmp& c) noexcept {
-        ops::cswap(a[0], a[1], c); ops::cswap(a[2], a[3], c);
-        ops::cswap(a[4], a[5], c); ops::cswap(a[6], a[7], c);
-        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
-        ops::cswap(a[4], a[6], c); ops::cswap(a[5], a[7], c);
-        ops::cswap(a[1], a[2], c); ops::cswap(a[5], a[6], c);
-        ops::cswap(a[0], a[4], c); ops::cswap(a[1], a[5], c);
-        ops::cswap(a[2], a[6], c); ops::cswap(a[3], a[7], c);
-        ops::cswap(a[2], a[4], c); ops::cswap(a[3], a[5], c);
-        ops::cswap(a[1], a[2], c); ops::cswap(a[3], a[4], c);
-        ops::cswap(a[5], a[6], c);
+    // 两个升序向量归并: 结束后lo为较小的W个、hi为较大的W个，各自升序
+    template<typename V>
+    FYX_INLINE FYX_TARGET_AVX2 void merge_pair(typename V::reg& lo, typename V::reg& hi) noexcept {
+        typename V::reg r = V::reverse(hi);
+        typename V::reg l = V::min(lo, r);
+        typename V::reg h = V::max(lo, r);
+        bitonic_clean<V, V::W / 2>(l);
+        bitonic_clean<V, V::W / 2>(h);
+        lo = l;
+        hi = h;
+    }
+
+    // 寄存器内双调排序: 块长S从2倍增到W，每级先镜像比较 (i与i^(S-1)) 再清洗
+    template<typename V, size_t S = 2>
+    FYX_INLINE FYX_TARGET_AVX2 void sort_reg(typename V::reg& x) noexcept {
+        if constexpr (S <= V::W) {
+            typename V::reg t = V::template xor_perm<S - 1>(x);
+            x = V::template blend_hi<S / 2>(V::min(x, t), V::max(x, t));
+            bitonic_clean<V, S / 4>(x);
+            sort_reg<V, S * 2>(x);
+        }
     }
     
-    template<typename T, typename Cmp>
-    void small_sort(T* a, size_t n, Cmp& c) noexcept {
-        switch (n) {
-            case 0: case 1: return;
-            case 2: sort2(a, c); return;
-            case 3: sort3(a, c); return;
-            case 4: sort4(a, c); return;
-            case 5: sort5(a, c); return;
-            case 6: sort6(a, c); return;
-            case 7: case 8: sort8(a, c); return;
-            default:
-                if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, double> || 
-                              std::is_same_v<T, float>) {
-                    if constexpr (traits::is_default_less_v<T, Cmp>) {
-                        simd::sort_small_simd(a, n);
-                        if (n <= 128) return;
-                    }
+    // NV个寄存器 (2的幂) 整体排序: 各自排好后按块倍增归并，
+    // 块内镜像比较 + 寄存器间半清洗 + 寄存器内清洗
+    template<typename V, size_t NV>
+    FYX_INLINE FYX_TARGET_AVX2 void sort_regs(typename V::reg* x) noexcept {
+        for (size_t v = 0; v < NV; ++v) sort_reg<V>(x[v]);
+        for (size_t b = 2; b <= NV; b *= 2) {
+            for (size_t base = 0; base < NV; base += b) {
+                for (size_t j = 0; j < b / 2; ++j) {
+                    typename V::reg r = V::reverse(x[base + b - 1 - j]);
+                    typename V::reg h = V::max(x[base + j], r);
+                    x[base + j] = V::min(x[base + j], r);
+                    x[base + b - 1 - j] = V::reverse(h);
                 }
-                for (size_t i = 1; i < n; ++i) {
-                    T key = std::move(a[i]);
-                    size_t j = i;
-                    while (j > 0 && c(key, a[j-1])) {
-                        a[j] = std::move(a[j-1]);
-                        --j;
-                    }
-                    a[j] = std::move(key);
+            }
+            for (size_t d = b / 4; d > 0; d /= 2) {
+                for (size_t j = 0; j < NV; ++j) {
+                    if (j & d) continue;
+                    typename V::reg h = V::max(x[j], x[j + d]);
+                    x[j] = V::min(x[j], x[j + d]);
+                    x[j + d] = h;
                 }
+            }
+            for (size_t v = 0; v < NV; ++v) bitonic_clean<V, V::W / 2>(x[v]);
+        }
+    }
+    
+    // 任意长度 (≤ NV*W) 的补齐网络: 不足的通道和寄存器填类型最大值，
+    // 掩码载入/写回只碰前n个元素。浮点含NaN时返回false，交给标量路径；
+    // 其余浮点在保序整数键上排序，±0按位原样保留
+    template<size_t NV, typename L>
+    FYX_NOINLINE FYX_TARGET_AVX2 bool sort_padded_256(L* a, size_t n) noexcept {
+        using V = VecOps<L>;
+        constexpr size_t W = V::W;
+        const typename V::reg pad = V::set1(std::is_floating_point_v<L> ?
+            std::numeric_limits<L>::infinity() : std::numeric_limits<L>::max());
+        typename V::reg x[NV];
+        const size_t full = n / W, tail = n % W;
+        for (size_t v = 0; v < NV; ++v) {
+            if (v < full) x[v] = V::load(a + v * W);
+            else if (v == full && tail) x[v] = V::mask_load(pad, tail, a + v * W);
+            else x[v] = pad;
+        }
+        if constexpr (std::is_floating_point_v<L>) {
+            uint64_t nan = 0;
+            for (size_t v = 0; v < NV; ++v) nan |= static_cast<uint64_t>(V::unordered(x[v]));
+            if (nan) return false;
+            typename V::key::reg k[NV];
+            for (size_t v = 0; v < NV; ++v) k[v] = V::to_key(x[v]);
+            sort_regs<typename V::key, NV>(k);
+            for (size_t v = 0; v < NV; ++v) x[v] = V::from_key(k[v]);
+        } else {
+            sort_regs<V, NV>(x);
         }
+        for (size_t v = 0; v < full; ++v) V::store(a + v * W, x[v]);
+        if (tail) V::mask_store(a + full * W, tail, x[full]);
+        return true;
+    }
+    
+    // 按寄存器个数向上取2的幂选网络规模，n ≤ config::SIMD_NETWORK_LIMIT
+    template<typename L>
+    FYX_TARGET_AVX2 bool sort_network_256(L* a, size_t n) noexcept {
+        constexpr size_t W = VecOps<L>::W;
+        constexpr size_t MAXV = config::SIMD_NETWORK_LIMIT / W;
+        const size_t nv = (n + W - 1) / W;
+        if (nv <= 1) return sort_padded_256<1>(a, n);
+        if (nv <= 2) return sort_padded_256<2>(a, n);
+        if (nv <= 4) return sort_padded_256<4>(a, n);
+        if (nv <= 8) return sort_padded_256<8>(a, n);
+        if constexpr (MAXV >= 16) { if (nv <= 16) return sort_padded_256<16>(a, n); }
+        if constexpr (MAXV >= 32) { if (nv <= 32) return sort_padded_256<32>(a, n); }
+        if constexpr (MAXV >= 64) { if (nv <= 64) return sort_padded_256<64>(a, n); }
+        return false;
     }
 }
+#endif // FYX_AVX2_KERNELS
 
 // ═══════════════════════════════════════════════════════════════════════════
-// 第十六部分: 插入排序
+// 第三十六部分: SSE4.2 SIMD核心
 // ═══════════════════════════════════════════════════════════════════════════
 
-namespace insertion {
-    template<typename T, typename Cmp>
-    FYX_NOINLINE void sort(T* a, size_t n, Cmp& cmp) noexcept {
-        if (n <= 8) { 
-            sortnet::small_sort(a, n, cmp); 
-            return; 
+#ifdef FYX_SSE42_KERNELS
+namespace simd128 {
+    // 8~32位整数通道的min/max (SSE4.1补齐了SSE2缺的宽度)；64位通道没有，走标量
+    template<typename L> struct Lane;
+    template<> struct Lane<int8_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epi8(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epi8(a, b); }
+    };
+    template<> struct Lane<uint8_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epu8(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epu8(a, b); }
+    };
+    template<> struct Lane<int16_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epi16(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epi16(a, b); }
+    };
+    template<> struct Lane<uint16_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epu16(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epu16(a, b); }
+    };
+    template<> struct Lane<int32_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epi32(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epi32(a, b); }
+    };
+    template<> struct Lane<uint32_t> {
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i min(__m128i a, __m128i b) noexcept { return _mm_min_epu32(a, b); }
+        static FYX_INLINE FYX_TARGET_SSE42 __m128i max(__m128i a, __m128i b) noexcept { return _mm_max_epu32(a, b); }
+    };
+    
+    template<typename T>
+    inline constexpr bool has_lane_minmax_v =
+        std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 4;
+    
+    template<typename T>
+    FYX_INLINE FYX_TARGET_SSE42 __m128i load(const T* p) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    
+    template<typename T>
+    FYX_TARGET_SSE42 std::pair<T, T> find_minmax_128(const T* data, size_t n) noexcept {
+        if (n == 0) return {T{}, T{}};
+        size_t i = 0;
+        T mn = data[0], mx = data[0];
+        if constexpr (has_lane_minmax_v<T>) {
+            using L = traits::lane_t<T>;
+            using Op = Lane<L>;
+            constexpr size_t W = 16 / sizeof(T);
+            if (n >= 2 * W) {
+                __m128i vmin = load(data);
+                __m128i vmax = vmin;
+                for (i = W; i + 2 * W <= n; i += 2 * W) {
+                    FYX_PREFETCH_T0(data + i + 128);
+                    __m128i v0 = load(data + i);
+                    __m128i v1 = load(data + i + W);
+                    vmin = Op::min(vmin, Op::min(v0, v1));
+                    vmax = Op::max(vmax, Op::max(v0, v1));
+                }
+                for (; i + W <= n; i += W) {
+                    __m128i v = load(data + i);
+                    vmin = Op::min(vmin, v);
+                    vmax = Op::max(vmax, v);
+                }
+                alignas(16) L lo[W], hi[W];
+                _mm_store_si128(reinterpret_cast<__m128i*>(lo), vmin);
+                _mm_store_si128(reinterpret_cast<__m128i*>(hi), vmax);
+                for (size_t j = 0; j < W; ++j) {
+                    if (static_cast<T>(lo[j]) < mn) mn = static_cast<T>(lo[j]);
+                    if (static_cast<T>(hi[j]) > mx) mx = static_cast<T>(hi[j]);
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            if (data[i] < mn) mn = data[i];
+            if (data[i] > mx) mx = data[i];
+        }
+        return {mn, mx};
+    }
+    
+    // 键变换，同simd256::key_transform_256 (64位符号掩码用SSE4.2的pcmpgtq)
+    template<typename T, bool Inverse>
+    FYX_INLINE FYX_TARGET_SSE42 __m128i key_transform_128(__m128i v) noexcept {
+        if constexpr (std::is_same_v<T, float>) {
+            __m128i s = _mm_srai_epi32(v, 31);
+            if constexpr (Inverse) s = _mm_xor_si128(s, _mm_set1_epi32(-1));
+            return _mm_xor_si128(v, _mm_or_si128(s, _mm_set1_epi32(INT32_MIN)));
+        } else if constexpr (std::is_same_v<T, double>) {
+            __m128i s = _mm_cmpgt_epi64(_mm_setzero_si128(), v);
+            if constexpr (Inverse) s = _mm_xor_si128(s, _mm_set1_epi32(-1));
+            return _mm_xor_si128(v, _mm_or_si128(s, _mm_set1_epi64x(INT64_MIN)));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) return _mm_xor_si128(v, _mm_set1_epi8(INT8_MIN));
+            else if constexpr (sizeof(T) == 2) return _mm_xor_si128(v, _mm_set1_epi16(INT16_MIN));
+            else if constexpr (sizeof(T) == 4) return _mm_xor_si128(v, _mm_set1_epi32(INT32_MIN));
+            else return _mm_xor_si128(v, _mm_set1_epi64x(INT64_MIN));
+        } else {
+            return v;
         }
+    }
+    
+    template<typename T, bool Inverse>
+    FYX_NOINLINE FYX_TARGET_SSE42 void transform_keys_128(const keymap::xform_src_t<T, Inverse>* src,
+                                                           keymap::xform_dst_t<T, Inverse>* dst, size_t n) noexcept {
+        constexpr size_t W = 16 / sizeof(T);
+        size_t i = 0;
+        for (; i + W <= n; i += W) {
+            __m128i v = load(src + i);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), key_transform_128<T, Inverse>(v));
+        }
+        for (; i < n; ++i) keymap::transform_at<T, Inverse>(src + i, dst + i);
+    }
+    
+    // 直方图: 32/64位键在寄存器里完成映射、移位和取字节，再拆出下标分到4组计数表
+    template<typename T>
+    FYX_NOINLINE FYX_TARGET_SSE42 void histogram_128(const T* FYX_RESTRICT data, size_t n,
+                                                      size_t* FYX_RESTRICT counts, int shift) noexcept {
+        using M = keymap::Mapper<T>;
+        constexpr size_t MASK = 255;
+        alignas(64) size_t local_counts[4][256] = {};
         
-        size_t min_idx = 0;
-        for (size_t i = 1; i < n; ++i) {
-            if (cmp(a[i], a[min_idx])) min_idx = i;
+        size_t i = 0;
+        const __m128i sh = _mm_cvtsi32_si128(shift);
+        const __m128i mask = _mm_set1_epi32(static_cast<int>(MASK));
+        if constexpr (sizeof(T) == 4) {
+            for (; i + 4 <= n; i += 4) {
+                FYX_PREFETCH_T0(data + i + 64);
+                __m128i d = _mm_and_si128(_mm_srl_epi32(key_transform_128<T, false>(load(data + i)), sh), mask);
+                ++local_counts[0][_mm_cvtsi128_si32(d)];
+                ++local_counts[1][_mm_extract_epi32(d, 1)];
+                ++local_counts[2][_mm_extract_epi32(d, 2)];
+                ++local_counts[3][_mm_extract_epi32(d, 3)];
+            }
+        } else if constexpr (sizeof(T) == 8) {
+            for (; i + 4 <= n; i += 4) {
+                FYX_PREFETCH_T0(data + i + 32);
+                __m128i d0 = _mm_and_si128(_mm_srl_epi64(key_transform_128<T, false>(load(data + i)), sh), mask);
+                __m128i d1 = _mm_and_si128(_mm_srl_epi64(key_transform_128<T, false>(load(data + i + 2)), sh), mask);
+                ++local_counts[0][_mm_cvtsi128_si32(d0)];
+                ++local_counts[1][_mm_extract_epi32(d0, 2)];
+                ++local_counts[2][_mm_cvtsi128_si32(d1)];
+                ++local_counts[3][_mm_extract_epi32(d1, 2)];
+            }
+        }
+        for (; i + 4 <= n; i += 4) {
+            ++local_counts[0][(M::to_key(data[i + 0]) >> shift) & MASK];
+            ++local_counts[1][(M::to_key(data[i + 1]) >> shift) & MASK];
+            ++local_counts[2][(M::to_key(data[i + 2]) >> shift) & MASK];
+            ++local_counts[3][(M::to_key(data[i + 3]) >> shift) & MASK];
+        }
+        for (; i < n; ++i) {
+            ++local_counts[0][(M::to_key(data[i]) >> shift) & MASK];
         }
-        ops::swap(a[0], a[min_idx]);
         
-        for (size_t i = 2; i < n; ++i) {
-            T key = std::move(a[i]);
-            size_t j = i;
-            while (cmp(key, a[j-1])) { 
-                a[j] = std::move(a[j-1]); 
-                --j; 
+        for (size_t b = 0; b < 256; ++b) {
+            counts[b] = local_counts[0][b] + local_counts[1][b] + 
+                        local_counts[2][b] + local_counts[3][b];
+        }
+    }
+    
+    // 4个int32的排序网络: (0,1)(2,3) → (0,2)(1,3) → (1,2)
+    FYX_INLINE FYX_TARGET_SSE42 __m128i sort_4xi32(__m128i v) noexcept {
+        __m128i t = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xCC);
+        t = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xF0);
+        t = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+        return _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0x30);
+    }
+    
+    // 4元素双调序列清洗 (距离2/1两层)
+    FYX_INLINE FYX_TARGET_SSE42 __m128i bitonic_clean_4(__m128i v) noexcept {
+        __m128i t = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        v = _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xF0);
+        t = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_blend_epi16(_mm_min_epi32(v, t), _mm_max_epi32(v, t), 0xCC);
+    }
+    
+    FYX_INLINE FYX_TARGET_SSE42 __m128i reverse_4(__m128i v) noexcept {
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    
+    // 两个有序向量合并: 第二个反转后与第一个构成双调序列
+    FYX_INLINE FYX_TARGET_SSE42 void merge_4x2(__m128i& lo, __m128i& hi) noexcept {
+        __m128i r = reverse_4(hi);
+        __m128i l = _mm_min_epi32(lo, r);
+        __m128i h = _mm_max_epi32(lo, r);
+        lo = bitonic_clean_4(l);
+        hi = bitonic_clean_4(h);
+    }
+    
+    // 8元素 (两个寄存器) 双调序列清洗
+    FYX_INLINE FYX_TARGET_SSE42 void bitonic_clean_8(__m128i& v0, __m128i& v1) noexcept {
+        __m128i l = _mm_min_epi32(v0, v1);
+        __m128i h = _mm_max_epi32(v0, v1);
+        v0 = bitonic_clean_4(l);
+        v1 = bitonic_clean_4(h);
+    }
+    
+    FYX_INLINE FYX_TARGET_SSE42 void sort_8xi32(int32_t* a) noexcept {
+        __m128i v0 = sort_4xi32(load(a));
+        __m128i v1 = sort_4xi32(load(a + 4));
+        merge_4x2(v0, v1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a), v0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + 4), v1);
+    }
+    
+    FYX_INLINE FYX_TARGET_SSE42 void sort_16xi32(int32_t* a) noexcept {
+        __m128i v0 = sort_4xi32(load(a));
+        __m128i v1 = sort_4xi32(load(a + 4));
+        __m128i v2 = sort_4xi32(load(a + 8));
+        __m128i v3 = sort_4xi32(load(a + 12));
+        merge_4x2(v0, v1);
+        merge_4x2(v2, v3);
+        // 8+8合并: 后半整体反转 (交换寄存器并各自反转)
+        __m128i r0 = reverse_4(v3);
+        __m128i r1 = reverse_4(v2);
+        __m128i l0 = _mm_min_epi32(v0, r0), h0 = _mm_max_epi32(v0, r0);
+        __m128i l1 = _mm_min_epi32(v1, r1), h1 = _mm_max_epi32(v1, r1);
+        bitonic_clean_8(l0, l1);
+        bitonic_clean_8(h0, h1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a), l0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + 4), l1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + 8), h0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(a + 12), h1);
+    }
+    
+    // 相邻元素错开一位比较，next < prev的通道置位 (每通道sizeof(T)个字节位)；
+    // Rev时改找prev < next，即非增序列里的"上升"
+    template<typename T, bool Rev = false>
+    FYX_INLINE FYX_TARGET_SSE42 int descent_mask(const T* p) noexcept {
+        const T* lo = Rev ? p : p + 1;
+        const T* hi = Rev ? p + 1 : p;
+        if constexpr (std::is_same_v<T, float>) {
+            return _mm_movemask_epi8(_mm_castps_si128(_mm_cmplt_ps(_mm_loadu_ps(lo), _mm_loadu_ps(hi))));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return _mm_movemask_epi8(_mm_castpd_si128(_mm_cmplt_pd(_mm_loadu_pd(lo), _mm_loadu_pd(hi))));
+        } else {
+            __m128i x = load(lo), y = load(hi);
+            if constexpr (std::is_unsigned_v<T>) {
+                __m128i flip;
+                if constexpr (sizeof(T) == 1) flip = _mm_set1_epi8(INT8_MIN);
+                else if constexpr (sizeof(T) == 2) flip = _mm_set1_epi16(INT16_MIN);
+                else if constexpr (sizeof(T) == 4) flip = _mm_set1_epi32(INT32_MIN);
+                else flip = _mm_set1_epi64x(INT64_MIN);
+                x = _mm_xor_si128(x, flip);
+                y = _mm_xor_si128(y, flip);
             }
-            a[j] = std::move(key);
+            if constexpr (sizeof(T) == 1) return _mm_movemask_epi8(_mm_cmpgt_epi8(y, x));
+            else if constexpr (sizeof(T) == 2) return _mm_movemask_epi8(_mm_cmpgt_epi16(y, x));
+            else if constexpr (sizeof(T) == 4) return _mm_movemask_epi8(_mm_cmpgt_epi32(y, x));
+            else return _mm_movemask_epi8(_mm_cmpgt_epi64(y, x));
         }
     }
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第十七部分: 堆排序
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace heap {
-    template<typename T, typename Cmp>
-    FYX_NOINLINE void sort(T* a, size_t n, Cmp& cmp) noexcept {
-        if (n <= 1) return;
-        
-        auto sift = [&](size_t i, size_t len) {
-            while (true) {
-                size_t l = 2*i+1;
-                if (l >= len) break;
-                size_t r = l + 1;
-                size_t largest = i;
-                if (cmp(a[largest], a[l])) largest = l;
-                if (r < len && cmp(a[largest], a[r])) largest = r;
-                if (largest == i) break;
-                ops::swap(a[i], a[largest]); 
-                i = largest;
+    
+    // 4个向量的掩码拼成64位，一次判断/定位
+    template<typename T, bool Rev>
+    FYX_INLINE FYX_TARGET_SSE42 uint64_t descent_mask_x4(const T* p) noexcept {
+        constexpr size_t W = 16 / sizeof(T);
+        return static_cast<uint64_t>(static_cast<uint16_t>(descent_mask<T, Rev>(p))) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(descent_mask<T, Rev>(p + W))) << 16) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(descent_mask<T, Rev>(p + 2 * W))) << 32) |
+               (static_cast<uint64_t>(static_cast<uint16_t>(descent_mask<T, Rev>(p + 3 * W))) << 48);
+    }
+    
+    // 最长非降前缀的长度 (整体有序时返回n)；Rev时求最长非增前缀
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_SSE42 size_t sorted_prefix_128(const T* a, size_t n) noexcept {
+        size_t i = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 16 / sizeof(T);
+            for (; i + 4 * W < n; i += 4 * W) {
+                uint64_t m = descent_mask_x4<T, Rev>(a + i);
+                if (m) return i + static_cast<size_t>(__builtin_ctzll(m)) / sizeof(T) + 1;
             }
-        };
-        
-        for (size_t i = n/2; i > 0; --i) sift(i-1, n);
-        for (size_t i = n-1; i > 0; --i) { 
-            ops::swap(a[0], a[i]); 
-            sift(0, i); 
+            for (; i + W < n; i += W) {
+                int m = descent_mask<T, Rev>(a + i);
+                if (m) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(m))) / sizeof(T) + 1;
+            }
+        }
+        for (; i + 1 < n; ++i) {
+            if (Rev ? a[i] < a[i + 1] : a[i + 1] < a[i]) return i + 1;
+        }
+        return n;
+    }
+    
+    // 相邻下降 (Rev时为上升) 的个数；非降游程数 = 下降数 + 1
+    template<typename T, bool Rev = false>
+    FYX_NOINLINE FYX_TARGET_SSE42 size_t count_descents_128(const T* a, size_t n) noexcept {
+        size_t i = 0, bits = 0, cnt = 0;
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+            constexpr size_t W = 16 / sizeof(T);
+            for (; i + 4 * W < n; i += 4 * W) {
+                bits += static_cast<size_t>(__builtin_popcountll(descent_mask_x4<T, Rev>(a + i)));
+            }
+            cnt = bits / sizeof(T);
         }
+        for (; i + 1 < n; ++i) {
+            cnt += Rev ? (a[i] < a[i + 1]) : (a[i + 1] < a[i]);
+        }
+        return cnt;
     }
 }
+#endif // FYX_SSE42_KERNELS
 
 // ═══════════════════════════════════════════════════════════════════════════
-// 第十八部分: 计数排序 (修复版)
+// 第十四部分: 统一SIMD接口
 // ═══════════════════════════════════════════════════════════════════════════
 
-namespace counting {
+namespace simd {
+    // 标量实现: 无SIMD内核或CPU不支持时的后备
     template<typename T>
-    bool try_sort(T* a, size_t n) noexcept {
-        // 只对整数类型有效
-        if constexpr (!std::is_integral_v<T>) {
-            return false;
-        }
-        
-        if (n < config::COUNTING_MIN_SIZE) return false;
-        
-        using U = std::make_unsigned_t<T>;
-        
-        auto [true_min, true_max] = simd::find_minmax(a, n);
-        
-        // 修复：安全的范围计算
-        if (true_max < true_min) return false;
-        
-        // 使用更大的类型避免溢出
-        uint64_t range64;
-        if constexpr (std::is_signed_v<T>) {
-            // 对于有符号类型，转换为无符号后计算
-            // 确保不会因为符号位导致问题
-            U u_min = static_cast<U>(true_min);
-            U u_max = static_cast<U>(true_max);
-            
-            // 处理有符号到无符号的映射
-            // 对于有符号整数，最小值映射后反而更大
-            if (true_min < 0 && true_max >= 0) {
-                // 跨越零点
-                uint64_t neg_range = static_cast<uint64_t>(-static_cast<int64_t>(true_min));
-                uint64_t pos_range = static_cast<uint64_t>(true_max);
-                range64 = neg_range + pos_range;
-            } else if (true_max < 0) {
-                // 都是负数
-                range64 = static_cast<uint64_t>(true_max - true_min);
-            } else {
-                // 都是非负
-                range64 = static_cast<uint64_t>(true_max) - static_cast<uint64_t>(true_min);
-            }
-        } else {
-            // 无符号类型直接计算
-            range64 = static_cast<uint64_t>(true_max) - static_cast<uint64_t>(true_min);
+    std::pair<T, T> find_minmax_scalar(const T* data, size_t n) noexcept {
+        if (n == 0) return {T{}, T{}};
+        T mn = data[0], mx = data[0];
+        for (size_t i = 1; i < n; ++i) {
+            if (data[i] < mn) mn = data[i];
+            if (data[i] > mx) mx = data[i];
         }
-        
-        if (range64 > config::COUNTING_MAX_RANGE) return false;
-        if (range64 > static_cast<uint64_t>(n) * config::COUNTING_SORT_RATIO) return false;
-        
-        size_t range = static_cast<size_t>(range64) + 1;
-        size_t required_mem = range * sizeof(size_t);
-        if (required_mem > config::available_memory()) return false;
-        
-        mem::Buffer<size_t> count_buf(range);
-        if (!count_buf) return false;
-        
-        size_t* count = count_buf.data();
-        std::memset(count, 0, range * sizeof(size_t));
-        
-        // 计数
+        return {mn, mx};
+    }
+    
+    template<typename T>
+    void histogram_scalar(const T* data, size_t n, size_t* counts, int shift) noexcept {
+        using M = keymap::Mapper<T>;
         for (size_t i = 0; i < n; ++i) {
-            size_t idx;
-            if constexpr (std::is_signed_v<T>) {
-                // 有符号类型：将值映射到 [0, range)
-                idx = static_cast<size_t>(static_cast<int64_t>(a[i]) - static_cast<int64_t>(true_min));
-            } else {
-                idx = static_cast<size_t>(a[i] - true_min);
-            }
-            ++count[idx];
+            ++counts[(M::to_key(data[i]) >> shift) & 255];
         }
-        
-        // 重建数组
-        size_t pos = 0;
-        for (size_t i = 0; i < range; ++i) {
-            T val;
-            if constexpr (std::is_signed_v<T>) {
-                val = static_cast<T>(static_cast<int64_t>(true_min) + static_cast<int64_t>(i));
-            } else {
-                val = static_cast<T>(true_min + static_cast<U>(i));
-            }
-            size_t c = count[i];
-            while (c-- > 0) {
-                a[pos++] = val; 
-            }
+    }
+    
+    template<typename T>
+    void scatter_scalar(const T* src, T* dst, size_t n, size_t* offsets, int shift) noexcept {
+        using M = keymap::Mapper<T>;
+        for (size_t i = 0; i < n; ++i) {
+            T v = src[i];
+            size_t b = (M::to_key(v) >> shift) & 255;
+            dst[offsets[b]++] = v;
         }
-        
-        return true;
     }
-} // namespace counting
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第十九部分: 分层自适应基数排序 (修复版)
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace radix {
-    // L1缓存优化的小块排序
+    
     template<typename T>
-    FYX_NOINLINE void sort_l1_block(T* a, size_t n) {
-        using Map = keymap::Mapper<T>;
-        using Key = typename Map::Key;
-        
-        constexpr size_t NB = 256;
-        constexpr size_t KEY_BITS = sizeof(Key) * 8;
-        constexpr size_t NUM_PASSES = KEY_BITS / 8;
-        
-        // 使用栈上缓冲区避免堆分配
-        if (n > config::HIERARCHICAL_L1_THRESHOLD) {
-            std::less<T> cmp;
-            insertion::sort(a, n, cmp);
-            return;
+    bool sort_small_scalar(T*, size_t) noexcept { return false; }
+    
+    template<typename T, bool Inverse>
+    void transform_keys_scalar(const keymap::xform_src_t<T, Inverse>* src,
+                               keymap::xform_dst_t<T, Inverse>* dst, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) keymap::transform_at<T, Inverse>(src + i, dst + i);
+    }
+    
+    template<typename T, bool Rev = false>
+    size_t sorted_prefix_scalar(const T* a, size_t n) noexcept {
+        for (size_t i = 0; i + 1 < n; ++i) {
+            if (Rev ? a[i] < a[i + 1] : a[i + 1] < a[i]) return i + 1;
         }
-        
-        // 栈上分配小缓冲区
-        alignas(64) T buffer[8192]; // 足够L1友好的大小
-        if (n > 8192) {
-            lsd_sort(a, n);
-            return;
+        return n;
+    }
+    
+    template<typename T, bool Rev = false>
+    size_t count_descents_scalar(const T* a, size_t n) noexcept {
+        size_t cnt = 0;
+        for (size_t i = 0; i + 1 < n; ++i) {
+            cnt += Rev ? (a[i] < a[i + 1]) : (a[i + 1] < a[i]);
         }
-        
-        T* src = a;
-        T* dst = buffer;
-        
-        alignas(64) size_t count[NB + 1];
-        alignas(64) size_t offsets[NB];
-        
-        for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
-            int shift = static_cast<int>(pass * 8);
-            
-            std::memset(count, 0, sizeof(count));
-            
-            // 计数
-            for (size_t i = 0; i < n; ++i) {
-                ++count[(Map::to_key(src[i]) >> shift) & 0xFF];
-            }
-            
-            // 检查是否需要这一轮
-            size_t non_empty = 0;
-            for (size_t i = 0; i < NB; ++i) {
-                if (count[i] > 0) ++non_empty;
+        return cnt;
+    }
+    
+    // 8/16位键扩成int32 (两种符号的值都放得下) 后交给32位网络，窄通道不单独写置换
+    template<typename T, typename Net>
+    bool sort_widened(T* arr, size_t n, Net net) noexcept {
+        int32_t w[config::SIMD_NETWORK_LIMIT];
+        for (size_t i = 0; i < n; ++i) w[i] = static_cast<int32_t>(arr[i]);
+        if (!net(w, n)) return false;
+        for (size_t i = 0; i < n; ++i) arr[i] = static_cast<T>(w[i]);
+        return true;
+    }
+    
+#ifdef FYX_SSE42_KERNELS
+    template<typename T>
+    FYX_TARGET_SSE42 bool sort_small_128(T* arr, size_t n) noexcept {
+        if constexpr (std::is_same_v<traits::lane_t<T>, int32_t>) {
+            int32_t* a = reinterpret_cast<int32_t*>(arr);
+            if (n == 16) { simd128::sort_16xi32(a); return true; }
+            if (n == 8) { simd128::sort_8xi32(a); return true; }
+            if (n == 4) {
+                __m128i v = simd128::sort_4xi32(simd128::load(a));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(a), v);
+                return true;
             }
-            if (non_empty <= 1) continue;
-            
-            // 前缀和
-            size_t sum = 0;
-            for (size_t i = 0; i < NB; ++i) {
-                size_t c = count[i];
-                count[i] = sum;
-                sum += c;
+            // 没有掩码载入: 经栈缓冲补INT32_MAX到4/8/16
+            if (n > 1 && n < 16) {
+                alignas(16) int32_t buf[16];
+                size_t m = n <= 4 ? 4 : (n <= 8 ? 8 : 16);
+                std::memcpy(buf, a, n * sizeof(int32_t));
+                std::fill(buf + n, buf + m, INT32_MAX);
+                sort_small_128(buf, m);
+                std::memcpy(a, buf, n * sizeof(int32_t));
+                return true;
             }
-            std::memcpy(offsets, count, sizeof(offsets));
-            
-            // 分发
-            for (size_t i = 0; i < n; ++i) {
-                size_t b = (Map::to_key(src[i]) >> shift) & 0xFF;
-                dst[offsets[b]++] = src[i];
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) <= 2 && traits::has_simd_small_sort_v<T>) {
+            if (n > 1 && n <= 16) {
+                return sort_widened(arr, n, [](int32_t* w, size_t m) { return sort_small_128(w, m); });
             }
-            
-            T* tmp = src; src = dst; dst = tmp;
-        }
-        
-        if (src != a) {
-            std::memcpy(a, src, n * sizeof(T));
         }
+        (void)arr; (void)n;
+        return false;
     }
+#endif
     
-    // LSD基数排序 (优化版)
+#ifdef FYX_AVX2_KERNELS
     template<typename T>
-    FYX_NOINLINE void lsd_sort(T* a, size_t n) {
-        using Map = keymap::Mapper<T>;
-        using Key = typename Map::Key;
-        
-        constexpr size_t RADIX = 8;
-        constexpr size_t NUM_BUCKETS = 256;
-        constexpr size_t KEY_BITS = sizeof(Key) * 8;
-        constexpr size_t NUM_PASSES = (KEY_BITS + RADIX - 1) / RADIX;
-        
-        mem::Buffer<T> buffer(n);
-        if (!buffer) {
-            std::less<T> cmp;
-            heap::sort(a, n, cmp);
-            return;
+    FYX_TARGET_AVX2 bool sort_small_256(T* arr, size_t n) noexcept {
+        using L = traits::lane_t<T>;
+        if constexpr (std::is_same_v<L, int32_t>) {
+            int32_t* a = reinterpret_cast<int32_t*>(arr);
+            if (n == 32) { simd256::sort_32xi32(a); return true; }
+            if (n == 16) { simd256::sort_16xi32(a); return true; }
+            if (n == 8) {
+                __m256i v = simd256::sort_8xi32(_mm256_loadu_si256((__m256i*)a));
+                _mm256_storeu_si256((__m256i*)a, v);
+                return true;
+            }
         }
-        
-        T* src = a;
-        T* dst = buffer.data();
-        
-        alignas(64) size_t count[NUM_BUCKETS + 1];
-        alignas(64) size_t offsets[NUM_BUCKETS];
-        
-        for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
-            int shift = static_cast<int>(pass * RADIX);
-            
-            std::memset(count, 0, sizeof(count));
-            
-            simd::histogram(src, n, count, shift);
-            
-            // 检查是否需要这一轮
-            size_t non_empty = 0;
-            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
-                if (count[i] > 0) ++non_empty;
+        // 其余长度: 32/64位通道和浮点走补齐网络；8/16位短数组用计数名次排序，更长的扩成32位
+        if constexpr (traits::has_simd_small_sort_v<T> && sizeof(T) >= 4) {
+            if (n > 1 && n <= config::SIMD_NETWORK_LIMIT) {
+                return simd256::sort_network_256(reinterpret_cast<L*>(arr), n);
             }
-            if (non_empty <= 1) continue;
-            
-            size_t sum = 0;
-            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
-                size_t c = count[i]; 
-                count[i] = sum; 
-                sum += c;
+        } else if constexpr (traits::has_simd_small_sort_v<T>) {
+            if (n > 1 && n <= config::SIMD_RANK_SORT_LIMIT) {
+                simd256::rank_sort_256(arr, n);
+                return true;
+            }
+            if (n <= config::SIMD_NETWORK_LIMIT) {
+                return sort_widened(arr, n, [](int32_t* w, size_t m) { return simd256::sort_network_256(w, m); });
             }
-            
-            std::memcpy(offsets, count, sizeof(offsets));
-            
-            simd::scatter(src, dst, n, offsets, shift);
-            
-            T* tmp = src; src = dst; dst = tmp;
-        }
-        
-        if (src != a) {
-            std::memcpy(a, src, n * sizeof(T));
         }
+        (void)arr; (void)n;
+        return false;
     }
+#endif
     
-    // MSD递归基数排序
+#ifdef FYX_AVX512_KERNELS
     template<typename T>
-    void msd_recursive(T* a, size_t n, int shift, mem::Buffer<T>& buf) {
-        using Map = keymap::Mapper<T>;
-        
-        constexpr size_t NB = 256;
-        
-        if (n <= config::SMALL) {
-            std::less<T> cmp;
-            insertion::sort(a, n, cmp);
-            return;
+    FYX_TARGET_AVX512 bool sort_small_512(T* arr, size_t n) noexcept {
+        using L = traits::lane_t<T>;
+        if constexpr (std::is_same_v<L, int32_t>) {
+            int32_t* a = reinterpret_cast<int32_t*>(arr);
+            if (n == 128) { simd512::sort_128xi32(a); return true; }
+            if (n == 64) { simd512::sort_64xi32(a); return true; }
+            if (n == 32) { simd512::sort_32xi32(a); return true; }
+            if (n == 16) {
+                __m512i v = simd512::sort_16xi32(_mm512_loadu_si512(a));
+                _mm512_storeu_si512(a, v);
+                return true;
+            }
+            if (n == 8) {
+                __m256i v = simd256::sort_8xi32(_mm256_loadu_si256((__m256i*)a));
+                _mm256_storeu_si256((__m256i*)a, v);
+                return true;
+            }
         }
-        if (shift < 0) return;
-        
-        alignas(64) size_t count[NB + 1] = {};
-        
-        for (size_t i = 0; i < n; ++i) {
-            ++count[(Map::to_key(a[i]) >> shift) & 0xFF];
+        else if constexpr (std::is_same_v<L, uint32_t>) {
+            if (n == 16) {
+                __m512i v = simd512::sort_16xu32(_mm512_loadu_si512(arr));
+                _mm512_storeu_si512(arr, v);
+                return true;
+            }
         }
-        
-        size_t sum = 0;
-        for (size_t i = 0; i < NB; ++i) {
-            size_t c = count[i]; 
-            count[i] = sum; 
-            sum += c;
+        else if constexpr (std::is_same_v<L, int64_t>) {
+            if (n == 8) {
+                __m512i v = simd512::sort_8xi64(_mm512_loadu_si512(arr));
+                _mm512_storeu_si512(arr, v);
+                return true;
+            }
         }
-        count[NB] = sum;
-        
-        alignas(64) size_t off[NB];
-        std::memcpy(off, count, sizeof(off));
-        
-        for (size_t i = 0; i < n; ++i) {
-            size_t b = (Map::to_key(a[i]) >> shift) & 0xFF;
-            buf[off[b]++] = a[i];
+        else if constexpr (std::is_same_v<L, uint64_t>) {
+            if (n == 8) {
+                __m512i v = simd512::sort_8xu64(_mm512_loadu_si512(arr));
+                _mm512_storeu_si512(arr, v);
+                return true;
+            }
         }
-        std::memcpy(a, buf.data(), n * sizeof(T));
-        
-        if (shift >= 8) {
-            for (size_t b = 0; b < NB; ++b) {
-                size_t start = count[b];
-                size_t len = count[b+1] - start;
-                if (len > 1) {
-                    msd_recursive(a + start, len, shift - 8, buf);
-                }
+        // 浮点不走定长min/max网络 (±0不是置换、也不剔除NaN)，统一用下面的补齐网络
+        if constexpr (traits::has_simd_small_sort_v<T> && sizeof(T) >= 4) {
+            if (n > 1 && n <= config::SIMD_NETWORK_LIMIT) {
+                return simd512::sort_network_512(reinterpret_cast<L*>(arr), n);
+            }
+        } else if constexpr (traits::has_simd_small_sort_v<T>) {
+            if (n > 1 && n <= config::SIMD_RANK_SORT_LIMIT) {
+                simd512::rank_sort_512(arr, n);
+                return true;
+            }
+            if (n <= config::SIMD_NETWORK_LIMIT) {
+                return sort_widened(arr, n, [](int32_t* w, size_t m) { return simd512::sort_network_512(w, m); });
             }
         }
+        (void)arr; (void)n;
+        return false;
     }
+#endif
     
-    template<typename T>
-    void msd_sort(T* a, size_t n) {
-        using Key = typename keymap::Mapper<T>::Key;
-        mem::Buffer<T> buf(n);
-        if (!buf) {
-            std::less<T> cmp;
-            heap::sort(a, n, cmp);
-            return;
+    // 运行时选定的指令集级别
+    enum class Isa : uint8_t { Scalar, SSE42, AVX2, AVX512 };
+    
+    inline Isa detect_isa() noexcept {
+#if defined(FYX_AVX512_FULL)
+        return Isa::AVX512;
+#else
+        const auto& f = cpu::get_features();
+    #ifdef FYX_AVX512_KERNELS
+        if (f.avx512f && f.avx512dq && f.avx512bw && f.avx512vl &&
+            f.avx2 && f.bmi1 && f.bmi2 && f.popcnt) return Isa::AVX512;
+    #endif
+    #if defined(FYX_AVX2)
+        return Isa::AVX2;
+    #else
+        #ifdef FYX_AVX2_KERNELS
+        if (f.avx2 && f.bmi1 && f.bmi2 && f.popcnt) return Isa::AVX2;
+        #endif
+        #if defined(FYX_SSE42)
+        return Isa::SSE42;
+        #else
+            #ifdef FYX_SSE42_KERNELS
+        if (f.sse42 && f.popcnt) return Isa::SSE42;
+            #endif
+        (void)f;
+        return Isa::Scalar;
+        #endif
+    #endif
+#endif
+    }
+    
+    // 进程内只检测一次
+    inline Isa active_isa() noexcept {
+        static const Isa isa = detect_isa();
+        return isa;
+    }
+    
+    inline const char* isa_name(Isa isa) noexcept {
+        switch (isa) {
+            case Isa::AVX512: return "AVX-512";
+            case Isa::AVX2:   return "AVX2";
+            case Isa::SSE42:  return "SSE4.2";
+            default:          return "Scalar";
         }
-        int start_shift = static_cast<int>(sizeof(Key) * 8 - 8);
-        msd_recursive(a, n, start_shift, buf);
     }
     
-    // American Flag原地基数排序 (修复版 - 防止死循环)
+    // 每个元素类型一张内核分派表，首次使用时按active_isa()填充
     template<typename T>
-    FYX_NOINLINE void american_flag_sort(T* a, size_t n, int shift = -1) {
-        using Map = keymap::Mapper<T>;
-        using Key = typename Map::Key;
+    struct Kernels {
+        std::pair<T, T> (*find_minmax)(const T*, size_t) noexcept;
+        void (*histogram)(const T*, size_t, size_t*, int) noexcept;
+        void (*scatter)(const T*, T*, size_t, size_t*, int) noexcept;
+        bool (*sort_small)(T*, size_t) noexcept;
+        void (*to_keys)(const T*, typename keymap::Mapper<T>::Key*, size_t) noexcept;
+        void (*from_keys)(const typename keymap::Mapper<T>::Key*, T*, size_t) noexcept;
+        size_t (*sorted_prefix)(const T*, size_t) noexcept;
+        size_t (*reverse_prefix)(const T*, size_t) noexcept;
+        size_t (*count_descents)(const T*, size_t) noexcept;
+        size_t (*count_ascents)(const T*, size_t) noexcept;
+    };
+    
+    template<typename T>
+    Kernels<T> make_kernels(Isa isa) noexcept {
+        switch (isa) {
+#ifdef FYX_AVX512_KERNELS
+            case Isa::AVX512:
+                return {&simd512::find_minmax_512<T>, &simd512::histogram_512<T>,
+                        &simd512::scatter_512<T>, &sort_small_512<T>,
+                        &simd512::transform_keys_512<T, false>, &simd512::transform_keys_512<T, true>,
+                        &simd512::sorted_prefix_512<T, false>, &simd512::sorted_prefix_512<T, true>,
+                        &simd512::count_descents_512<T, false>, &simd512::count_descents_512<T, true>};
+#endif
+#ifdef FYX_AVX2_KERNELS
+            case Isa::AVX2:
+                return {&simd256::find_minmax_256<T>, &simd256::histogram_256<T>,
+                        &simd256::scatter_256<T>, &sort_small_256<T>,
+                        &simd256::transform_keys_256<T, false>, &simd256::transform_keys_256<T, true>,
+                        &simd256::sorted_prefix_256<T, false>, &simd256::sorted_prefix_256<T, true>,
+                        &simd256::count_descents_256<T, false>, &simd256::count_descents_256<T, true>};
+#endif
+#ifdef FYX_SSE42_KERNELS
+            case Isa::SSE42:
+                return {&simd128::find_minmax_128<T>, &simd128::histogram_128<T>,
+                        &scatter_scalar<T>, &sort_small_128<T>,
+                        &simd128::transform_keys_128<T, false>, &simd128::transform_keys_128<T, true>,
+                        &simd128::sorted_prefix_128<T, false>, &simd128::sorted_prefix_128<T, true>,
+                        &simd128::count_descents_128<T, false>, &simd128::count_descents_128<T, true>};
+#endif
+            default:
+                return {&find_minmax_scalar<T>, &histogram_scalar<T>,
+                        &scatter_scalar<T>, &sort_small_scalar<T>,
+                        &transform_keys_scalar<T, false>, &transform_keys_scalar<T, true>,
+                        &sorted_prefix_scalar<T, false>, &sorted_prefix_scalar<T, true>,
+                        &count_descents_scalar<T, false>, &count_descents_scalar<T, true>};
+        }
+    }
+    
+    template<typename T>
+    FYX_INLINE const Kernels<T>& kernels() noexcept {
+        static const Kernels<T> k = make_kernels<T>(active_isa());
+        return k;
+    }
+    
+    // 编译期已开启完整AVX-512时直接调用；否则经分派表间接调用
+    template<typename T>
+    FYX_INLINE std::pair<T, T> find_minmax(const T* data, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        return simd512::find_minmax_512(data, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        return kernels<T>().find_minmax(data, n);
+#elif defined(FYX_AVX2)
+        return simd256::find_minmax_256(data, n);
+#elif defined(FYX_SSE42)
+        return simd128::find_minmax_128(data, n);
+#else
+        return find_minmax_scalar(data, n);
+#endif
+    }
+    
+    template<typename T>
+    FYX_INLINE void histogram(const T* data, size_t n, size_t* counts, int shift) noexcept {
+#if defined(FYX_AVX512_FULL)
+        simd512::histogram_512(data, n, counts, shift);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        kernels<T>().histogram(data, n, counts, shift);
+#elif defined(FYX_AVX2)
+        simd256::histogram_256(data, n, counts, shift);
+#elif defined(FYX_SSE42)
+        simd128::histogram_128(data, n, counts, shift);
+#else
+        histogram_scalar(data, n, counts, shift);
+#endif
+    }
+    
+    template<typename T>
+    FYX_INLINE void scatter(const T* src, T* dst, size_t n, size_t* offsets, int shift) noexcept {
+#if defined(FYX_AVX512_FULL)
+        simd512::scatter_512(src, dst, n, offsets, shift);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        kernels<T>().scatter(src, dst, n, offsets, shift);
+#elif defined(FYX_AVX2)
+        simd256::scatter_256(src, dst, n, offsets, shift);
+#else
+        scatter_scalar(src, dst, n, offsets, shift);
+#endif
+    }
+    
+    // 最长非降前缀的长度；等于n即整体有序。从上一个断点继续调用即可逐个找出游程边界
+    template<typename T>
+    FYX_INLINE size_t sorted_prefix(const T* data, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        return simd512::sorted_prefix_512<T, false>(data, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        return kernels<T>().sorted_prefix(data, n);
+#elif defined(FYX_AVX2)
+        return simd256::sorted_prefix_256<T, false>(data, n);
+#elif defined(FYX_SSE42)
+        return simd128::sorted_prefix_128<T, false>(data, n);
+#else
+        return sorted_prefix_scalar<T, false>(data, n);
+#endif
+    }
+    
+    // 最长非增前缀的长度；等于n即整体逆序
+    template<typename T>
+    FYX_INLINE size_t reverse_prefix(const T* data, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        return simd512::sorted_prefix_512<T, true>(data, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        return kernels<T>().reverse_prefix(data, n);
+#elif defined(FYX_AVX2)
+        return simd256::sorted_prefix_256<T, true>(data, n);
+#elif defined(FYX_SSE42)
+        return simd128::sorted_prefix_128<T, true>(data, n);
+#else
+        return sorted_prefix_scalar<T, true>(data, n);
+#endif
+    }
+    
+    // 相邻下降 (a[i+1] < a[i]) 的个数
+    template<typename T>
+    FYX_INLINE size_t count_descents(const T* data, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        return simd512::count_descents_512<T, false>(data, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        return kernels<T>().count_descents(data, n);
+#elif defined(FYX_AVX2)
+        return simd256::count_descents_256<T, false>(data, n);
+#elif defined(FYX_SSE42)
+        return simd128::count_descents_128<T, false>(data, n);
+#else
+        return count_descents_scalar<T, false>(data, n);
+#endif
+    }
+    
+    // 相邻上升 (a[i] < a[i+1]) 的个数
+    template<typename T>
+    FYX_INLINE size_t count_ascents(const T* data, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        return simd512::count_descents_512<T, true>(data, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        return kernels<T>().count_ascents(data, n);
+#elif defined(FYX_AVX2)
+        return simd256::count_descents_256<T, true>(data, n);
+#elif defined(FYX_SSE42)
+        return simd128::count_descents_128<T, true>(data, n);
+#else
+        return count_descents_scalar<T, true>(data, n);
+#endif
+    }
+    
+    // 换成保序无符号键 / 换回原值 (整数可原地，浮点见keymap::transform_at)
+    template<typename T>
+    FYX_INLINE void to_keys(const T* src, typename keymap::Mapper<T>::Key* dst, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        simd512::transform_keys_512<T, false>(src, dst, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        kernels<T>().to_keys(src, dst, n);
+#elif defined(FYX_AVX2)
+        simd256::transform_keys_256<T, false>(src, dst, n);
+#elif defined(FYX_SSE42)
+        simd128::transform_keys_128<T, false>(src, dst, n);
+#else
+        transform_keys_scalar<T, false>(src, dst, n);
+#endif
+    }
+    
+    template<typename T>
+    FYX_INLINE void from_keys(const typename keymap::Mapper<T>::Key* src, T* dst, size_t n) noexcept {
+#if defined(FYX_AVX512_FULL)
+        simd512::transform_keys_512<T, true>(src, dst, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+        kernels<T>().from_keys(src, dst, n);
+#elif defined(FYX_AVX2)
+        simd256::transform_keys_256<T, true>(src, dst, n);
+#elif defined(FYX_SSE42)
+        simd128::transform_keys_128<T, true>(src, dst, n);
+#else
+        transform_keys_scalar<T, true>(src, dst, n);
+#endif
+    }
+    
+    // 返回true表示已由SIMD网络完成排序
+    template<typename T>
+    FYX_INLINE bool sort_small_simd(T* arr, size_t n) noexcept {
+        if constexpr (traits::has_simd_small_sort_v<T>) {
+#if defined(FYX_AVX512_FULL)
+            return sort_small_512(arr, n);
+#elif defined(FYX_RUNTIME_DISPATCH)
+            return kernels<T>().sort_small(arr, n);
+#elif defined(FYX_AVX2)
+            return sort_small_256(arr, n);
+#elif defined(FYX_SSE42)
+            return sort_small_128(arr, n);
+#endif
+        }
+        (void)arr; (void)n;
+        return false;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十五部分: 排序网络
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace sortnet {
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort2(T* a, Cmp& c) noexcept { 
+        ops::cswap(a[0], a[1], c); 
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort3(T* a, Cmp& c) noexcept {
+        ops::cswap(a[1], a[2], c); 
+        ops::cswap(a[0], a[2], c); 
+        ops::cswap(a[0], a[1], c);
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort4(T* a, Cmp& c) noexcept {
+        ops::cswap(a[0], a[1], c); ops::cswap(a[2], a[3], c);
+        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
+        ops::cswap(a[1], a[2], c);
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort5(T* a, Cmp& c) noexcept {
+        ops::cswap(a[0], a[1], c); ops::cswap(a[3], a[4], c);
+        ops::cswap(a[2], a[4], c); ops::cswap(a[2], a[3], c);
+        ops::cswap(a[1], a[4], c); ops::cswap(a[0], a[3], c);
+        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
+        ops::cswap(a[1], a[2], c);
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort6(T* a, Cmp& c) noexcept {
+        ops::cswap(a[1], a[2], c); ops::cswap(a[4], a[5], c);
+        ops::cswap(a[0], a[2], c); ops::cswap(a[3], a[5], c);
+        ops::cswap(a[0], a[1], c); ops::cswap(a[3], a[4], c);
+        ops::cswap(a[2], a[5], c); ops::cswap(a[0], a[3], c);
+        ops::cswap(a[1], a[4], c); ops::cswap(a[2], a[4], c);
+        ops::cswap(a[1], a[3], c); ops::cswap(a[2], a[3], c);
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort7(T* a, Cmp& c) noexcept {
+        ops::cswap(a[0], a[6], c); ops::cswap(a[2], a[3], c);
+        ops::cswap(a[4], a[5], c); ops::cswap(a[0], a[2], c);
+        ops::cswap(a[1], a[4], c); ops::cswap(a[3], a[6], c);
+        ops::cswap(a[0], a[1], c); ops::cswap(a[2], a[5], c);
+        ops::cswap(a[3], a[4], c); ops::cswap(a[1], a[2], c);
+        ops::cswap(a[4], a[6], c); ops::cswap(a[2], a[3], c);
+        ops::cswap(a[4], a[5], c); ops::cswap(a[1], a[2], c);
+        ops::cswap(a[3], a[4], c); ops::cswap(a[5], a[6], c);
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort8(T* a, Cmp& c) noexcept {
+        ops::cswap(a[0], a[1], c); ops::cswap(a[2], a[3], c);
+        ops::cswap(a[4], a[5], c); ops::cswap(a[6], a[7], c);
+        ops::cswap(a[0], a[2], c); ops::cswap(a[1], a[3], c);
+        ops::cswap(a[4], a[6], c); ops::cswap(a[5], a[7], c);
+        ops::cswap(a[1], a[2], c); ops::cswap(a[5], a[6], c);
+        ops::cswap(a[0], a[4], c); ops::cswap(a[1], a[5], c);
+        ops::cswap(a[2], a[6], c); ops::cswap(a[3], a[7], c);
+        ops::cswap(a[2], a[4], c); ops::cswap(a[3], a[5], c);
+        ops::cswap(a[1], a[2], c); ops::cswap(a[3], a[4], c);
+        ops::cswap(a[5], a[6], c);
+    }
+    
+    template<typename T, typename Cmp>
+    void small_sort(T* a, size_t n, Cmp& c) noexcept {
+        switch (n) {
+            case 0: case 1: return;
+            case 2: sort2(a, c); return;
+            case 3: sort3(a, c); return;
+            case 4: sort4(a, c); return;
+            case 5: sort5(a, c); return;
+            case 6: sort6(a, c); return;
+            case 7: sort7(a, c); return;
+            case 8: sort8(a, c); return;
+            default:
+                if constexpr (traits::has_simd_small_sort_v<T> && traits::is_default_less_v<T, Cmp>) {
+                    if (simd::sort_small_simd(a, n)) return;
+                }
+                for (size_t i = 1; i < n; ++i) {
+                    T key = std::move(a[i]);
+                    size_t j = i;
+                    while (j > 0 && c(key, a[j-1])) {
+                        a[j] = std::move(a[j-1]);
+                        --j;
+                    }
+                    a[j] = std::move(key);
+                }
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十六部分: 插入排序
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace insertion {
+    template<typename T, typename Cmp>
+    FYX_NOINLINE void sort(T* a, size_t n, Cmp& cmp) noexcept {
+        if (n <= 8) { 
+            sortnet::small_sort(a, n, cmp); 
+            return; 
+        }
+        // pdq/基数/分段排序的小区间都落到这里: 数值键优先用SIMD网络或计数名次排序
+        if constexpr (traits::has_simd_small_sort_v<T> && traits::is_default_less_v<T, Cmp>) {
+            if (n <= config::SIMD_NETWORK_LIMIT && simd::sort_small_simd(a, n)) return;
+        }
+        
+        size_t min_idx = 0;
+        for (size_t i = 1; i < n; ++i) {
+            if (cmp(a[i], a[min_idx])) min_idx = i;
+        }
+        ops::swap(a[0], a[min_idx]);
+        
+        for (size_t i = 2; i < n; ++i) {
+            T key = std::move(a[i]);
+            size_t j = i;
+            while (cmp(key, a[j-1])) { 
+                a[j] = std::move(a[j-1]); 
+                --j; 
+            }
+            a[j] = std::move(key);
+        }
+    }
+    
+    // 非最左区间: 调用方保证a[-1]不大于区间内任何元素，内层循环无需边界检查，也省去找最小值的一趟
+    template<typename T, typename Cmp>
+    FYX_NOINLINE void sort_unguarded(T* a, size_t n, Cmp& cmp) noexcept {
+        if (n <= 8) { 
+            sortnet::small_sort(a, n, cmp); 
+            return; 
+        }
+        if constexpr (traits::has_simd_small_sort_v<T> && traits::is_default_less_v<T, Cmp>) {
+            if (n <= config::SIMD_NETWORK_LIMIT && simd::sort_small_simd(a, n)) return;
+        }
+        
+        for (size_t i = 1; i < n; ++i) {
+            if (!cmp(a[i], a[i-1])) continue;
+            T key = std::move(a[i]);
+            T* p = a + i;
+            do { 
+                *p = std::move(p[-1]); 
+                --p; 
+            } while (cmp(key, p[-1]));
+            *p = std::move(key);
+        }
+    }
+    
+    // 限量插入排序: 累计搬移超过limit个元素即放弃并返回false (此时区间只排好了一部分)
+    template<typename T, typename Cmp>
+    bool partial_sort(T* a, size_t n, Cmp& cmp, size_t limit = 8) {
+        size_t moved = 0;
+        for (size_t i = 1; i < n; ++i) {
+            if (!cmp(a[i], a[i-1])) continue;
+            T key = std::move(a[i]);
+            T* p = a + i;
+            do { 
+                *p = std::move(p[-1]); 
+                --p; 
+            } while (p != a && cmp(key, p[-1]));
+            *p = std::move(key);
+            moved += static_cast<size_t>(a + i - p);
+            if (moved > limit) return false;
+        }
+        return true;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十七部分: 堆排序
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace heap {
+    template<typename T, typename Cmp>
+    FYX_NOINLINE void sort(T* a, size_t n, Cmp& cmp) noexcept {
+        if (n <= 1) return;
+        
+        auto sift = [&](size_t i, size_t len) {
+            while (true) {
+                size_t l = 2*i+1;
+                if (l >= len) break;
+                size_t r = l + 1;
+                size_t largest = i;
+                if (cmp(a[largest], a[l])) largest = l;
+                if (r < len && cmp(a[largest], a[r])) largest = r;
+                if (largest == i) break;
+                ops::swap(a[i], a[largest]); 
+                i = largest;
+            }
+        };
+        
+        for (size_t i = n/2; i > 0; --i) sift(i-1, n);
+        for (size_t i = n-1; i > 0; --i) { 
+            ops::swap(a[0], a[i]); 
+            sift(0, i); 
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十八部分: 计数排序 (修复版)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace counting {
+    // 值域规划: 求出最小值与值域大小，值域过大或内存不足时返回false
+    template<typename T>
+    bool plan(const T* a, size_t n, T& true_min, size_t& range) noexcept {
+        auto [lo, true_max] = simd::find_minmax(a, n);
+        true_min = lo;
+        
+        // 修复：安全的范围计算
+        if (true_max < true_min) return false;
+        
+        // 使用更大的类型避免溢出
+        uint64_t range64;
+        if constexpr (std::is_signed_v<T>) {
+            // 处理有符号到无符号的映射
+            // 对于有符号整数，最小值映射后反而更大
+            if (true_min < 0 && true_max >= 0) {
+                // 跨越零点
+                uint64_t neg_range = static_cast<uint64_t>(-static_cast<int64_t>(true_min));
+                uint64_t pos_range = static_cast<uint64_t>(true_max);
+                range64 = neg_range + pos_range;
+            } else if (true_max < 0) {
+                // 都是负数
+                range64 = static_cast<uint64_t>(true_max - true_min);
+            } else {
+                // 都是非负
+                range64 = static_cast<uint64_t>(true_max) - static_cast<uint64_t>(true_min);
+            }
+        } else {
+            // 无符号类型直接计算
+            range64 = static_cast<uint64_t>(true_max) - static_cast<uint64_t>(true_min);
+        }
+        
+        if (range64 > config::COUNTING_MAX_RANGE) return false;
+        if (range64 > static_cast<uint64_t>(n) * config::COUNTING_SORT_RATIO) return false;
+        
+        range = static_cast<size_t>(range64) + 1;
+        size_t required_mem = range * sizeof(size_t);
+        return required_mem <= config::available_memory();
+    }
+    
+    template<typename T>
+    FYX_INLINE size_t index_of(T v, T true_min) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            // 有符号类型：将值映射到 [0, range)
+            return static_cast<size_t>(static_cast<int64_t>(v) - static_cast<int64_t>(true_min));
+        } else {
+            return static_cast<size_t>(v - true_min);
+        }
+    }
+    
+    template<typename T>
+    FYX_INLINE T value_at(size_t i, T true_min) noexcept {
+        if constexpr (std::is_signed_v<T>) {
+            return static_cast<T>(static_cast<int64_t>(true_min) + static_cast<int64_t>(i));
+        } else {
+            return static_cast<T>(true_min + static_cast<std::make_unsigned_t<T>>(i));
+        }
+    }
+    
+    template<typename T>
+    bool try_sort(T* a, size_t n) noexcept {
+        // 只对整数类型有效
+        if constexpr (!std::is_integral_v<T>) {
+            (void)a; (void)n;
+            return false;
+        } else {
+            if (n < config::COUNTING_MIN_SIZE) return false;
+            
+            T true_min;
+            size_t range;
+            if (!plan(a, n, true_min, range)) return false;
+            
+            mem::Buffer<size_t> count_buf(range);
+            if (!count_buf) return false;
+            
+            size_t* count = count_buf.data();
+            std::memset(count, 0, range * sizeof(size_t));
+            
+            // 计数
+            for (size_t i = 0; i < n; ++i) {
+                ++count[index_of(a[i], true_min)];
+            }
+            
+            // 重建数组
+            size_t pos = 0;
+            for (size_t i = 0; i < range; ++i) {
+                T val = value_at(i, true_min);
+                size_t c = count[i];
+                while (c-- > 0) {
+                    a[pos++] = val; 
+                }
+            }
+            
+            return true;
+        }
+    }
+    
+    // 计数后直接从count[]输出去重值 (写回a的前m个位置)，freq非空时同时输出出现次数
+    template<typename T>
+    bool try_unique(T* a, size_t n, size_t* freq, size_t& m) noexcept {
+        if constexpr (!std::is_integral_v<T>) {
+            (void)a; (void)n; (void)freq; (void)m;
+            return false;
+        } else {
+            if (n < config::COUNTING_MIN_SIZE) return false;
+            
+            T true_min;
+            size_t range;
+            if (!plan(a, n, true_min, range)) return false;
+            
+            mem::Buffer<size_t> count_buf(range);
+            if (!count_buf) return false;
+            
+            size_t* count = count_buf.data();
+            std::memset(count, 0, range * sizeof(size_t));
+            
+            for (size_t i = 0; i < n; ++i) {
+                ++count[index_of(a[i], true_min)];
+            }
+            
+            m = 0;
+            for (size_t i = 0; i < range; ++i) {
+                if (count[i] == 0) continue;
+                a[m] = value_at(i, true_min);
+                if (freq) freq[m] = count[i];
+                ++m;
+            }
+            return true;
+        }
+    }
+} // namespace counting
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第十九部分: 分层自适应基数排序 (修复版)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace radix {
+    // L1缓存优化的小块排序
+    template<typename T>
+    FYX_NOINLINE void sort_l1_block(T* a, size_t n) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        
+        constexpr size_t NB = 256;
+        constexpr size_t KEY_BITS = sizeof(Key) * 8;
+        constexpr size_t NUM_PASSES = KEY_BITS / 8;
+        
+        // 使用栈上缓冲区避免堆分配
+        if (n > config::HIERARCHICAL_L1_THRESHOLD) {
+            std::less<T> cmp;
+            insertion::sort(a, n, cmp);
+            return;
+        }
+        
+        // 栈上分配小缓冲区
+        alignas(64) T buffer[8192]; // 足够L1友好的大小
+        if (n > 8192) {
+            lsd_sort(a, n);
+            return;
+        }
+        
+        T* src = a;
+        T* dst = buffer;
+        
+        alignas(64) size_t count[NB + 1];
+        alignas(64) size_t offsets[NB];
+        
+        for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
+            int shift = static_cast<int>(pass * 8);
+            
+            std::memset(count, 0, sizeof(count));
+            
+            // 计数
+            for (size_t i = 0; i < n; ++i) {
+                ++count[(Map::to_key(src[i]) >> shift) & 0xFF];
+            }
+            
+            // 检查是否需要这一轮
+            size_t non_empty = 0;
+            for (size_t i = 0; i < NB; ++i) {
+                if (count[i] > 0) ++non_empty;
+            }
+            if (non_empty <= 1) continue;
+            
+            // 前缀和
+            size_t sum = 0;
+            for (size_t i = 0; i < NB; ++i) {
+                size_t c = count[i];
+                count[i] = sum;
+                sum += c;
+            }
+            std::memcpy(offsets, count, sizeof(offsets));
+            
+            // 分发
+            for (size_t i = 0; i < n; ++i) {
+                size_t b = (Map::to_key(src[i]) >> shift) & 0xFF;
+                dst[offsets[b]++] = src[i];
+            }
+            
+            T* tmp = src; src = dst; dst = tmp;
+        }
+        
+        if (src != a) {
+            std::memcpy(a, src, n * sizeof(T));
+        }
+    }
+    
+    // LSD基数排序 (优化版)
+    template<typename T>
+    FYX_NOINLINE void lsd_sort(T* a, size_t n) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        
+        constexpr size_t RADIX = 8;
+        constexpr size_t NUM_BUCKETS = 256;
+        constexpr size_t KEY_BITS = sizeof(Key) * 8;
+        constexpr size_t NUM_PASSES = (KEY_BITS + RADIX - 1) / RADIX;
+        
+        mem::Buffer<T> buffer(n);
+        if (!buffer) {
+            std::less<T> cmp;
+            heap::sort(a, n, cmp);
+            return;
+        }
+        
+        T* src = a;
+        T* dst = buffer.data();
+        
+        alignas(64) size_t count[NUM_BUCKETS + 1];
+        alignas(64) size_t offsets[NUM_BUCKETS];
+        
+        for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
+            int shift = static_cast<int>(pass * RADIX);
+            
+            std::memset(count, 0, sizeof(count));
+            
+            simd::histogram(src, n, count, shift);
+            
+            // 检查是否需要这一轮
+            size_t non_empty = 0;
+            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+                if (count[i] > 0) ++non_empty;
+            }
+            if (non_empty <= 1) continue;
+            
+            size_t sum = 0;
+            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+                size_t c = count[i]; 
+                count[i] = sum; 
+                sum += c;
+            }
+            
+            std::memcpy(offsets, count, sizeof(offsets));
+            
+            simd::scatter(src, dst, n, offsets, shift);
+            
+            T* tmp = src; src = dst; dst = tmp;
+        }
+        
+        if (src != a) {
+            std::memcpy(a, src, n * sizeof(T));
+        }
+    }
+    
+    // LSD基数去重: 最后一个有效轮次在散布时顺带去重
+    // a[0..m)为升序唯一值；freq非空时(容量n)写入对应出现次数；缓冲分配失败返回false
+    template<typename T>
+    bool lsd_unique(T* a, size_t n, size_t* freq, size_t& m) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        
+        constexpr size_t NB = 256;
+        constexpr int NUM_PASSES = static_cast<int>(sizeof(Key));
+        
+        if (n == 0) { m = 0; return true; }
+        
+        mem::Buffer<T> buffer(n);
+        if (!buffer) return false;
+        
+        // 与首元素异或后取或: 为0的字节在所有键中都相同，对应轮次可跳过
+        Key k0 = Map::to_key(a[0]);
+        Key diff = 0;
+        for (size_t i = 0; i < n; ++i) diff |= Map::to_key(a[i]) ^ k0;
+        
+        int last = -1;
+        for (int p = 0; p < NUM_PASSES; ++p) {
+            if ((diff >> (p * 8)) & 0xFF) last = p;
+        }
+        if (last < 0) {
+            if (freq) freq[0] = n;
+            m = 1;
+            return true;
+        }
+        
+        T* src = a;
+        T* dst = buffer.data();
+        alignas(64) size_t begin[NB];
+        alignas(64) size_t offsets[NB];
+        
+        alignas(64) size_t count[NB];
+        
+        for (int p = 0; p <= last; ++p) {
+            if (((diff >> (p * 8)) & 0xFF) == 0) continue;
+            int shift = p * 8;
+            
+            std::memset(count, 0, sizeof(count));
+            simd::histogram(src, n, count, shift);
+            
+            size_t sum = 0;
+            for (size_t b = 0; b < NB; ++b) {
+                begin[b] = sum;
+                sum += count[b];
+            }
+            std::memcpy(offsets, begin, sizeof(offsets));
+            
+            if (p < last) {
+                simd::scatter(src, dst, n, offsets, shift);
+            } else {
+                // 桶内元素已按低位有序，相同键必然相邻: 与桶内上一个写入值比较即可
+                for (size_t i = 0; i < n; ++i) {
+                    Key k = Map::to_key(src[i]);
+                    size_t b = (k >> shift) & 0xFF;
+                    size_t pos = offsets[b];
+                    if (pos != begin[b] && Map::to_key(dst[pos - 1]) == k) {
+                        if (freq) ++freq[pos - 1];
+                    } else {
+                        dst[pos] = src[i];
+                        if (freq) freq[pos] = 1;
+                        offsets[b] = pos + 1;
+                    }
+                }
+            }
+            
+            T* tmp = src; src = dst; dst = tmp;
+        }
+        
+        // 压缩各桶之间的空洞 (src可能就是a，区间只会左移)
+        m = 0;
+        for (size_t b = 0; b < NB; ++b) {
+            size_t len = offsets[b] - begin[b];
+            if (len == 0) continue;
+            std::memmove(a + m, src + begin[b], len * sizeof(T));
+            if (freq) std::memmove(freq + m, freq + begin[b], len * sizeof(size_t));
+            m += len;
+        }
+        return true;
+    }
+    
+    // MSD递归基数排序
+    template<typename T>
+    void msd_recursive(T* a, size_t n, int shift, mem::Buffer<T>& buf) {
+        using Map = keymap::Mapper<T>;
+        
+        constexpr size_t NB = 256;
+        
+        if (n <= config::SMALL) {
+            std::less<T> cmp;
+            insertion::sort(a, n, cmp);
+            return;
+        }
+        if (shift < 0) return;
+        
+        alignas(64) size_t count[NB + 1] = {};
+        
+        for (size_t i = 0; i < n; ++i) {
+            ++count[(Map::to_key(a[i]) >> shift) & 0xFF];
+        }
+        
+        size_t sum = 0;
+        for (size_t i = 0; i < NB; ++i) {
+            size_t c = count[i]; 
+            count[i] = sum; 
+            sum += c;
+        }
+        count[NB] = sum;
+        
+        alignas(64) size_t off[NB];
+        std::memcpy(off, count, sizeof(off));
+        
+        for (size_t i = 0; i < n; ++i) {
+            size_t b = (Map::to_key(a[i]) >> shift) & 0xFF;
+            buf[off[b]++] = a[i];
+        }
+        std::memcpy(a, buf.data(), n * sizeof(T));
+        
+        if (shift >= 8) {
+            for (size_t b = 0; b < NB; ++b) {
+                size_t start = count[b];
+                size_t len = count[b+1] - start;
+                if (len > 1) {
+                    msd_recursive(a + start, len, shift - 8, buf);
+                }
+            }
+        }
+    }
+    
+    template<typename T>
+    void msd_sort(T* a, size_t n) {
+        using Key = typename keymap::Mapper<T>::Key;
+        mem::Buffer<T> buf(n);
+        if (!buf) {
+            std::less<T> cmp;
+            heap::sort(a, n, cmp);
+            return;
+        }
+        int start_shift = static_cast<int>(sizeof(Key) * 8 - 8);
+        msd_recursive(a, n, start_shift, buf);
+    }
+    
+    // American Flag原地基数排序 (修复版 - 防止死循环)
+    template<typename T>
+    FYX_NOINLINE void american_flag_sort(T* a, size_t n, int shift = -1) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        
+        if (shift < 0) {
+            shift = static_cast<int>(sizeof(Key) * 8 - 8);
+        }
+        
+        if (n <= config::SMALL || shift < 0) {
+            std::less<T> cmp;
+            insertion::sort(a, n, cmp);
+            return;
+        }
+        
+        constexpr size_t NB = 256;
+        alignas(64) size_t count[NB] = {};
+        alignas(64) size_t offset[NB + 1];
+        
+        // 计数
+        for (size_t i = 0; i < n; ++i) {
+            ++count[(Map::to_key(a[i]) >> shift) & 0xFF];
+        }
+        
+        // 计算偏移
+        offset[0] = 0;
+        for (size_t i = 0; i < NB; ++i) {
+            offset[i + 1] = offset[i] + count[i];
+        }
+        
+        // 原地分区 (修复版)
+        alignas(64) size_t current[NB];
+        std::memcpy(current, offset, sizeof(current));
+        
+        for (size_t b = 0; b < NB; ++b) {
+            size_t end = offset[b + 1];
+            while (current[b] < end) {
+                size_t bucket = (Map::to_key(a[current[b]]) >> shift) & 0xFF;
+                if (bucket == b) {
+                    ++current[b];
+                } else {
+                    // 循环交换直到当前位置放入正确元素
+                    while (bucket != b) {
+                        size_t target = current[bucket]++;
+                        ops::swap(a[current[b]], a[target]);
+                        bucket = (Map::to_key(a[current[b]]) >> shift) & 0xFF;
+                    }
+                    ++current[b];
+                }
+            }
+        }
+        
+        // 递归处理各桶
+        if (shift >= 8) {
+            for (size_t b = 0; b < NB; ++b) {
+                if (count[b] > 1) {
+                    american_flag_sort(a + offset[b], count[b], shift - 8);
+                }
+            }
+        }
+    }
+    
+    // 分层自适应基数排序入口
+    template<typename T>
+    void hierarchical_sort(T* a, size_t n) {
+        // 几百个元素以内补齐的双调网络比任何一轮计数都快
+        if (n <= config::SIMD_NETWORK_LIMIT && simd::sort_small_simd(a, n)) return;
+        if (n <= config::SMALL) {
+            std::less<T> cmp;
+            insertion::sort(a, n, cmp);
+            return;
+        }
+        
+        // 尝试计数排序
+        if (counting::try_sort(a, n)) return;
+        
+        // 根据数据大小选择最优算法
+        if (n <= config::HIERARCHICAL_L1_THRESHOLD) {
+            sort_l1_block(a, n);
+        } else if (n <= config::HIERARCHICAL_L2_THRESHOLD) {
+            lsd_sort(a, n);
+        } else if (n <= config::HIERARCHICAL_L3_THRESHOLD) {
+            lsd_sort(a, n);
+        } else {
+            msd_sort(a, n);
+        }
+    }
+    
+    // 主入口
+    template<typename T>
+    void sort(T* a, size_t n) {
+        hierarchical_sort(a, n);
+    }
+} // namespace radix
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十部分: 无锁工作窃取队列 (修复版 - 增强线程安全)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#if FYX_ENABLE_PARALLEL
+namespace parallel {
+    
+    struct WorkItem {
+        void* data = nullptr;
+        size_t start = 0;
+        size_t length = 0;
+        int depth = 0;
+        
+        bool valid() const { return data != nullptr && length > 0; }
+    };
+    
+    // Chase-Lev无锁工作窃取双端队列 (修复版)
+    class LockFreeWorkStealQueue {
+        static constexpr size_t INITIAL_CAPACITY = 1024;
+        static constexpr size_t MAX_CAPACITY = 1 << 20;
+        
+        struct CircularArray {
+            std::vector<std::atomic<WorkItem>> items;
+            size_t mask;
+            
+            explicit CircularArray(size_t cap) : items(cap), mask(cap - 1) {}
+            
+            size_t capacity() const { return mask + 1; }
+            
+            WorkItem get(size_t i) const {
+                return items[i & mask].load(std::memory_order_relaxed);
+            }
+            
+            void put(size_t i, WorkItem item) {
+                items[i & mask].store(item, std::memory_order_relaxed);
+            }
+        };
+        
+        alignas(config::CACHE_LINE) std::atomic<size_t> bottom{0};
+        alignas(config::CACHE_LINE) std::atomic<size_t> top{0};
+        alignas(config::CACHE_LINE) std::atomic<CircularArray*> array;
+        
+        // 修复：使用shared_ptr自动管理旧数组
+        std::vector<std::shared_ptr<CircularArray>> garbage;
+        mutable std::mutex garbage_mutex;
+        
+        CircularArray* grow(CircularArray* old_arr, size_t b, size_t t) {
+            size_t new_cap = old_arr->capacity() * 2;
+            if (new_cap > MAX_CAPACITY) new_cap = MAX_CAPACITY;
+            
+            auto new_arr = new CircularArray(new_cap);
+            for (size_t i = t; i < b; ++i) {
+                new_arr->put(i, old_arr->get(i));
+            }
+            return new_arr;
+        }
+        
+    public:
+        LockFreeWorkStealQueue() {
+            array.store(new CircularArray(INITIAL_CAPACITY), std::memory_order_relaxed);
+        }
+        
+        ~LockFreeWorkStealQueue() {
+            std::lock_guard<std::mutex> lock(garbage_mutex);
+            delete array.load(std::memory_order_relaxed);
+            // shared_ptr自动释放garbage中的数组
+        }
+        
+        LockFreeWorkStealQueue(const LockFreeWorkStealQueue&) = delete;
+        LockFreeWorkStealQueue& operator=(const LockFreeWorkStealQueue&) = delete;
+        
+        // 所有者推入
+        void push(WorkItem item) {
+            size_t b = bottom.load(std::memory_order_relaxed);
+            size_t t = top.load(std::memory_order_acquire);
+            CircularArray* arr = array.load(std::memory_order_relaxed);
+            
+            if (b - t >= arr->capacity() - 1) {
+                CircularArray* new_arr = grow(arr, b, t);
+                {
+                    std::lock_guard<std::mutex> lock(garbage_mutex);
+                    garbage.push_back(std::shared_ptr<CircularArray>(arr));
+                }
+                array.store(new_arr, std::memory_order_release);
+                arr = new_arr;
+            }
+            
+            arr->put(b, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        
+        // 所有者弹出
+        bool pop(WorkItem& item) {
+            size_t b = bottom.load(std::memory_order_relaxed);
+            if (b == 0) return false;
+            
+            b = b - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            
+            size_t t = top.load(std::memory_order_relaxed);
+            
+            if (t <= b) {
+                CircularArray* arr = array.load(std::memory_order_relaxed);
+                item = arr->get(b);
+                
+                if (t == b) {
+                    if (!top.compare_exchange_strong(t, t + 1, 
+                            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        bottom.store(b + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return true;
+            } else {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        
+        // 窃取
+        bool steal(WorkItem& item) {
+            size_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            size_t b = bottom.load(std::memory_order_acquire);
+            
+            if (t >= b) return false;
+            
+            CircularArray* arr = array.load(std::memory_order_consume);
+            item = arr->get(t);
+            
+            if (!top.compare_exchange_strong(t, t + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return false;
+            }
+            
+            return true;
+        }
+        
+        bool empty() const {
+            size_t t = top.load(std::memory_order_relaxed);
+            size_t b = bottom.load(std::memory_order_relaxed);
+            return t >= b;
+        }
+        
+        size_t size() const {
+            size_t t = top.load(std::memory_order_relaxed);
+            size_t b = bottom.load(std::memory_order_relaxed);
+            return (b > t) ? (b - t) : 0;
+        }
+    };
+    
+    // 并行基数排序
+    template<typename T>
+    void parallel_radix(T* a, size_t n, const Options& opts) {
+        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+        if (n < opts.parallel_threshold * 2 || nt <= 1) {
+            radix::sort(a, n);
+            return;
+        }
+        
+        nt = std::min(nt, config::MAX_BUCKETS);
+        
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        constexpr size_t NB = 256;
+        constexpr int SHIFT = sizeof(Key) * 8 - 8;
+        
+        // 第一阶段：并行计数
+        std::vector<mem::AlignedArray<size_t, NB>> local_counts(nt);
+        size_t chunk = (n + nt - 1) / nt;
+        std::vector<std::thread> threads;
+        threads.reserve(nt);
+        
+        for (size_t t = 0; t < nt; ++t) {
+            size_t lo = t * chunk;
+            size_t hi = std::min(lo + chunk, n);
+            threads.emplace_back([&, t, lo, hi]() {
+                local_counts[t].zero();
+                for (size_t i = lo; i < hi; ++i) {
+                    ++local_counts[t][(Map::to_key(a[i]) >> SHIFT) & 0xFF];
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        threads.clear();
+        
+        // 合并计数
+        alignas(64) size_t counts[NB + 1] = {};
+        for (size_t b = 0; b < NB; ++b) {
+            for (size_t t = 0; t < nt; ++t) {
+                counts[b] += local_counts[t][b];
+            }
+        }
+        
+        size_t sum = 0;
+        for (size_t b = 0; b < NB; ++b) {
+            size_t c = counts[b]; 
+            counts[b] = sum; 
+            sum += c;
+        }
+        counts[NB] = sum;
+        
+        // 分配缓冲区
+        mem::Buffer<T> buf(n);
+        if (!buf) { 
+            radix::sort(a, n); 
+            return; 
+        }
+        
+        // 计算每个线程的偏移
+        std::vector<mem::AlignedArray<size_t, NB>> offsets(nt);
+        for (size_t b = 0; b < NB; ++b) {
+            size_t off = counts[b];
+            for (size_t t = 0; t < nt; ++t) {
+                offsets[t][b] = off;
+                off += local_counts[t][b];
+            }
+        }
+        
+        // 第二阶段：并行分发
+        for (size_t t = 0; t < nt; ++t) {
+            size_t lo = t * chunk;
+            size_t hi = std::min(lo + chunk, n);
+            threads.emplace_back([&, t, lo, hi]() {
+                for (size_t i = lo; i < hi; ++i) {
+                    size_t b = (Map::to_key(a[i]) >> SHIFT) & 0xFF;
+                    buf[offsets[t][b]++] = a[i];
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        threads.clear();
+        
+        // 第三阶段：工作窃取并行递归排序
+        std::vector<LockFreeWorkStealQueue> queues(nt);
+        std::atomic<bool> done{false};
+        std::atomic<size_t> active_workers{0};
+        
+        // 初始化工作项
+        size_t total_work = 0;
+        for (size_t b = 0; b < NB; ++b) {
+            size_t start = counts[b];
+            size_t len = counts[b+1] - start;
+            if (len > 1) {
+                WorkItem item;
+                item.data = buf.data();
+                item.start = start;
+                item.length = len;
+                item.depth = 0;
+                queues[b % nt].push(item);
+                ++total_work;
+            }
+        }
+        
+        if (total_work == 0) {
+            std::memcpy(a, buf.data(), n * sizeof(T));
+            return;
+        }
+        
+        // 工作线程
+        auto worker = [&](size_t tid) {
+            active_workers.fetch_add(1, std::memory_order_relaxed);
+            WorkItem item;
+            size_t steal_attempts = 0;
+            
+            while (!done.load(std::memory_order_relaxed)) {
+                // 先尝试从自己的队列弹出
+                if (queues[tid].pop(item)) {
+                    steal_attempts = 0;
+                    T* data = static_cast<T*>(item.data);
+                    
+                    if (item.length > config::WORK_STEAL_THRESHOLD && item.depth < 3) {
+                        size_t mid = item.length / 2;
+                        WorkItem right;
+                        right.data = data;
+                        right.start = item.start + mid;
+                        right.length = item.length - mid;
+                        right.depth = item.depth + 1;
+                        queues[tid].push(right);
+                        radix::sort(data + item.start, mid);
+                    } else {
+                        radix::sort(data + item.start, item.length);
+                    }
+                    continue;
+                }
+                
+                // 尝试从其他线程窃取
+                bool stolen = false;
+                for (size_t i = 1; i <= nt && !stolen; ++i) {
+                    size_t victim = (tid + i) % nt;
+                    if (queues[victim].steal(item)) {
+                        stolen = true;
+                        steal_attempts = 0;
+                        T* data = static_cast<T*>(item.data);
+                        radix::sort(data + item.start, item.length);
+                    }
+                }
+                
+                if (!stolen) {
+                    ++steal_attempts;
+                    if (steal_attempts > config::MAX_STEAL_ATTEMPTS) {
+                        bool all_empty = true;
+                        for (size_t i = 0; i < nt; ++i) {
+                            if (!queues[i].empty()) {
+                                all_empty = false;
+                                break;
+                            }
+                        }
+                        if (all_empty) {
+                            break;
+                        }
+                        steal_attempts = 0;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+            
+            if (active_workers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                done.store(true, std::memory_order_release);
+            }
+        };
+        
+        for (size_t t = 0; t < nt; ++t) {
+            threads.emplace_back(worker, t);
+        }
+        for (auto& th : threads) th.join();
+        
+        std::memcpy(a, buf.data(), n * sizeof(T));
+    }
+    
+    // 并行超采样排序
+    template<typename T, typename Cmp>
+    void parallel_supersample(T* a, size_t n, Cmp cmp, const Options& opts);
+    
+} // namespace parallel
+#endif // FYX_ENABLE_PARALLEL
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十一部分: 数据分布学习与自适应选择 (修复版)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace adaptive {
+    struct DataProfile {
+        bool is_sorted = false;
+        bool is_reverse = false;
+        bool is_nearly_sorted = false;
+        bool has_many_duplicates = false;
+        bool is_small_range = false;
+        double entropy = 0.0;
+        size_t unique_estimate = 0;
+        size_t run_count = 0;
+    };
+    
+    // 默认less/greater下的数值类型可按内存带宽做整段扫描
+    template<typename T, typename Cmp>
+    inline constexpr bool can_scan_simd_v = traits::has_simd_small_sort_v<T> &&
+        (traits::is_default_less_v<T, Cmp> || traits::is_default_greater_v<T, Cmp>);
+    
+    // 按cmp的最长有序前缀 (不存在i使cmp(a[i+1], a[i]))
+    template<typename T, typename Cmp>
+    size_t sorted_prefix(const T* a, size_t n, Cmp& cmp) {
+        if constexpr (can_scan_simd_v<T, Cmp>) {
+            if constexpr (traits::is_default_less_v<T, Cmp>) return simd::sorted_prefix(a, n);
+            else return simd::reverse_prefix(a, n);
+        } else {
+            for (size_t i = 1; i < n; ++i) {
+                if (cmp(a[i], a[i - 1])) return i;
+            }
+            return n;
+        }
+    }
+    
+    // 按cmp的最长逆序前缀 (不存在i使cmp(a[i], a[i+1]))
+    template<typename T, typename Cmp>
+    size_t reverse_prefix(const T* a, size_t n, Cmp& cmp) {
+        if constexpr (can_scan_simd_v<T, Cmp>) {
+            if constexpr (traits::is_default_less_v<T, Cmp>) return simd::reverse_prefix(a, n);
+            else return simd::sorted_prefix(a, n);
+        } else {
+            for (size_t i = 1; i < n; ++i) {
+                if (cmp(a[i - 1], a[i])) return i;
+            }
+            return n;
+        }
+    }
+    
+    // 精确游程数: Rev为false时数有序游程 (断点数+1)，否则数逆序游程
+    template<bool Rev, typename T, typename Cmp>
+    size_t count_runs(const T* a, size_t n, Cmp& cmp) {
+        if (n == 0) return 0;
+        if constexpr (can_scan_simd_v<T, Cmp>) {
+            constexpr bool Asc = Rev == traits::is_default_less_v<T, Cmp>;
+            return 1 + (Asc ? simd::count_ascents(a, n) : simd::count_descents(a, n));
+        } else {
+            size_t runs = 1;
+            for (size_t i = 1; i < n; ++i) {
+                runs += Rev ? cmp(a[i - 1], a[i]) : cmp(a[i], a[i - 1]);
+            }
+            return runs;
+        }
+    }
+    
+    template<typename T, typename Cmp>
+    DataProfile analyze(const T* a, size_t n, Cmp& cmp) {
+        DataProfile profile;
+        if (n <= 1) {
+            profile.is_sorted = true;
+            return profile;
+        }
+        
+        // 采样分析
+        size_t sample_size = std::min(n - 1, size_t(256));
+        size_t step = (n > sample_size) ? ((n - 1) / sample_size) : 1;
+        if (step == 0) step = 1;  // 修复：防止除零
+        
+        size_t asc = 0, desc = 0, eq = 0;
+        size_t runs = 1;
+        bool last_asc = true;
+        
+        alignas(64) size_t bucket_counts[16] = {};
+        
+        size_t actual_samples = 0;
+        for (size_t i = 0; i < sample_size && i * step + 1 < n; ++i) {
+            size_t idx = i * step;
+            ++actual_samples;
+            
+            if (cmp(a[idx + 1], a[idx])) {
+                ++desc;
+                if (last_asc) { ++runs; last_asc = false; }
+            } else if (cmp(a[idx], a[idx + 1])) {
+                ++asc;
+                if (!last_asc) { ++runs; last_asc = true; }
+            } else {
+                ++eq;
+            }
+            
+            if constexpr (std::is_integral_v<T>) {
+                size_t hash_val;
+                if constexpr (sizeof(T) <= sizeof(size_t)) {
+                    hash_val = static_cast<size_t>(a[idx]) * 2654435761ULL;
+                } else {
+                    hash_val = static_cast<size_t>(a[idx] >> 32) ^ static_cast<size_t>(a[idx]);
+                }
+                ++bucket_counts[hash_val & 0xF];
+            }
+        }
+        
+        if (actual_samples == 0) {
+            profile.is_sorted = true;
+            return profile;
+        }
+        
+        profile.run_count = runs;
+        
+        // 判断排序状态 (完整验证)
+        if (asc == actual_samples) {
+            profile.is_sorted = sorted_prefix(a, n, cmp) == n;
+        } else if (desc == actual_samples) {
+            profile.is_reverse = reverse_prefix(a, n, cmp) == n;
+        }
+        
+        profile.is_nearly_sorted = (asc > actual_samples * 9 / 10) || 
+                                    (desc > actual_samples * 9 / 10);
+        
+        // 接近有序时采样估计太粗，整段扫描得到精确游程数
+        if (profile.is_nearly_sorted && !profile.is_sorted && !profile.is_reverse &&
+            can_scan_simd_v<T, Cmp>) {
+            profile.run_count = (asc >= desc) ? count_runs<false>(a, n, cmp)
+                                              : count_runs<true>(a, n, cmp);
+        }
+        profile.has_many_duplicates = eq > actual_samples / 4;
+        
+        // 计算熵
+        if constexpr (std::is_integral_v<T>) {
+            double total = static_cast<double>(actual_samples);
+            for (size_t i = 0; i < 16; ++i) {
+                if (bucket_counts[i] > 0) {
+                    double p = bucket_counts[i] / total;
+                    profile.entropy -= p * std::log2(p);
+                }
+            }
+            
+            size_t non_empty_buckets = 0;
+            for (size_t i = 0; i < 16; ++i) {
+                if (bucket_counts[i] > 0) ++non_empty_buckets;
+            }
+            profile.unique_estimate = non_empty_buckets * n / 16;
+        }
+        
+        // 检查是否小范围
+        if constexpr (std::is_integral_v<T>) {
+            size_t check_size = std::min(n, size_t(1000));
+            auto [mn, mx] = simd::find_minmax(a, check_size);
+            
+            // 安全计算范围
+            uint64_t range;
+            if constexpr (std::is_signed_v<T>) {
+                if (mx >= mn) {
+                    range = static_cast<uint64_t>(static_cast<int64_t>(mx) - static_cast<int64_t>(mn));
+                } else {
+                    range = UINT64_MAX;
+                }
+            } else {
+                range = static_cast<uint64_t>(mx) - static_cast<uint64_t>(mn);
+            }
+            profile.is_small_range = range < static_cast<uint64_t>(n) * config::COUNTING_SORT_RATIO;
+        }
+        
+        return profile;
+    }
+    
+    enum class Algorithm {
+        InsertionSort,
+        HeapSort,
+        PDQSort,
+        MergeSort,
+        RadixSort,
+        CountingSort,
+        AmericanFlagSort
+    };
+    
+    template<typename T, typename Cmp>
+    Algorithm select_algorithm(size_t n, const DataProfile& profile, const Options& opts) {
+        if (n <= config::INSERTION_LIMIT) {
+            return Algorithm::InsertionSort;
+        }
+        
+        if (opts.force_radix && traits::is_radix_sortable_v<T>) {
+            return Algorithm::RadixSort;
+        }
+        if (opts.force_comparison) {
+            return Algorithm::PDQSort;
+        }
+        if (opts.stable) {
+            return Algorithm::MergeSort;
+        }
+        
+        if constexpr (traits::is_radix_sortable_v<T>) {
+            if constexpr (traits::is_default_less_v<T, Cmp>) {
+                if (profile.is_small_range && n >= config::COUNTING_MIN_SIZE) {
+                    return Algorithm::CountingSort;
+                }
+                if (n >= 10000) {
+                    return Algorithm::RadixSort;
+                }
+            }
+        }
+        
+        if (profile.is_nearly_sorted && profile.run_count < n / 32) {
+            return Algorithm::InsertionSort;
+        }
+        
+        return Algorithm::PDQSort;
+    }
+} // namespace adaptive
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十二部分: 超标量采样分区
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace supersample {
+    template<typename T, typename Cmp>
+    struct Sampler {
+        static constexpr size_t OVERSAMPLING = config::OVERSAMPLING_FACTOR;
         
-        if (shift < 0) {
-            shift = static_cast<int>(sizeof(Key) * 8 - 8);
+        static void sample(const T* data, size_t n, std::vector<T>& samples, 
+                          size_t num_buckets, Cmp& cmp) {
+            size_t num_samples = num_buckets * OVERSAMPLING;
+            samples.resize(num_samples);
+            
+            // 均匀采样
+            for (size_t i = 0; i < num_samples; ++i) {
+                size_t idx = (i * n) / num_samples;
+                samples[i] = data[idx];
+            }
+            
+            std::sort(samples.begin(), samples.end(), cmp);
+            
+            // 选择分位点作为枢纽
+            std::vector<T> pivots(num_buckets - 1);
+            for (size_t i = 0; i < num_buckets - 1; ++i) {
+                pivots[i] = samples[(i + 1) * OVERSAMPLING];
+            }
+            samples = std::move(pivots);
+        }
+    };
+    
+    template<typename T, typename Cmp>
+    struct Classifier {
+        const std::vector<T>& pivots;
+        Cmp& cmp;
+        
+        Classifier(const std::vector<T>& p, Cmp& c) : pivots(p), cmp(c) {}
+        
+        FYX_INLINE size_t classify(const T& val) const noexcept {
+            // 对于小数量枢纽使用线性搜索（分支预测友好）
+            size_t num_pivots = pivots.size();
+            if (num_pivots <= 7) {
+                size_t b = 0;
+                while (b < num_pivots && !cmp(val, pivots[b])) ++b;
+                return b;
+            }
+            
+            // 二分搜索
+            size_t lo = 0, hi = num_pivots;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (cmp(pivots[mid], val)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
         }
         
-        if (n <= config::SMALL || shift < 0) {
-            std::less<T> cmp;
-            insertion::sort(a, n, cmp);
+        void classify_batch(const T* data, size_t n, size_t* buckets) const noexcept {
+            for (size_t i = 0; i < n; ++i) {
+                buckets[i] = classify(data[i]);
+            }
+        }
+    };
+    
+    template<typename T, typename Cmp>
+    void partition(T* data, size_t n, size_t num_buckets, Cmp& cmp,
+                   std::vector<size_t>& bucket_starts, 
+                   std::vector<size_t>& bucket_sizes) {
+        
+        num_buckets = std::min(num_buckets, config::MAX_BUCKETS);
+        
+        if (num_buckets < 2) {
+            bucket_starts = {0};
+            bucket_sizes = {n};
             return;
         }
         
-        constexpr size_t NB = 256;
-        alignas(64) size_t count[NB] = {};
-        alignas(64) size_t offset[NB + 1];
+        std::vector<T> pivots;
+        Sampler<T, Cmp>::sample(data, n, pivots, num_buckets, cmp);
+        
+        Classifier<T, Cmp> classifier(pivots, cmp);
+        
+        bucket_sizes.resize(num_buckets, 0);
         
         // 计数
-        for (size_t i = 0; i < n; ++i) {
-            ++count[(Map::to_key(a[i]) >> shift) & 0xFF];
+        constexpr size_t BLOCK = 4096;
+        mem::Buffer<size_t> bucket_indices(n);
+        
+        if (bucket_indices) {
+            for (size_t i = 0; i < n; i += BLOCK) {
+                size_t block_size = std::min(BLOCK, n - i);
+                classifier.classify_batch(data + i, block_size, bucket_indices.data() + i);
+                for (size_t j = 0; j < block_size; ++j) {
+                    ++bucket_sizes[bucket_indices[i + j]];
+                }
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                ++bucket_sizes[classifier.classify(data[i])];
+            }
         }
         
         // 计算偏移
-        offset[0] = 0;
-        for (size_t i = 0; i < NB; ++i) {
-            offset[i + 1] = offset[i] + count[i];
+        bucket_starts.resize(num_buckets + 1);
+        bucket_starts[0] = 0;
+        for (size_t i = 0; i < num_buckets; ++i) {
+            bucket_starts[i + 1] = bucket_starts[i] + bucket_sizes[i];
         }
         
-        // 原地分区 (修复版)
-        alignas(64) size_t current[NB];
-        std::memcpy(current, offset, sizeof(current));
+        // 分发
+        mem::Buffer<T> buffer(n);
+        if (!buffer) {
+            std::stable_sort(data, data + n, cmp);
+            return;
+        }
         
-        for (size_t b = 0; b < NB; ++b) {
-            size_t end = offset[b + 1];
-            while (current[b] < end) {
-                size_t bucket = (Map::to_key(a[current[b]]) >> shift) & 0xFF;
-                if (bucket == b) {
-                    ++current[b];
+        std::vector<size_t> write_pos(bucket_starts.begin(), bucket_starts.end() - 1);
+        
+        // 缓冲区是未构造的原始内存: 非平凡类型 (如std::string) 须移动构造进去、移回后析构，
+        // 不能赋值或按字节搬运
+        auto place = [&](size_t b, size_t i) {
+            if constexpr (std::is_trivially_copyable_v<T>) buffer[write_pos[b]++] = data[i];
+            else ::new (static_cast<void*>(buffer.data() + write_pos[b]++)) T(std::move(data[i]));
+        };
+        
+        if (bucket_indices) {
+            for (size_t i = 0; i < n; ++i) place(bucket_indices[i], i);
+        } else {
+            for (size_t i = 0; i < n; ++i) place(classifier.classify(data[i]), i);
+        }
+        
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(data, buffer.data(), n * sizeof(T));
+        } else {
+            std::move(buffer.data(), buffer.data() + n, data);
+            std::destroy_n(buffer.data(), n);
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十三部分: PDQSort
+// ═══════════════════════════════════════════════════════════════════════════
+
+// 向量化分区快排: 数值类型配默认比较器时由pdq::sort在运行时选用。
+// 分区按x86-simd-sort的就地双端写法: AVX-512用压缩存储，AVX2用置换表
+namespace vqsort {
+    template<typename T>
+    inline constexpr bool eligible_v = traits::can_use_avx512_v<T>;
+    
+    // 16点等距采样的中位数作枢轴
+    template<typename T>
+    FYX_INLINE T sample_pivot(const T* a, size_t n) noexcept {
+        T s[16];
+        size_t step = n / 16;
+        for (size_t i = 0; i < 16; ++i) s[i] = a[i * step + step / 2];
+        std::less<T> c;
+        insertion::sort(s, 16, c);
+        return s[8];
+    }
+    
+    // LE=false: 返回m使[0,m) < pivot；LE=true: [0,m) <= pivot。NaN总在右侧
+    template<bool LE, typename T>
+    FYX_INLINE bool goes_left(T x, T pivot) noexcept {
+        if constexpr (LE) return x <= pivot;
+        else return x < pivot;
+    }
+    
+    template<bool LE, typename T>
+    FYX_INLINE size_t partition_scalar(T* a, size_t l, size_t r, T pivot) noexcept {
+        while (l < r) {
+            if (goes_left<LE>(a[l], pivot)) ++l;
+            else ops::swap(a[l], a[--r]);
+        }
+        return l;
+    }
+    
+#ifdef FYX_AVX512_KERNELS
+    // 一个向量拆成两半: 左半写到l_store起，右半写到r_end之前；返回右半个数
+    template<typename V, bool LE, typename T>
+    FYX_INLINE FYX_TARGET_AVX512 size_t split_512(T* a, size_t l_store, size_t r_end,
+                                                  typename V::reg x, typename V::reg p) noexcept {
+        typename V::mask m = LE ? V::gt(x, p) : V::ge(x, p);
+        size_t k = static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(m)));
+        V::compress_store(a + l_store, static_cast<typename V::mask>(~m), x);
+        V::compress_store(a + r_end - k, m, x);
+        return k;
+    }
+    
+    template<typename V, bool LE, typename T>
+    FYX_TARGET_AVX512 size_t partition_512(T* a, size_t n, T pivot) noexcept {
+        constexpr size_t W = V::W;
+        size_t l = 0, r = n;
+        
+        // 先用标量把中段长度整理成W的倍数
+        for (size_t i = n % W; i > 0; --i) {
+            if (goes_left<LE>(a[l], pivot)) ++l;
+            else ops::swap(a[l], a[--r]);
+        }
+        if (r - l < 2 * W) return partition_scalar<LE>(a, l, r, pivot);
+        
+        // 首尾两个向量先存进寄存器腾出空位，最后再分
+        const typename V::reg p = V::set1(pivot);
+        typename V::reg vl = V::load(a + l);
+        typename V::reg vr = V::load(a + r - W);
+        size_t l_store = l, r_end = r;
+        size_t li = l + W, ri = r - W;
+        
+        while (li != ri) {
+            typename V::reg x;
+            // 从空位更少的一端读入，保证两端写入都不会越过未读数据
+            if (r_end - ri < li - l_store) {
+                ri -= W;
+                x = V::load(a + ri);
+            } else {
+                x = V::load(a + li);
+                li += W;
+            }
+            size_t k = split_512<V, LE>(a, l_store, r_end, x, p);
+            r_end -= k;
+            l_store += W - k;
+        }
+        
+        size_t k = split_512<V, LE>(a, l_store, r_end, vl, p);
+        r_end -= k;
+        l_store += W - k;
+        k = split_512<V, LE>(a, l_store, r_end, vr, p);
+        l_store += W - k;
+        return l_store;
+    }
+    
+    // 分区内核标签: 供sort_loop按指令集选用
+    struct Avx512Part {
+        template<bool LE, typename T>
+        static size_t partition(T* a, size_t n, T pivot) noexcept {
+            return partition_512<simd512::VecOps<T>, LE>(a, n, pivot);
+        }
+    };
+#endif
+    
+#ifdef FYX_AVX2_KERNELS
+    // AVX2没有压缩存储: 查表置换后整向量写两次 (左端写入左半，右端写入右半)。
+    // 先读空位少的一端，能保证两端每次都至少留有W个空位，多写的通道随后会被覆盖
+    template<typename V, bool LE, typename T>
+    FYX_TARGET_AVX2 size_t partition_256(T* a, size_t n, T pivot) noexcept {
+        constexpr size_t W = V::W;
+        size_t l = 0, r = n;
+        
+        for (size_t i = n % W; i > 0; --i) {
+            if (goes_left<LE>(a[l], pivot)) ++l;
+            else ops::swap(a[l], a[--r]);
+        }
+        if (r - l < 2 * W) return partition_scalar<LE>(a, l, r, pivot);
+        
+        const typename V::reg p = V::set1(pivot);
+        typename V::reg vl = V::load(a + l);
+        typename V::reg vr = V::load(a + r - W);
+        size_t l_store = l, r_end = r;
+        size_t li = l + W, ri = r - W;
+        
+        while (li != ri) {
+            typename V::reg x;
+            if (r_end - ri < li - l_store) {
+                ri -= W;
+                x = V::load(a + ri);
+            } else {
+                x = V::load(a + li);
+                li += W;
+            }
+            typename V::mask m = LE ? V::gt(x, p) : V::ge(x, p);
+            size_t k = static_cast<size_t>(__builtin_popcount(m));
+            x = V::permute(x, m);
+            V::store(a + l_store, x);
+            V::store(a + r_end - W, x);
+            r_end -= k;
+            l_store += W - k;
+        }
+        
+        // 最后两个向量正好填满剩余的2W个空位，逐个写回
+        T tail[2 * W];
+        V::store(tail, vl);
+        V::store(tail + W, vr);
+        for (size_t i = 0; i < 2 * W; ++i) {
+            if (goes_left<LE>(tail[i], pivot)) a[l_store++] = tail[i];
+            else a[--r_end] = tail[i];
+        }
+        return l_store;
+    }
+    
+    struct Avx2Part {
+        template<bool LE, typename T>
+        static size_t partition(T* a, size_t n, T pivot) noexcept {
+            return partition_256<simd256::VecOps<T>, LE>(a, n, pivot);
+        }
+    };
+#endif
+    
+    template<typename Part, typename T>
+    void sort_loop(T* a, size_t n, int depth) noexcept {
+        std::less<T> cmp;
+        while (n > config::VQSORT_BASE) {
+            if (depth-- == 0) {
+                heap::sort(a, n, cmp);
+                return;
+            }
+            T pivot = sample_pivot(a, n);
+            if constexpr (std::is_floating_point_v<T>) {
+                if (pivot != pivot) {
+                    heap::sort(a, n, cmp);
+                    return;
+                }
+            }
+            size_t m = Part::template partition<false>(a, n, pivot);
+            if (m == 0) {
+                // 枢轴即最小值: 按<=再分一次，左侧全等于枢轴，不必再排
+                m = Part::template partition<true>(a, n, pivot);
+                a += m;
+                n -= m;
+                continue;
+            }
+            if (m < n - m) {
+                sort_loop<Part>(a, m, depth);
+                a += m;
+                n -= m;
+            } else {
+                sort_loop<Part>(a + m, n - m, depth);
+                n = m;
+            }
+        }
+        sortnet::small_sort(a, n, cmp);
+    }
+    
+    // 升序排序；返回false表示当前CPU没有可用的向量内核，由调用方走标量路径
+    template<typename T>
+    bool sort(T* a, size_t n, simd::Isa isa = simd::active_isa()) noexcept {
+        if (n < config::VQSORT_MIN_SIZE) return false;
+        int depth = 0;
+        for (size_t m = n; m > 1; m >>= 1) ++depth;
+#ifdef FYX_AVX512_KERNELS
+        if (isa == simd::Isa::AVX512) {
+            sort_loop<Avx512Part>(a, n, depth * 2);
+            return true;
+        }
+#endif
+#ifdef FYX_AVX2_KERNELS
+        if (isa == simd::Isa::AVX2) {
+            sort_loop<Avx2Part>(a, n, depth * 2);
+            return true;
+        }
+#endif
+        (void)a; (void)isa; (void)depth;
+        return false;
+    }
+}
+
+namespace pdq {
+    template<typename T, typename Cmp>
+    FYX_INLINE T& median3(T* a, T* b, T* c, Cmp& cmp) {
+        if (cmp(*b, *a)) ops::swap(*a, *b);
+        if (cmp(*c, *b)) ops::swap(*b, *c);
+        if (cmp(*b, *a)) ops::swap(*a, *b);
+        return *b;
+    }
+    
+    template<typename T, typename Cmp>
+    FYX_INLINE T& ninther(T* a, size_t n, Cmp& cmp) {
+        size_t s = n / 8;
+        median3(a, a + s, a + 2*s, cmp);
+        median3(a + (n/2 - s), a + n/2, a + (n/2 + s), cmp);
+        median3(a + (n - 2*s - 1), a + (n - s - 1), a + (n - 1), cmp);
+        return median3(a, a + n/2, a + n - 1, cmp);
+    }
+    
+    // 选枢轴并换到*first；三数取中后末元素不小于枢轴，可作右扫的哨兵
+    template<typename T, typename Cmp>
+    FYX_INLINE void choose_pivot(T* first, size_t n, Cmp& cmp) {
+        T* piv;
+        if (n >= 128) {
+            piv = &ninther(first, n, cmp);
+        } else {
+            piv = &median3(first, first + n/2, first + n - 1, cmp);
+        }
+        ops::swap(*first, *piv);
+    }
+    
+    // 三路分区 (枢轴在*first): 返回等于枢轴的区间[lt, gt)。只在检测到枢轴大量重复时使用
+    template<typename T, typename Cmp>
+    std::pair<T*, T*> partition3(T* first, T* last, Cmp& cmp) {
+        T pivot = *first;
+        T* lt = first;
+        T* gt = last;
+        T* i = first + 1;
+        
+        while (i < gt) {
+            if (cmp(*i, pivot)) {
+                ops::swap(*lt++, *i++);
+            } else if (cmp(pivot, *i)) {
+                ops::swap(*i, *--gt);
+            } else {
+                ++i;
+            }
+        }
+        
+        return {lt, gt};
+    }
+    
+    // 分块无分支分区只适合搬运便宜的小类型；字符串等仍用带分支的Hoare分区
+    template<typename T>
+    inline constexpr bool use_branchless_v = std::is_trivially_copyable_v<T> && sizeof(T) <= 16;
+    
+    inline constexpr size_t BLOCK = 64;
+    
+    // 按偏移成批交换左右错位元素；两侧个数相等时逐对交换 (降序输入要靠它保持O(n))，
+    // 否则用一条循环置换，每个元素只搬一次
+    template<typename T>
+    FYX_INLINE void swap_offsets(T* first, T* last, const unsigned char* offsets_l,
+                                 const unsigned char* offsets_r, size_t num, bool use_swaps) {
+        if (use_swaps) {
+            for (size_t i = 0; i < num; ++i) {
+                ops::swap(first[offsets_l[i]], *(last - offsets_r[i]));
+            }
+        } else if (num > 0) {
+            T* l = first + offsets_l[0];
+            T* r = last - offsets_r[0];
+            T tmp(std::move(*l));
+            *l = std::move(*r);
+            for (size_t i = 1; i < num; ++i) {
+                l = first + offsets_l[i];
+                *r = std::move(*l);
+                r = last - offsets_r[i];
+                *l = std::move(*r);
+            }
+            *r = std::move(tmp);
+        }
+    }
+    
+    // BlockQuicksort式分区 (枢轴在*begin): 两端各扫一块，比较结果只用来累加偏移下标，
+    // 不产生依赖数据的分支；错位元素攒满后成批交换。
+    // 返回枢轴最终位置，以及输入是否本来就已分好区
+    template<typename T, typename Cmp>
+    std::pair<T*, bool> partition_right_branchless(T* begin, T* end, Cmp& cmp) {
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        
+        // 三数取中保证右侧有不小于枢轴的元素，左扫无需边界检查
+        while (cmp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+        else                    while (!cmp(*--last, pivot));
+        
+        bool already_partitioned = first >= last;
+        if (!already_partitioned) {
+            ops::swap(*first, *last);
+            ++first;
+            
+            alignas(64) unsigned char offsets_l[BLOCK];
+            alignas(64) unsigned char offsets_r[BLOCK];
+            T* base_l = first;
+            T* base_r = last;
+            size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            
+            while (first < last) {
+                // 哪一侧的偏移缓冲空了就给哪一侧补一块；剩余不足两块时按比例分
+                size_t unknown = static_cast<size_t>(last - first);
+                size_t left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                size_t right_split = num_r == 0 ? (unknown - left_split) : 0;
+                
+                if (left_split >= BLOCK) {
+                    for (size_t i = 0; i < BLOCK; i += 4) {
+                        offsets_l[num_l] = static_cast<unsigned char>(i);     num_l += !cmp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i + 1); num_l += !cmp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i + 2); num_l += !cmp(*first, pivot); ++first;
+                        offsets_l[num_l] = static_cast<unsigned char>(i + 3); num_l += !cmp(*first, pivot); ++first;
+                    }
+                } else {
+                    for (size_t i = 0; i < left_split; ++i) {
+                        offsets_l[num_l] = static_cast<unsigned char>(i); num_l += !cmp(*first, pivot); ++first;
+                    }
+                }
+                
+                if (right_split >= BLOCK) {
+                    for (size_t i = 1; i <= BLOCK; i += 4) {
+                        offsets_r[num_r] = static_cast<unsigned char>(i);     num_r += cmp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(i + 1); num_r += cmp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(i + 2); num_r += cmp(*--last, pivot);
+                        offsets_r[num_r] = static_cast<unsigned char>(i + 3); num_r += cmp(*--last, pivot);
+                    }
                 } else {
-                    // 循环交换直到当前位置放入正确元素
-                    while (bucket != b) {
-                        size_t target = current[bucket]++;
-                        ops::swap(a[current[b]], a[target]);
-                        bucket = (Map::to_key(a[current[b]]) >> shift) & 0xFF;
+                    for (size_t i = 1; i <= right_split; ++i) {
+                        offsets_r[num_r] = static_cast<unsigned char>(i); num_r += cmp(*--last, pivot);
                     }
-                    ++current[b];
                 }
+                
+                size_t num = std::min(num_l, num_r);
+                swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+                num_l -= num; num_r -= num;
+                start_l += num; start_r += num;
+                
+                if (num_l == 0) { start_l = 0; base_l = first; }
+                if (num_r == 0) { start_r = 0; base_r = last; }
             }
-        }
-        
-        // 递归处理各桶
-        if (shift >= 8) {
-            for (size_t b = 0; b < NB; ++b) {
-                if (count[b] > 1) {
-                    american_flag_sort(a + offset[b], count[b], shift - 8);
-                }
+            
+            // 一侧还剩错位元素: 逐个换到分界处
+            if (num_l) {
+                while (num_l--) ops::swap(base_l[offsets_l[start_l + num_l]], *--last);
+                first = last;
+            }
+            if (num_r) {
+                while (num_r--) { ops::swap(*(base_r - offsets_r[start_r + num_r]), *first); ++first; }
+                last = first;
             }
         }
+        
+        T* pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
     }
     
-    // 分层自适应基数排序入口
-    template<typename T>
-    void hierarchical_sort(T* a, size_t n) {
-        if (n <= config::SMALL) {
-            std::less<T> cmp;
-            insertion::sort(a, n, cmp);
-            return;
-        }
-        
-        // 尝试计数排序
-        if (counting::try_sort(a, n)) return;
-        
-        // 根据数据大小选择最优算法
-        if (n <= config::HIERARCHICAL_L1_THRESHOLD) {
-            sort_l1_block(a, n);
-        } else if (n <= config::HIERARCHICAL_L2_THRESHOLD) {
-            lsd_sort(a, n);
-        } else if (n <= config::HIERARCHICAL_L3_THRESHOLD) {
-            lsd_sort(a, n);
-        } else {
-            msd_sort(a, n);
-        }
+    // 带分支的Hoare分区，约定同partition_right_branchless
+    template<typename T, typename Cmp>
+    std::pair<T*, bool> partition_right(T* begin, T* end, Cmp& cmp) {
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        
+        while (cmp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !cmp(*--last, pivot));
+        else                    while (!cmp(*--last, pivot));
+        
+        bool already_partitioned = first >= last;
+        while (first < last) {
+            ops::swap(*first, *last);
+            while (cmp(*++first, pivot));
+            while (!cmp(*--last, pivot));
+        }
+        
+        T* pivot_pos = first - 1;
+        *begin = std::move(*pivot_pos);
+        *pivot_pos = std::move(pivot);
+        return {pivot_pos, already_partitioned};
     }
     
-    // 主入口
+    // 分区过偏时在两侧各挑几个元素与四分位附近的元素对调，打乱风琴管、锯齿等会让取中持续失效的模式
     template<typename T>
-    void sort(T* a, size_t n) {
-        hierarchical_sort(a, n);
+    FYX_INLINE void break_patterns(T* first, T* last) {
+        size_t n = static_cast<size_t>(last - first);
+        if (n < config::INSERTION_LIMIT) return;
+        size_t q = n / 4;
+        ops::swap(first[0], first[q]);
+        ops::swap(last[-1], last[-1 - static_cast<ptrdiff_t>(q)]);
+        if (n > 128) {
+            ops::swap(first[1], first[q + 1]);
+            ops::swap(first[2], first[q + 2]);
+            ops::swap(last[-2], last[-2 - static_cast<ptrdiff_t>(q)]);
+            ops::swap(last[-3], last[-3 - static_cast<ptrdiff_t>(q)]);
+        }
     }
-} // namespace radix
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第二十部分: 无锁工作窃取队列 (修复版 - 增强线程安全)
-// ═══════════════════════════════════════════════════════════════════════════
-
-#if FYX_ENABLE_PARALLEL
-namespace parallel {
-    
-    struct WorkItem {
-        void* data = nullptr;
-        size_t start = 0;
-        size_t length = 0;
-        int depth = 0;
-        
-        bool valid() const { return data != nullptr && length > 0; }
-    };
     
-    // Chase-Lev无锁工作窃取双端队列 (修复版)
-    class LockFreeWorkStealQueue {
-        static constexpr size_t INITIAL_CAPACITY = 1024;
-        static constexpr size_t MAX_CAPACITY = 1 << 20;
-        
-        struct CircularArray {
-            std::vector<std::atomic<WorkItem>> items;
-            size_t mask;
+    // bad_allowed: 还能容忍的过偏分区次数，用尽后退化为堆排序以保证O(n log n)；
+    // left: 区间是否处于数组最左端，否则first[-1]可作插入排序与重复值检测的哨兵
+    template<typename T, typename Cmp>
+    void sort_impl(T* first, T* last, Cmp& cmp, int bad_allowed, bool left) {
+        while (true) {
+            size_t n = static_cast<size_t>(last - first);
             
-            explicit CircularArray(size_t cap) : items(cap), mask(cap - 1) {}
+            if (n <= config::INSERTION_LIMIT) {
+                if (left) insertion::sort(first, n, cmp);
+                else insertion::sort_unguarded(first, n, cmp);
+                return;
+            }
             
-            size_t capacity() const { return mask + 1; }
+            choose_pivot(first, n, cmp);
             
-            WorkItem get(size_t i) const {
-                return items[i & mask].load(std::memory_order_relaxed);
+            // 非最左区间的前驱不大于区间内任何元素；它不小于枢轴说明枢轴就是区间最小值且大量重复，
+            // 改用三路分区把等值段整体跳过
+            if (!left && !cmp(first[-1], *first)) {
+                first = partition3(first, last, cmp).second;
+                continue;
             }
             
-            void put(size_t i, WorkItem item) {
-                items[i & mask].store(item, std::memory_order_relaxed);
+            std::pair<T*, bool> part;
+            if constexpr (use_branchless_v<T>) part = partition_right_branchless(first, last, cmp);
+            else part = partition_right(first, last, cmp);
+            T* mid = part.first;
+            
+            size_t l_size = static_cast<size_t>(mid - first);
+            size_t r_size = static_cast<size_t>(last - (mid + 1));
+            if (l_size < n / 8 || r_size < n / 8) {
+                if (--bad_allowed == 0) { 
+                    heap::sort(first, n, cmp); 
+                    return; 
+                }
+                break_patterns(first, mid);
+                break_patterns(mid + 1, last);
+            } else if (part.second && insertion::partial_sort(first, l_size, cmp)
+                                   && insertion::partial_sort(mid + 1, r_size, cmp)) {
+                // 分区前两侧就没有错位元素，且各自几乎有序: 有限次插入即可收尾
+                return;
             }
-        };
-        
-        alignas(config::CACHE_LINE) std::atomic<size_t> bottom{0};
-        alignas(config::CACHE_LINE) std::atomic<size_t> top{0};
-        alignas(config::CACHE_LINE) std::atomic<CircularArray*> array;
-        
-        // 修复：使用shared_ptr自动管理旧数组
-        std::vector<std::shared_ptr<CircularArray>> garbage;
-        mutable std::mutex garbage_mutex;
-        
-        CircularArray* grow(CircularArray* old_arr, size_t b, size_t t) {
-            size_t new_cap = old_arr->capacity() * 2;
-            if (new_cap > MAX_CAPACITY) new_cap = MAX_CAPACITY;
             
-            auto new_arr = new CircularArray(new_cap);
-            for (size_t i = t; i < b; ++i) {
-                new_arr->put(i, old_arr->get(i));
+            if (l_size < r_size) { 
+                sort_impl(first, mid, cmp, bad_allowed, left); 
+                first = mid + 1; 
+                left = false; 
+            } else { 
+                sort_impl(mid + 1, last, cmp, bad_allowed, false); 
+                last = mid; 
             }
-            return new_arr;
         }
-        
-    public:
-        LockFreeWorkStealQueue() {
-            array.store(new CircularArray(INITIAL_CAPACITY), std::memory_order_relaxed);
+    }
+    
+    template<typename T, typename Cmp>
+    void sort(T* a, size_t n, Cmp cmp) {
+        if (n <= 1) return;
+        if constexpr (vqsort::eligible_v<T> && traits::is_default_less_v<T, Cmp>) {
+            if (vqsort::sort(a, n)) return;
+        } else if constexpr (vqsort::eligible_v<T> && traits::is_default_greater_v<T, Cmp>) {
+            if (vqsort::sort(a, n)) {
+                std::reverse(a, a + n);
+                return;
+            }
         }
-        
-        ~LockFreeWorkStealQueue() {
-            std::lock_guard<std::mutex> lock(garbage_mutex);
-            delete array.load(std::memory_order_relaxed);
-            // shared_ptr自动释放garbage中的数组
+        int bad_allowed = 0; 
+        for (size_t m = n; m > 1; m >>= 1) ++bad_allowed;
+        sort_impl(a, a + n, cmp, bad_allowed, true);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十四部分: 归并排序
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace merge {
+    // 整数键可用SIMD流式归并 (浮点的-0.0/+0.0相等却可区分，双调归并会打乱其次序，不满足稳定性)
+    template<typename T>
+    inline constexpr bool simd_mergeable_v =
+        std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+    
+    template<typename T, typename Cmp>
+    void merge_scalar(const T* a, size_t na, const T* b, size_t nb, T* out, Cmp& cmp) {
+        size_t i = 0, j = 0;
+        while (i < na && j < nb) {
+            if (cmp(b[j], a[i])) out[i + j] = b[j], ++j;
+            else out[i + j] = a[i], ++i;
+        }
+        while (i < na) { out[i + j] = a[i]; ++i; }
+        while (j < nb) { out[i + j] = b[j]; ++j; }
+    }
+    
+    // 流式双调归并: 寄存器里始终留着W个待定元素，每轮从表头较小的一侧再读入W个，
+    // 与之归并后较小的W个即可输出。尾部不足W个时读补了最大值的副本，哨兵总排在最后不会输出
+#ifdef FYX_AVX512_KERNELS
+    template<typename V, typename T>
+    FYX_INLINE FYX_TARGET_AVX512 typename V::reg load_padded_512(const T* src, size_t pos, size_t len) noexcept {
+        using L = traits::lane_t<T>;
+        if (pos + V::W <= len) return V::load(reinterpret_cast<const L*>(src + pos));
+        L pad[V::W];
+        for (size_t k = 0; k < V::W; ++k) {
+            pad[k] = pos + k < len ? static_cast<L>(src[pos + k]) : std::numeric_limits<L>::max();
+        }
+        return V::load(pad);
+    }
+    
+    template<typename V, typename T>
+    FYX_INLINE FYX_TARGET_AVX512 void store_partial_512(T* dst, typename V::reg x, size_t k) noexcept {
+        using L = traits::lane_t<T>;
+        if (k == V::W) {
+            V::store(reinterpret_cast<L*>(dst), x);
+        } else {
+            L tmp[V::W];
+            V::store(tmp, x);
+            std::memcpy(dst, tmp, k * sizeof(T));
         }
-        
-        LockFreeWorkStealQueue(const LockFreeWorkStealQueue&) = delete;
-        LockFreeWorkStealQueue& operator=(const LockFreeWorkStealQueue&) = delete;
-        
-        // 所有者推入
-        void push(WorkItem item) {
-            size_t b = bottom.load(std::memory_order_relaxed);
-            size_t t = top.load(std::memory_order_acquire);
-            CircularArray* arr = array.load(std::memory_order_relaxed);
+    }
+    
+    template<typename T>
+    FYX_TARGET_AVX512 void merge_stream_512(const T* a, size_t na, const T* b, size_t nb, T* out) noexcept {
+        using V = simd512::VecOps<traits::lane_t<T>>;
+        constexpr size_t W = V::W;
+        const size_t total = na + nb;
+        size_t ia = W, ib = W, written = 0;
+        
+        typename V::reg lo = load_padded_512<V>(a, 0, na);
+        typename V::reg hi = load_padded_512<V>(b, 0, nb);
+        while (true) {
+            simd512::merge_pair<V>(lo, hi);
+            size_t k = std::min(W, total - written);
+            store_partial_512<V>(out + written, lo, k);
+            written += k;
+            if (written >= total) return;
             
-            if (b - t >= arr->capacity() - 1) {
-                CircularArray* new_arr = grow(arr, b, t);
-                {
-                    std::lock_guard<std::mutex> lock(garbage_mutex);
-                    garbage.push_back(std::shared_ptr<CircularArray>(arr));
-                }
-                array.store(new_arr, std::memory_order_release);
-                arr = new_arr;
+            bool a_left = ia < na, b_left = ib < nb;
+            if (!a_left && !b_left) {
+                store_partial_512<V>(out + written, hi, total - written);
+                return;
+            }
+            if (a_left && (!b_left || !(b[ib] < a[ia]))) {
+                lo = load_padded_512<V>(a, ia, na);
+                ia += W;
+            } else {
+                lo = load_padded_512<V>(b, ib, nb);
+                ib += W;
             }
-            
-            arr->put(b, item);
-            std::atomic_thread_fence(std::memory_order_release);
-            bottom.store(b + 1, std::memory_order_relaxed);
         }
-        
-        // 所有者弹出
-        bool pop(WorkItem& item) {
-            size_t b = bottom.load(std::memory_order_relaxed);
-            if (b == 0) return false;
-            
-            b = b - 1;
-            bottom.store(b, std::memory_order_relaxed);
-            std::atomic_thread_fence(std::memory_order_seq_cst);
-            
-            size_t t = top.load(std::memory_order_relaxed);
+    }
+#endif
+    
+#ifdef FYX_AVX2_KERNELS
+    template<typename V, typename T>
+    FYX_INLINE FYX_TARGET_AVX2 typename V::reg load_padded_256(const T* src, size_t pos, size_t len) noexcept {
+        using L = traits::lane_t<T>;
+        if (pos + V::W <= len) return V::load(reinterpret_cast<const L*>(src + pos));
+        L pad[V::W];
+        for (size_t k = 0; k < V::W; ++k) {
+            pad[k] = pos + k < len ? static_cast<L>(src[pos + k]) : std::numeric_limits<L>::max();
+        }
+        return V::load(pad);
+    }
+    
+    template<typename V, typename T>
+    FYX_INLINE FYX_TARGET_AVX2 void store_partial_256(T* dst, typename V::reg x, size_t k) noexcept {
+        using L = traits::lane_t<T>;
+        if (k == V::W) {
+            V::store(reinterpret_cast<L*>(dst), x);
+        } else {
+            L tmp[V::W];
+            V::store(tmp, x);
+            std::memcpy(dst, tmp, k * sizeof(T));
+        }
+    }
+    
+    template<typename T>
+    FYX_TARGET_AVX2 void merge_stream_256(const T* a, size_t na, const T* b, size_t nb, T* out) noexcept {
+        using V = simd256::VecOps<traits::lane_t<T>>;
+        constexpr size_t W = V::W;
+        const size_t total = na + nb;
+        size_t ia = W, ib = W, written = 0;
+        
+        typename V::reg lo = load_padded_256<V>(a, 0, na);
+        typename V::reg hi = load_padded_256<V>(b, 0, nb);
+        while (true) {
+            simd256::merge_pair<V>(lo, hi);
+            size_t k = std::min(W, total - written);
+            store_partial_256<V>(out + written, lo, k);
+            written += k;
+            if (written >= total) return;
             
-            if (t <= b) {
-                CircularArray* arr = array.load(std::memory_order_relaxed);
-                item = arr->get(b);
-                
-                if (t == b) {
-                    if (!top.compare_exchange_strong(t, t + 1, 
-                            std::memory_order_seq_cst, std::memory_order_relaxed)) {
-                        bottom.store(b + 1, std::memory_order_relaxed);
-                        return false;
-                    }
-                    bottom.store(b + 1, std::memory_order_relaxed);
-                }
-                return true;
+            bool a_left = ia < na, b_left = ib < nb;
+            if (!a_left && !b_left) {
+                store_partial_256<V>(out + written, hi, total - written);
+                return;
+            }
+            if (a_left && (!b_left || !(b[ib] < a[ia]))) {
+                lo = load_padded_256<V>(a, ia, na);
+                ia += W;
             } else {
-                bottom.store(b + 1, std::memory_order_relaxed);
-                return false;
+                lo = load_padded_256<V>(b, ib, nb);
+                ib += W;
             }
         }
-        
-        // 窃取
-        bool steal(WorkItem& item) {
-            size_t t = top.load(std::memory_order_acquire);
-            std::atomic_thread_fence(std::memory_order_seq_cst);
-            size_t b = bottom.load(std::memory_order_acquire);
-            
-            if (t >= b) return false;
-            
-            CircularArray* arr = array.load(std::memory_order_consume);
-            item = arr->get(t);
-            
-            if (!top.compare_exchange_strong(t, t + 1,
-                    std::memory_order_seq_cst, std::memory_order_relaxed)) {
-                return false;
+    }
+#endif
+    
+    // 归并两个升序整数段到out (out不能与输入重叠)
+    template<typename T>
+    void merge_runs(const T* a, size_t na, const T* b, size_t nb, T* out) {
+        static_assert(simd_mergeable_v<T>, "merge_runs只用于整数键");
+        if (na == 0 || nb == 0 || !(b[0] < a[na - 1])) {
+            if (na) std::memcpy(out, a, na * sizeof(T));
+            if (nb) std::memcpy(out + na, b, nb * sizeof(T));
+            return;
+        }
+        constexpr size_t W = 64 / sizeof(T);
+        if (na + nb >= 4 * W) {
+#ifdef FYX_AVX512_KERNELS
+            if (simd::active_isa() == simd::Isa::AVX512) {
+                merge_stream_512(a, na, b, nb, out);
+                return;
+            }
+#endif
+#ifdef FYX_AVX2_KERNELS
+            if (simd::active_isa() == simd::Isa::AVX2) {
+                merge_stream_256(a, na, b, nb, out);
+                return;
+            }
+#endif
+        }
+        std::less<T> cmp;
+        merge_scalar(a, na, b, nb, out, cmp);
+    }
+    
+    // 整数键: 先把SMALL长度的块排好，再在原数组与缓冲区之间来回做SIMD归并
+    template<typename T>
+    void sort_integral(T* a, size_t n, T* buf) {
+        std::less<T> cmp;
+        for (size_t i = 0; i < n; i += config::SMALL) {
+            insertion::sort(a + i, std::min(config::SMALL, n - i), cmp);
+        }
+        T* src = a;
+        T* dst = buf;
+        for (size_t width = config::SMALL; width < n; width *= 2) {
+            for (size_t i = 0; i < n; i += 2 * width) {
+                size_t mid = std::min(i + width, n);
+                size_t right = std::min(i + 2 * width, n);
+                merge_runs(src + i, mid - i, src + mid, right - mid, dst + i);
+            }
+            std::swap(src, dst);
+        }
+        if (src != a) std::memcpy(a, src, n * sizeof(T));
+    }
+    
+    // ─────────────── 自然游程归并: powersort合并次序 + 飞驰模式 ───────────────
+    
+    inline constexpr size_t MIN_GALLOP = 7;
+    
+    // 整数键平均游程不短于此值时按自然游程归并，否则固定宽度的SIMD归并更快
+    inline constexpr size_t NATURAL_RUN_MIN = 64;
+    
+    // 最短游程: 取n的高6位，舍去的位非零则进一 (同TimSort，结果落在[32, 64])
+    inline size_t min_run_length(size_t n) noexcept {
+        size_t r = 0;
+        while (n >= 64) { 
+            r |= n & 1; 
+            n >>= 1; 
+        }
+        return n + r;
+    }
+    
+    // powersort节点深度: 相邻游程[s1, s1+n1)与[s1+n1, s1+n1+n2)的中点除以n后，
+    // 二进制展开第一个不同位的位置。深度大的边界先合并，合并树接近按长度最优的二叉树
+    inline unsigned node_power(size_t s1, size_t n1, size_t n2, size_t n) noexcept {
+        size_t a = 2 * s1 + n1;
+        size_t b = a + n1 + n2;
+        unsigned power = 0;
+        while (true) {
+            ++power;
+            if (a >= n) { 
+                a -= n; 
+                b -= n; 
+            } else if (b >= n) {
+                break;
             }
-            
-            return true;
+            a <<= 1; 
+            b <<= 1;
         }
-        
-        bool empty() const {
-            size_t t = top.load(std::memory_order_relaxed);
-            size_t b = bottom.load(std::memory_order_relaxed);
-            return t >= b;
+        return power;
+    }
+    
+    // 指数搜索 + 二分: pred在[0, n)上先false后true，返回第一个true的位置。
+    // FromRight为true时从右端起跳，答案靠近末尾时只需O(log 距离)次比较
+    template<bool FromRight, typename Pred>
+    FYX_INLINE size_t gallop(size_t n, Pred pred) {
+        size_t lo = 0, hi = n;
+        if constexpr (!FromRight) {
+            for (size_t p = 0; p < n; p = 2 * p + 1) {
+                if (pred(p)) { hi = p; break; }
+                lo = p + 1;
+            }
+        } else {
+            for (size_t ofs = 1; ofs <= n; ofs *= 2) {
+                if (!pred(n - ofs)) { lo = n - ofs + 1; break; }
+                hi = n - ofs;
+            }
         }
-        
-        size_t size() const {
-            size_t t = top.load(std::memory_order_relaxed);
-            size_t b = bottom.load(std::memory_order_relaxed);
-            return (b > t) ? (b - t) : 0;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (pred(mid)) hi = mid;
+            else lo = mid + 1;
         }
-    };
+        return lo;
+    }
     
-    // 并行基数排序
+    // 暂存区是未构造的原始内存: 非平凡类型移动构造进去，用完析构
     template<typename T>
-    void parallel_radix(T* a, size_t n, const Options& opts) {
-        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
-        if (n < opts.parallel_threshold * 2 || nt <= 1) {
-            radix::sort(a, n);
-            return;
+    FYX_INLINE void stash(T* buf, T* src, size_t n) {
+        if constexpr (std::is_trivially_copyable_v<T>) std::memcpy(buf, src, n * sizeof(T));
+        else std::uninitialized_move_n(src, n, buf);
+    }
+    
+    template<typename T>
+    FYX_INLINE void unstash(T* buf, size_t n) {
+        if constexpr (!std::is_trivially_copyable_v<T>) std::destroy_n(buf, n);
+    }
+    
+    // 稳定插入: [0, sorted)已有序，其余元素插到等值元素之后。可平凡复制的类型比较和搬移都便宜，
+    // 线性查找更快；其余类型 (如字符串) 用二分查找省比较
+    template<typename T, typename Cmp>
+    void stable_insertion(T* a, size_t sorted, size_t n, Cmp& cmp) {
+        for (size_t i = std::max<size_t>(sorted, 1); i < n; ++i) {
+            if (!cmp(a[i], a[i - 1])) continue;
+            T key = std::move(a[i]);
+            T* p = a + i;
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                do { 
+                    *p = std::move(p[-1]); 
+                    --p; 
+                } while (p != a && cmp(key, p[-1]));
+            } else {
+                T* pos = std::upper_bound(a, p - 1, key, cmp);
+                std::move_backward(pos, p, p + 1);
+                p = pos;
+            }
+            *p = std::move(key);
         }
+    }
+    
+    // a起始的自然游程长度。只翻转严格递减的游程，否则等值元素的次序会被颠倒
+    template<typename T, typename Cmp>
+    size_t find_run(T* a, size_t n, Cmp& cmp) {
+        if (n < 2) return n;
+        if (!cmp(a[1], a[0])) return adaptive::sorted_prefix(a, n, cmp);
+        size_t i = 2;
+        while (i < n && cmp(a[i], a[i - 1])) ++i;
+        std::reverse(a, a + i);
+        return i;
+    }
+    
+    // 修剪后A[0] > B[0]且A末 > B末，na <= nb: A移入暂存区，从前往后归并
+    template<typename T, typename Cmp>
+    void merge_lo(T* a, size_t na, size_t nb, T* buf, Cmp& cmp, size_t& min_gallop) {
+        stash(buf, a, na);
+        T* pa = buf;
+        T* ea = buf + na;
+        T* pb = a + na;
+        T* eb = pb + nb;
+        T* out = a;
+        *out++ = std::move(*pb++);
+        
+        [&]() {
+            if (pb == eb) return;
+            while (true) {
+                // 逐个比较，一侧连胜min_gallop次后转入飞驰
+                size_t wa = 0, wb = 0;
+                do {
+                    if (cmp(*pb, *pa)) {
+                        *out++ = std::move(*pb++);
+                        ++wb; wa = 0;
+                        if (pb == eb) return;
+                    } else {
+                        *out++ = std::move(*pa++);
+                        ++wa; wb = 0;
+                        if (pa == ea) return;
+                    }
+                } while ((wa | wb) < min_gallop);
+                
+                ++min_gallop;
+                do {
+                    min_gallop -= min_gallop > 1;
+                    wa = gallop<false>(static_cast<size_t>(ea - pa), [&](size_t i) { return cmp(*pb, pa[i]); });
+                    out = std::move(pa, pa + wa, out);
+                    pa += wa;
+                    if (pa == ea) return;
+                    *out++ = std::move(*pb++);
+                    if (pb == eb) return;
+                    
+                    wb = gallop<false>(static_cast<size_t>(eb - pb), [&](size_t j) { return !cmp(pb[j], *pa); });
+                    out = std::move(pb, pb + wb, out);
+                    pb += wb;
+                    if (pb == eb) return;
+                    *out++ = std::move(*pa++);
+                    if (pa == ea) return;
+                } while (wa >= MIN_GALLOP || wb >= MIN_GALLOP);
+                ++min_gallop;
+            }
+        }();
         
-        nt = std::min(nt, config::MAX_BUCKETS);
-        
-        using Map = keymap::Mapper<T>;
-        using Key = typename Map::Key;
-        constexpr size_t NB = 256;
-        constexpr int SHIFT = sizeof(Key) * 8 - 8;
-        
-        // 第一阶段：并行计数
-        std::vector<mem::AlignedArray<size_t, NB>> local_counts(nt);
-        size_t chunk = (n + nt - 1) / nt;
-        std::vector<std::thread> threads;
-        threads.reserve(nt);
+        // B先耗尽时A的剩余接到末尾；A先耗尽时B的剩余本就在原位
+        std::move(pa, ea, out);
+        unstash(buf, na);
+    }
+    
+    // 同上，nb < na: B移入暂存区，从后往前归并
+    template<typename T, typename Cmp>
+    void merge_hi(T* a, size_t na, size_t nb, T* buf, Cmp& cmp, size_t& min_gallop) {
+        T* b = a + na;
+        stash(buf, b, nb);
+        T* pa = b;
+        T* pb = buf + nb;
+        T* out = b + nb;
+        *--out = std::move(*--pa);
+        
+        [&]() {
+            if (pa == a) return;
+            while (true) {
+                size_t wa = 0, wb = 0;
+                do {
+                    if (cmp(pb[-1], pa[-1])) {
+                        *--out = std::move(*--pa);
+                        ++wa; wb = 0;
+                        if (pa == a) return;
+                    } else {
+                        *--out = std::move(*--pb);
+                        ++wb; wa = 0;
+                        if (pb == buf) return;
+                    }
+                } while ((wa | wb) < min_gallop);
+                
+                ++min_gallop;
+                do {
+                    min_gallop -= min_gallop > 1;
+                    size_t k = gallop<true>(static_cast<size_t>(pa - a), [&](size_t i) { return cmp(pb[-1], a[i]); });
+                    wa = static_cast<size_t>(pa - a) - k;
+                    out = std::move_backward(a + k, pa, out);
+                    pa = a + k;
+                    if (pa == a) return;
+                    *--out = std::move(*--pb);
+                    if (pb == buf) return;
+                    
+                    k = gallop<true>(static_cast<size_t>(pb - buf), [&](size_t j) { return !cmp(buf[j], pa[-1]); });
+                    wb = static_cast<size_t>(pb - buf) - k;
+                    out = std::move_backward(buf + k, pb, out);
+                    pb = buf + k;
+                    if (pb == buf) return;
+                    *--out = std::move(*--pa);
+                    if (pa == a) return;
+                } while (wa >= MIN_GALLOP || wb >= MIN_GALLOP);
+                ++min_gallop;
+            }
+        }();
         
-        for (size_t t = 0; t < nt; ++t) {
-            size_t lo = t * chunk;
-            size_t hi = std::min(lo + chunk, n);
-            threads.emplace_back([&, t, lo, hi]() {
-                local_counts[t].zero();
-                for (size_t i = lo; i < hi; ++i) {
-                    ++local_counts[t][(Map::to_key(a[i]) >> SHIFT) & 0xFF];
+        std::move(buf, pb, a);
+        unstash(buf, nb);
+    }
+    
+    // 归并相邻游程a[0, na)与a[na, na+nb)。先用飞驰搜索剪掉两端已就位的部分，
+    // 首尾相接的游程 (有序块拼接的常见情形) 只花O(log n)次比较。
+    // 较短一侧超过暂存区容量cap时，按较长一侧的中点切开、二分找另一侧的切点，
+    // 旋转后拆成两个独立的小归并 (SymMerge式)，递归较小的一半，栈深O(log n)
+    template<bool Simd, typename T, typename Cmp>
+    void merge_adjacent(T* a, size_t na, size_t nb, T* buf, size_t cap, Cmp& cmp, size_t& min_gallop) {
+        while (na > 0 && nb > 0) {
+            T* b = a + na;
+            size_t k = gallop<false>(na, [&](size_t i) { return cmp(*b, a[i]); });
+            a += k;
+            na -= k;
+            if (na == 0) return;
+            nb = gallop<true>(nb, [&](size_t j) { return !cmp(b[j], a[na - 1]); });
+            if (nb == 0) return;
+            
+            if constexpr (Simd) {
+                merge_runs(a, na, b, nb, buf);
+                std::memcpy(a, buf, (na + nb) * sizeof(T));
+                return;
+            } else {
+                if (std::min(na, nb) <= cap) {
+                    if (na <= nb) merge_lo(a, na, nb, buf, cmp, min_gallop);
+                    else merge_hi(a, na, nb, buf, cmp, min_gallop);
+                    return;
                 }
-            });
+                
+                // A中切点之后的元素不小于切点，B中排到它前面的只能是严格更小的，等值元素次序不变
+                size_t ca, cb;
+                if (na >= nb) {
+                    ca = na / 2;
+                    cb = static_cast<size_t>(std::lower_bound(b, b + nb, a[ca], cmp) - b);
+                } else {
+                    cb = nb / 2;
+                    ca = static_cast<size_t>(std::upper_bound(a, b, b[cb], cmp) - a);
+                }
+                std::rotate(a + ca, b, b + cb);
+                
+                T* right = a + ca + cb;
+                size_t rna = na - ca, rnb = nb - cb;
+                if (ca + cb <= rna + rnb) {
+                    merge_adjacent<Simd>(a, ca, cb, buf, cap, cmp, min_gallop);
+                    a = right;
+                    na = rna;
+                    nb = rnb;
+                } else {
+                    merge_adjacent<Simd>(right, rna, rnb, buf, cap, cmp, min_gallop);
+                    na = ca;
+                    nb = cb;
+                }
+            }
         }
-        for (auto& th : threads) th.join();
-        threads.clear();
+    }
+    
+    // 识别自然游程 (过短的用插入补到最短长度)，按powersort的节点深度决定合并次序。
+    // Simd时buf容量为n；否则为cap (不超过n/2，可为0)
+    template<bool Simd, typename T, typename Cmp>
+    void natural_sort(T* a, size_t n, T* buf, size_t cap, Cmp& cmp) {
+        struct Run { size_t start, len; unsigned power; };
+        // 栈内边界深度严格递增且不超过64
+        Run stack[66];
+        size_t top = 0;
+        size_t min_gallop = MIN_GALLOP;
+        const size_t min_run = min_run_length(n);
+        
+        auto merge_top = [&]() {
+            Run& l = stack[top - 2];
+            merge_adjacent<Simd>(a + l.start, l.len, stack[top - 1].len, buf, cap, cmp, min_gallop);
+            l.len += stack[top - 1].len;
+            --top;
+        };
         
-        // 合并计数
-        alignas(64) size_t counts[NB + 1] = {};
-        for (size_t b = 0; b < NB; ++b) {
-            for (size_t t = 0; t < nt; ++t) {
-                counts[b] += local_counts[t][b];
+        for (size_t lo = 0; lo < n;) {
+            size_t len = find_run(a + lo, n - lo, cmp);
+            if (len < min_run) {
+                size_t force = std::min(min_run, n - lo);
+                // 整数键无所谓稳定，直接用网络排序补齐
+                if constexpr (Simd) insertion::sort(a + lo, force, cmp);
+                else stable_insertion(a + lo, len, force, cmp);
+                len = force;
             }
+            if (top > 0) {
+                unsigned power = node_power(stack[top - 1].start, stack[top - 1].len, len, n);
+                while (top > 1 && stack[top - 2].power > power) merge_top();
+                stack[top - 1].power = power;
+            }
+            stack[top++] = {lo, len, 0};
+            lo += len;
         }
-        
-        size_t sum = 0;
-        for (size_t b = 0; b < NB; ++b) {
-            size_t c = counts[b]; 
-            counts[b] = sum; 
-            sum += c;
+        while (top > 1) merge_top();
+    }
+    
+    // run_hint: 调用方已知的有序游程数 (0表示未知)。
+    // 暂存区受config::available_memory()约束，超出上限或分配失败时仍保持稳定
+    template<typename T, typename Cmp>
+    void sort(T* a, size_t n, Cmp& cmp, size_t run_hint = 0) {
+        if constexpr (simd_mergeable_v<T> && traits::is_default_less_v<T, Cmp>) {
+            if (n <= config::SMALL) { 
+                insertion::sort(a, n, cmp); 
+                return; 
+            }
+            // 整数键的等值元素不可区分，放不下整份缓冲时原地快排与稳定排序结果相同
+            mem::Buffer<T> buf(n * sizeof(T) <= config::available_memory() ? n : 0);
+            if (!buf) { 
+                pdq::sort(a, n, cmp); 
+                return; 
+            }
+            // 游程数用SIMD整段扫描得到，只占一次内存遍历
+            size_t runs = run_hint ? run_hint : adaptive::count_runs<false>(a, n, cmp);
+            if (runs <= n / NATURAL_RUN_MIN) natural_sort<true>(a, n, buf.data(), n, cmp);
+            else sort_integral(a, n, buf.data());
+        } else {
+            // 比较器排序总是按自然游程走，游程数只用来在两种整数归并间取舍
+            (void)run_hint;
+            // insertion::sort的网络与选最小值交换都不稳定，小数组也用稳定插入
+            if (n <= config::SMALL) {
+                stable_insertion(a, find_run(a, n, cmp), n, cmp);
+                return;
+            }
+            // 理想暂存区为n/2，按内存上限封顶；分配失败再退到√n，最后退到无缓冲的旋转归并
+            size_t cap = std::min(n / 2, config::available_memory() / sizeof(T));
+            mem::Buffer<T> buf(cap);
+            if (!buf && cap > 0) {
+                cap = std::min(cap, static_cast<size_t>(std::sqrt(static_cast<double>(n))));
+                buf = mem::Buffer<T>(cap);
+            }
+            if (!buf) cap = 0;
+            natural_sort<false>(a, n, buf.data(), cap, cmp);
         }
-        counts[NB] = sum;
-        
-        // 分配缓冲区
-        mem::Buffer<T> buf(n);
-        if (!buf) { 
-            radix::sort(a, n); 
-            return; 
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十五部分: 并行超采样排序实现 (修复版)
+// ═══════════════════════════════════════════════════════════════════════════
+
+#if FYX_ENABLE_PARALLEL
+namespace parallel {
+    template<typename T, typename Cmp>
+    void parallel_supersample(T* a, size_t n, Cmp cmp, const Options& opts) {
+        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+        if (n < opts.parallel_threshold * 2 || nt <= 1) {
+            pdq::sort(a, n, cmp);
+            return;
         }
         
-        // 计算每个线程的偏移
-        std::vector<mem::AlignedArray<size_t, NB>> offsets(nt);
-        for (size_t b = 0; b < NB; ++b) {
-            size_t off = counts[b];
-            for (size_t t = 0; t < nt; ++t) {
-                offsets[t][b] = off;
-                off += local_counts[t][b];
-            }
-        }
+        nt = std::min(nt, config::MAX_BUCKETS);
         
-        // 第二阶段：并行分发
-        for (size_t t = 0; t < nt; ++t) {
-            size_t lo = t * chunk;
-            size_t hi = std::min(lo + chunk, n);
-            threads.emplace_back([&, t, lo, hi]() {
-                for (size_t i = lo; i < hi; ++i) {
-                    size_t b = (Map::to_key(a[i]) >> SHIFT) & 0xFF;
-                    buf[offsets[t][b]++] = a[i];
-                }
-            });
-        }
-        for (auto& th : threads) th.join();
-        threads.clear();
+        std::vector<size_t> bucket_starts, bucket_sizes;
+        supersample::partition(a, n, nt, cmp, bucket_starts, bucket_sizes);
         
-        // 第三阶段：工作窃取并行递归排序
-        std::vector<LockFreeWorkStealQueue> queues(nt);
-        std::atomic<bool> done{false};
-        std::atomic<size_t> active_workers{0};
+        // 修复：处理空桶和边界情况
+        if (bucket_sizes.empty()) {
+            pdq::sort(a, n, cmp);
+            return;
+        }
         
-        // 初始化工作项
-        size_t total_work = 0;
-        for (size_t b = 0; b < NB; ++b) {
-            size_t start = counts[b];
-            size_t len = counts[b+1] - start;
-            if (len > 1) {
-                WorkItem item;
-                item.data = buf.data();
-                item.start = start;
-                item.length = len;
-                item.depth = 0;
-                queues[b % nt].push(item);
-                ++total_work;
-            }
+        // 计算有效桶数
+        size_t valid_buckets = 0;
+        for (size_t sz : bucket_sizes) {
+            if (sz > 0) ++valid_buckets;
         }
         
-        if (total_work == 0) {
-            std::memcpy(a, buf.data(), n * sizeof(T));
-            return;
+        if (valid_buckets == 0) {
+            return; // 数据已排序
         }
         
-        // 工作线程
-        auto worker = [&](size_t tid) {
-            active_workers.fetch_add(1, std::memory_order_relaxed);
-            WorkItem item;
-            size_t steal_attempts = 0;
-            
-            while (!done.load(std::memory_order_relaxed)) {
-                // 先尝试从自己的队列弹出
-                if (queues[tid].pop(item)) {
-                    steal_attempts = 0;
-                    T* data = static_cast<T*>(item.data);
-                    
-                    if (item.length > config::WORK_STEAL_THRESHOLD && item.depth < 3) {
-                        size_t mid = item.length / 2;
-                        WorkItem right;
-                        right.data = data;
-                        right.start = item.start + mid;
-                        right.length = item.length - mid;
-                        right.depth = item.depth + 1;
-                        queues[tid].push(right);
-                        radix::sort(data + item.start, mid);
-                    } else {
-                        radix::sort(data + item.start, item.length);
-                    }
-                    continue;
-                }
-                
-                // 尝试从其他线程窃取
-                bool stolen = false;
-                for (size_t i = 1; i <= nt && !stolen; ++i) {
-                    size_t victim = (tid + i) % nt;
-                    if (queues[victim].steal(item)) {
-                        stolen = true;
-                        steal_attempts = 0;
-                        T* data = static_cast<T*>(item.data);
-                        radix::sort(data + item.start, item.length);
-                    }
-                }
-                
-                if (!stolen) {
-                    ++steal_attempts;
-                    if (steal_attempts > config::MAX_STEAL_ATTEMPTS) {
-                        bool all_empty = true;
-                        for (size_t i = 0; i < nt; ++i) {
-                            if (!queues[i].empty()) {
-                                all_empty = false;
-                                break;
-                            }
-                        }
-                        if (all_empty) {
-                            break;
-                        }
-                        steal_attempts = 0;
-                    }
-                    std::this_thread::yield();
+        // 动态调整线程数
+        size_t actual_threads = std::min(nt, valid_buckets);
+        actual_threads = std::max(actual_threads, size_t(1));
+        
+        std::vector<std::thread> threads;
+        threads.reserve(actual_threads);
+        
+        std::atomic<size_t> next_bucket{0};
+        
+        auto worker = [&]() {
+            while (true) {
+                size_t b = next_bucket.fetch_add(1, std::memory_order_relaxed);
+                if (b >= bucket_sizes.size()) break;
+                
+                size_t start = bucket_starts[b];
+                size_t len = bucket_sizes[b];
+                
+                if (len > 1) {
+                    pdq::sort(a + start, len, cmp);
                 }
             }
-            
-            if (active_workers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-                done.store(true, std::memory_order_release);
-            }
         };
         
-        for (size_t t = 0; t < nt; ++t) {
-            threads.emplace_back(worker, t);
+        for (size_t t = 0; t < actual_threads; ++t) {
+            threads.emplace_back(worker);
         }
-        for (auto& th : threads) th.join();
         
-        std::memcpy(a, buf.data(), n * sizeof(T));
+        for (auto& th : threads) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
     }
-    
-    // 并行超采样排序
-    template<typename T, typename Cmp>
-    void parallel_supersample(T* a, size_t n, Cmp cmp, const Options& opts);
-    
 } // namespace parallel
 #endif // FYX_ENABLE_PARALLEL
 
 // ═══════════════════════════════════════════════════════════════════════════
-// 第二十一部分: 数据分布学习与自适应选择 (修复版)
+// 第二十六部分: 间接排序
 // ═══════════════════════════════════════════════════════════════════════════
 
-namespace adaptive {
-    struct DataProfile {
-        bool is_sorted = false;
-        bool is_reverse = false;
-        bool is_nearly_sorted = false;
-        bool has_many_duplicates = false;
-        bool is_small_range = false;
-        double entropy = 0.0;
-        size_t unique_estimate = 0;
-        size_t run_count = 0;
-    };
+namespace indirect {
+    template<typename T, typename Cmp>
+    void sort(T* a, size_t n, Cmp& cmp) {
+        std::vector<size_t> idx(n);
+        std::iota(idx.begin(), idx.end(), size_t(0));
+        
+        pdq::sort(idx.data(), idx.size(), 
+            [&](size_t i, size_t j) { return cmp(a[i], a[j]); });
+        
+        std::vector<bool> done(n, false);
+        for (size_t i = 0; i < n; ++i) {
+            if (done[i] || idx[i] == i) continue;
+            T tmp = std::move(a[i]);
+            size_t j = i;
+            while (idx[j] != i) {
+                a[j] = std::move(a[idx[j]]);
+                done[j] = true;
+                j = idx[j];
+            }
+            a[j] = std::move(tmp);
+            done[j] = true;
+        }
+    }
     
     template<typename T, typename Cmp>
-    DataProfile analyze(const T* a, size_t n, Cmp& cmp) {
-        DataProfile profile;
-        if (n <= 1) {
-            profile.is_sorted = true;
-            return profile;
+    void stable_sort(T* a, size_t n, Cmp& cmp) {
+        std::vector<size_t> idx(n);
+        std::iota(idx.begin(), idx.end(), size_t(0));
+        
+        std::stable_sort(idx.begin(), idx.end(), 
+            [&](size_t i, size_t j) { return cmp(a[i], a[j]); });
+        
+        std::vector<bool> done(n, false);
+        for (size_t i = 0; i < n; ++i) {
+            if (done[i] || idx[i] == i) continue;
+            T tmp = std::move(a[i]);
+            size_t j = i;
+            while (idx[j] != i) {
+                a[j] = std::move(a[idx[j]]);
+                done[j] = true;
+                j = idx[j];
+            }
+            a[j] = std::move(tmp);
+            done[j] = true;
         }
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第二十七部分: 迭代器适配器
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace iter_adapter {
+    template<typename It, typename Cmp>
+    void sort_non_contiguous(It first, It last, Cmp cmp) {
+        using T = iter_traits::value_type_t<It>;
+        auto n = std::distance(first, last);
+        if (n < 2) return;
         
-        // 采样分析
-        size_t sample_size = std::min(n - 1, size_t(256));
-        size_t step = (n > sample_size) ? ((n - 1) / sample_size) : 1;
-        if (step == 0) step = 1;  // 修复：防止除零
+        std::vector<T> tmp(first, last);
         
-        size_t asc = 0, desc = 0, eq = 0;
-        size_t runs = 1;
-        bool last_asc = true;
+        if constexpr (traits::is_radix_sortable_v<T> && traits::is_default_less_v<T, Cmp>) {
+            radix::sort(tmp.data(), static_cast<size_t>(n));
+        } else {
+            pdq::sort(tmp.data(), static_cast<size_t>(n), cmp);
+        }
         
-        alignas(64) size_t bucket_counts[16] = {};
+        std::copy(tmp.begin(), tmp.end(), first);
+    }
+    
+    template<typename It, typename Cmp>
+    void stable_sort_non_contiguous(It first, It last, Cmp cmp) {
+        using T = iter_traits::value_type_t<It>;
+        auto n = std::distance(first, last);
+        if (n < 2) return;
         
-        size_t actual_samples = 0;
-        for (size_t i = 0; i < sample_size && i * step + 1 < n; ++i) {
-            size_t idx = i * step;
-            ++actual_samples;
-            
-            if (cmp(a[idx + 1], a[idx])) {
-                ++desc;
-                if (last_asc) { ++runs; last_asc = false; }
-            } else if (cmp(a[idx], a[idx + 1])) {
-                ++asc;
-                if (!last_asc) { ++runs; last_asc = true; }
-            } else {
-                ++eq;
+        std::vector<T> tmp(first, last);
+        merge::sort(tmp.data(), static_cast<size_t>(n), cmp);
+        std::copy(tmp.begin(), tmp.end(), first);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第三十部分: 排名与逆置换 (排序副产品)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace ranking {
+    enum class Method {
+        Ordinal,   // 1,2,3,4 - 相等元素按原下标先后
+        Min,       // 1,2,2,4 - 相等元素取最小名次
+        Dense      // 1,2,2,3 - 相等元素同名次且名次连续
+    };
+
+    // 键+原下标，基数排序时整体搬运
+    template<typename Key, typename Idx>
+    struct KeyIndex {
+        Key key;
+        Idx idx;
+    };
+
+    // 对(键,下标)对做LSD基数排序，结果留在pairs中（稳定）
+    template<typename Key, typename Idx>
+    FYX_NOINLINE bool lsd_pairs(KeyIndex<Key, Idx>* pairs, size_t n) {
+        using P = KeyIndex<Key, Idx>;
+        constexpr size_t NB = 256;
+        constexpr size_t NUM_PASSES = sizeof(Key);
+
+        mem::Buffer<P> buffer(n);
+        if (!buffer) return false;
+
+        P* src = pairs;
+        P* dst = buffer.data();
+
+        alignas(64) size_t count[NB];
+
+        for (size_t pass = 0; pass < NUM_PASSES; ++pass) {
+            int shift = static_cast<int>(pass * 8);
+            std::memset(count, 0, sizeof(count));
+
+            for (size_t i = 0; i < n; ++i) {
+                ++count[(src[i].key >> shift) & 0xFF];
             }
-            
-            if constexpr (std::is_integral_v<T>) {
-                size_t hash_val;
-                if constexpr (sizeof(T) <= sizeof(size_t)) {
-                    hash_val = static_cast<size_t>(a[idx]) * 2654435761ULL;
-                } else {
-                    hash_val = static_cast<size_t>(a[idx] >> 32) ^ static_cast<size_t>(a[idx]);
+
+            // 单桶的轮次直接跳过
+            if (count[(src[0].key >> shift) & 0xFF] == n) continue;
+
+            size_t sum = 0;
+            for (size_t b = 0; b < NB; ++b) {
+                size_t c = count[b];
+                count[b] = sum;
+                sum += c;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                if (i + 16 < n) FYX_PREFETCH_T0(&src[i + 16]);
+                size_t b = (src[i].key >> shift) & 0xFF;
+                dst[count[b]++] = src[i];
+            }
+
+            P* tmp = src; src = dst; dst = tmp;
+        }
+
+        if (src != pairs) {
+            std::memcpy(pairs, src, n * sizeof(P));
+        }
+        return true;
+    }
+
+    // 顺序扫描已排序序列，同一遍写出置换idx与名次rank（避免二次随机写）
+    // get_idx(pos) 返回第pos个元素的原下标，same(pos) 判断pos与pos-1是否相等
+    template<typename GetIdx, typename Same>
+    FYX_INLINE void emit(size_t n, Method method, GetIdx get_idx, Same same,
+                         size_t* FYX_RESTRICT idx_out, size_t* FYX_RESTRICT rank_out) {
+        size_t run_rank = 0;
+        size_t dense = 0;
+        for (size_t pos = 0; pos < n; ++pos) {
+            size_t orig = get_idx(pos);
+            size_t r = pos;
+            if (method != Method::Ordinal) {
+                if (pos > 0 && !same(pos)) {
+                    run_rank = pos;
+                    ++dense;
                 }
-                ++bucket_counts[hash_val & 0xF];
+                r = (method == Method::Min) ? run_rank : dense;
             }
+            if (idx_out) idx_out[pos] = orig;
+            rank_out[orig] = r;
         }
-        
-        if (actual_samples == 0) {
-            profile.is_sorted = true;
-            return profile;
+    }
+
+    template<typename T, typename Idx, typename Container>
+    bool radix_rank(const Container& c, size_t n, Method method,
+                    size_t* idx_out, size_t* rank_out) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+        using P = KeyIndex<Key, Idx>;
+
+        mem::Buffer<P> pairs(n);
+        if (!pairs) return false;
+
+        for (size_t i = 0; i < n; ++i) {
+            T v = c[i];
+            // -0.0与+0.0比较相等，映射前统一成+0.0，否则名次会按键位模式把它们分开
+            if constexpr (std::is_floating_point_v<T>) {
+                if (v == T(0)) v = T(0);
+            }
+            pairs[i].key = Map::to_key(v);
+            pairs[i].idx = static_cast<Idx>(i);
         }
-        
-        profile.run_count = runs;
-        
-        // 判断排序状态
-        if (asc == actual_samples) {
-            profile.is_sorted = true;
-            // 完整验证
-            for (size_t i = 1; i < n; ++i) {
-                if (cmp(a[i], a[i-1])) { 
-                    profile.is_sorted = false; 
-                    break; 
+
+        if (!lsd_pairs(pairs.data(), n)) return false;
+
+        const P* p = pairs.data();
+        emit(n, method,
+             [p](size_t pos) { return static_cast<size_t>(p[pos].idx); },
+             [p](size_t pos) { return p[pos].key == p[pos - 1].key; },
+             idx_out, rank_out);
+        return true;
+    }
+
+    template<typename Container, typename Cmp>
+    void compute(const Container& c, Cmp cmp, Method method,
+                 size_t* idx_out, size_t* rank_out) {
+        using T = std::decay_t<decltype(c[0])>;
+        size_t n = c.size();
+        if (n == 0) return;
+
+        if constexpr (traits::is_radix_sortable_v<T> && traits::is_default_less_v<T, Cmp>) {
+            if (n >= config::SMALL) {
+                bool ok = (n <= UINT32_MAX)
+                    ? radix_rank<T, uint32_t>(c, n, method, idx_out, rank_out)
+                    : radix_rank<T, size_t>(c, n, method, idx_out, rank_out);
+                if (ok) return;
+            }
+        }
+
+        // 通用路径：带下标决胜的比较排序，保证Ordinal名次稳定
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), size_t(0));
+        pdq::sort(order.data(), n, [&](size_t i, size_t j) {
+            if (cmp(c[i], c[j])) return true;
+            if (cmp(c[j], c[i])) return false;
+            return i < j;
+        });
+
+        const size_t* o = order.data();
+        emit(n, method,
+             [o](size_t pos) { return o[pos]; },
+             [&](size_t pos) { return !cmp(c[o[pos - 1]], c[o[pos]]); },
+             idx_out, rank_out);
+    }
+} // namespace ranking
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第三十一部分: 分段排序 (CSR风格的大量小数组)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace segmented {
+    // 按段长分级，同级的段集中处理，内层循环走同一条内核
+    enum SizeClass : uint8_t {
+        Trivial = 0,   // 0-1个元素
+        Network,       // <= NETWORK_SORT_LIMIT: 排序网络/SIMD网络
+        Medium,        // <= L1阈值: 直接pdq，跳过自适应分析
+        Large,         // 更大: 基数排序或pdq
+        NUM_CLASSES
+    };
+
+    FYX_INLINE SizeClass classify(size_t len) noexcept {
+        if (len <= 1) return Trivial;
+        if (len <= config::NETWORK_SORT_LIMIT) return Network;
+        if (len <= config::HIERARCHICAL_L1_THRESHOLD) return Medium;
+        return Large;
+    }
+
+    template<typename T, typename Cmp>
+    FYX_INLINE void sort_one(T* a, size_t len, SizeClass cls, Cmp& cmp, bool stable) {
+        // insertion::sort走排序网络/选最小值交换，不稳定；merge::sort对小段用稳定插入
+        if (stable) {
+            merge::sort(a, len, cmp);
+            return;
+        }
+        switch (cls) {
+            case Network:
+                sortnet::small_sort(a, len, cmp);
+                return;
+            case Medium:
+                pdq::sort(a, len, cmp);
+                return;
+            case Large:
+                if constexpr (traits::is_radix_sortable_v<T> && traits::is_default_less_v<T, Cmp>) {
+                    radix::sort(a, len);
+                } else {
+                    pdq::sort(a, len, cmp);
+                }
+                return;
+            default:
+                return;
+        }
+    }
+
+    // offsets[0..num_segments]，第s段为 [offsets[s], offsets[s+1])
+    template<typename T, typename Off, typename Cmp>
+    void sort(T* data, const Off* offsets, size_t num_segments, Cmp cmp, const Options& opts) {
+        if (num_segments == 0) return;
+
+        // 第一遍：按段长分级（对段号做计数排序）
+        size_t class_count[NUM_CLASSES + 1] = {};
+        size_t class_elems[NUM_CLASSES] = {};
+        for (size_t s = 0; s < num_segments; ++s) {
+            size_t len = static_cast<size_t>(offsets[s + 1] - offsets[s]);
+            SizeClass cls = classify(len);
+            ++class_count[cls + 1];
+            class_elems[cls] += len;
+        }
+
+        size_t work = class_elems[Network] + class_elems[Medium] + class_elems[Large];
+        if (work == 0) return;
+
+        for (size_t c = 0; c < NUM_CLASSES; ++c) {
+            class_count[c + 1] += class_count[c];
+        }
+
+        size_t active = num_segments - (class_count[Trivial + 1] - class_count[Trivial]);
+        std::vector<size_t> order(active);
+        size_t pos[NUM_CLASSES];
+        for (size_t c = 0; c < NUM_CLASSES; ++c) {
+            pos[c] = class_count[c] - class_count[Trivial + 1];
+        }
+        for (size_t s = 0; s < num_segments; ++s) {
+            size_t len = static_cast<size_t>(offsets[s + 1] - offsets[s]);
+            SizeClass cls = classify(len);
+            if (cls != Trivial) order[pos[cls]++] = s;
+        }
+
+        auto run_range = [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                size_t s = order[i];
+                if (i + 4 < hi) FYX_PREFETCH_T0(data + offsets[order[i + 4]]);
+                size_t start = static_cast<size_t>(offsets[s]);
+                size_t len = static_cast<size_t>(offsets[s + 1]) - start;
+                sort_one(data + start, len, classify(len), cmp, opts.stable);
+            }
+        };
+
+#if FYX_ENABLE_PARALLEL
+        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+        if (opts.parallel && nt > 1 && work >= opts.parallel_threshold * 2) {
+            // 切成元素数大致相等的任务块，线程按原子计数领取
+            std::vector<size_t> chunk_starts;
+            chunk_starts.push_back(0);
+            size_t target = std::max(work / (nt * 8), config::MIN_PARALLEL_BLOCK);
+            size_t acc = 0;
+            for (size_t i = 0; i < active; ++i) {
+                size_t s = order[i];
+                acc += static_cast<size_t>(offsets[s + 1] - offsets[s]);
+                if (acc >= target) {
+                    chunk_starts.push_back(i + 1);
+                    acc = 0;
                 }
             }
-        } else if (desc == actual_samples) {
-            profile.is_reverse = true;
-            for (size_t i = 1; i < n; ++i) {
-                if (cmp(a[i-1], a[i])) { 
-                    profile.is_reverse = false; 
-                    break; 
+            if (chunk_starts.back() != active) chunk_starts.push_back(active);
+
+            size_t num_chunks = chunk_starts.size() - 1;
+            size_t actual_threads = std::min(nt, num_chunks);
+            if (actual_threads > 1) {
+                std::atomic<size_t> next_chunk{0};
+                auto worker = [&]() {
+                    while (true) {
+                        size_t c = next_chunk.fetch_add(1, std::memory_order_relaxed);
+                        if (c >= num_chunks) break;
+                        run_range(chunk_starts[c], chunk_starts[c + 1]);
+                    }
+                };
+
+                std::vector<std::thread> threads;
+                threads.reserve(actual_threads);
+                for (size_t t = 0; t < actual_threads; ++t) {
+                    threads.emplace_back(worker);
                 }
+                for (auto& th : threads) th.join();
+                return;
             }
         }
-        
-        profile.is_nearly_sorted = (asc > actual_samples * 9 / 10) || 
-                                    (desc > actual_samples * 9 / 10);
-        profile.has_many_duplicates = eq > actual_samples / 4;
-        
-        // 计算熵
-        if constexpr (std::is_integral_v<T>) {
-            double total = static_cast<double>(actual_samples);
-            for (size_t i = 0; i < 16; ++i) {
-                if (bucket_counts[i] > 0) {
-                    double p = bucket_counts[i] / total;
-                    profile.entropy -= p * std::log2(p);
-                }
+#endif
+        run_range(0, active);
+    }
+} // namespace segmented
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第三十二部分: 选择算法 (基数选择 / 采样选择)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace selection {
+    // 数字直方图；大区间按线程切块并行计数后合并
+    template<typename T>
+    void digit_histogram(const T* a, size_t n, size_t* counts, int shift, const Options& opts) {
+        std::memset(counts, 0, config::NUM_BUCKETS * sizeof(size_t));
+#if FYX_ENABLE_PARALLEL
+        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+        if (!opts.parallel || n < opts.parallel_threshold * 2) nt = 1;
+        // 阈值调低时(子)区间可能不足两块，此时退回顺序计数
+        nt = std::min(nt, n / config::MIN_PARALLEL_BLOCK);
+        if (nt > 1) {
+            std::vector<mem::AlignedArray<size_t, config::NUM_BUCKETS>> local(nt);
+            std::vector<std::thread> threads;
+            threads.reserve(nt);
+            size_t chunk = (n + nt - 1) / nt;
+            for (size_t t = 0; t < nt; ++t) {
+                size_t lo = t * chunk;
+                size_t hi = std::min(lo + chunk, n);
+                threads.emplace_back([&, t, lo, hi]() {
+                    local[t].zero();
+                    if (lo < hi) simd::histogram(a + lo, hi - lo, local[t].data, shift);
+                });
             }
-            
-            size_t non_empty_buckets = 0;
-            for (size_t i = 0; i < 16; ++i) {
-                if (bucket_counts[i] > 0) ++non_empty_buckets;
+            for (auto& th : threads) th.join();
+            for (size_t t = 0; t < nt; ++t) {
+                for (size_t b = 0; b < config::NUM_BUCKETS; ++b) counts[b] += local[t][b];
             }
-            profile.unique_estimate = non_empty_buckets * n / 16;
+            return;
         }
-        
-        // 检查是否小范围
-        if constexpr (std::is_integral_v<T>) {
-            size_t check_size = std::min(n, size_t(1000));
-            auto [mn, mx] = simd::find_minmax(a, check_size);
-            
-            // 安全计算范围
-            uint64_t range;
-            if constexpr (std::is_signed_v<T>) {
-                if (mx >= mn) {
-                    range = static_cast<uint64_t>(static_cast<int64_t>(mx) - static_cast<int64_t>(mn));
+#else
+        (void)opts;
+#endif
+        simd::histogram(a, n, counts, shift);
+    }
+
+    // MSD基数选择: 逐位直方图，只下降到包含第k名的桶
+    // 结果满足nth_element语义: a[k]就位，左侧<=a[k]，右侧>=a[k]
+    template<typename T>
+    void radix_select(T* a, size_t n, size_t k, const Options& opts = Options::sequential()) {
+        using Map = keymap::Mapper<T>;
+        using Key = typename Map::Key;
+
+        size_t lo = 0, hi = n;
+        int shift = static_cast<int>(sizeof(Key) * 8 - 8);
+        alignas(64) size_t counts[config::NUM_BUCKETS];
+
+        while (hi - lo > config::SELECT_CUTOFF && shift >= 0) {
+            size_t len = hi - lo;
+            digit_histogram(a + lo, len, counts, shift, opts);
+
+            size_t r = k - lo;
+            size_t before = 0, b = 0;
+            while (before + counts[b] <= r) before += counts[b++];
+
+            if (counts[b] == len) {
+                shift -= 8;
+                continue;
+            }
+
+            // 三路划分: 数字<b | ==b | >b (更高位在区间内都相同)
+            T* lt = a + lo;
+            T* i = a + lo;
+            T* gt = a + hi;
+            while (i < gt) {
+                size_t d = (Map::to_key(*i) >> shift) & 0xFF;
+                if (d < b) {
+                    ops::swap(*lt++, *i++);
+                } else if (d > b) {
+                    ops::swap(*i, *--gt);
                 } else {
-                    range = UINT64_MAX;
+                    ++i;
                 }
-            } else {
-                range = static_cast<uint64_t>(mx) - static_cast<uint64_t>(mn);
             }
-            profile.is_small_range = range < static_cast<uint64_t>(n) * config::COUNTING_SORT_RATIO;
+
+            lo += before;
+            hi = lo + counts[b];
+            shift -= 8;
+        }
+
+        // 所有数字都已相同时区间内元素全部相等
+        if (shift >= 0 && hi - lo > 1) {
+            std::nth_element(a + lo, a + k, a + hi);
         }
-        
-        return profile;
     }
-    
-    enum class Algorithm {
-        InsertionSort,
-        HeapSort,
-        PDQSort,
-        MergeSort,
-        RadixSort,
-        CountingSort,
-        AmericanFlagSort
-    };
-    
+
+    // 采样选择 (Floyd-Rivest思路): 从有序样本中取夹住第k名的两个枢纽
     template<typename T, typename Cmp>
-    Algorithm select_algorithm(size_t n, const DataProfile& profile, const Options& opts) {
-        if (n <= config::INSERTION_LIMIT) {
-            return Algorithm::InsertionSort;
-        }
-        
-        if (opts.force_radix && traits::is_radix_sortable_v<T>) {
-            return Algorithm::RadixSort;
-        }
-        if (opts.force_comparison) {
-            return Algorithm::PDQSort;
-        }
-        if (opts.stable) {
-            return Algorithm::MergeSort;
-        }
-        
-        if constexpr (traits::is_radix_sortable_v<T>) {
-            if constexpr (traits::is_default_less_v<T, Cmp>) {
-                if (profile.is_small_range && n >= config::COUNTING_MIN_SIZE) {
-                    return Algorithm::CountingSort;
-                }
-                if (n >= 10000) {
-                    return Algorithm::RadixSort;
+    void sample_select(T* a, size_t n, size_t k, Cmp& cmp) {
+        size_t lo = 0, hi = n;
+        std::vector<T> sample;
+
+        while (hi - lo > config::SELECT_CUTOFF * 8) {
+            size_t len = hi - lo;
+            size_t s = static_cast<size_t>(std::sqrt(static_cast<double>(len))) * 2;
+            s = std::min(s, size_t(8192));
+
+            sample.clear();
+            sample.reserve(s);
+            size_t step = len / s;
+            for (size_t j = 0; j < s; ++j) sample.push_back(a[lo + j * step]);
+            pdq::sort(sample.data(), s, cmp);
+
+            size_t pos = (k - lo) * s / len;
+            size_t gap = static_cast<size_t>(std::sqrt(static_cast<double>(s))) + 1;
+            T p1 = sample[pos > gap ? pos - gap : 0];
+            T p2 = sample[std::min(pos + gap, s - 1)];
+
+            // 双枢纽划分: <p1 | [p1,p2] | >p2
+            T* lt = a + lo;
+            T* i = a + lo;
+            T* gt = a + hi;
+            while (i < gt) {
+                if (cmp(*i, p1)) {
+                    ops::swap(*lt++, *i++);
+                } else if (cmp(p2, *i)) {
+                    ops::swap(*i, *--gt);
+                } else {
+                    ++i;
                 }
             }
+
+            size_t l = static_cast<size_t>(lt - a);
+            size_t g = static_cast<size_t>(gt - a);
+            if (k < l) {
+                hi = l;
+            } else if (k >= g) {
+                lo = g;
+            } else {
+                // p1与p2等价时中段全部相等
+                if (!cmp(p1, p2)) return;
+                lo = l;
+                hi = g;
+            }
+
+            // 划分效果太差（样本不具代表性）时交给std
+            if (hi - lo > len - len / 4) break;
         }
-        
-        if (profile.is_nearly_sorted && profile.run_count < n / 32) {
-            return Algorithm::InsertionSort;
+
+        std::nth_element(a + lo, a + k, a + hi, cmp);
+    }
+
+    template<typename T, typename Cmp>
+    void select(T* a, size_t n, size_t k, Cmp& cmp, const Options& opts) {
+        if (n < 2 || k >= n) return;
+        // 浮点键的高位字节是符号+指数，分布极不均匀，采样选择更稳
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                      traits::is_default_less_v<T, Cmp>) {
+            radix_select(a, n, k, opts);
+        } else {
+            (void)opts;
+            sample_select(a, n, k, cmp);
         }
-        
-        return Algorithm::PDQSort;
     }
-} // namespace adaptive
+
+    // 一次选出多个名次: ks升序，先定位中间名次，再分别递归进入两侧
+    template<typename T, typename Cmp>
+    void select_many(T* a, size_t lo, size_t hi, const size_t* ks, size_t m,
+                     Cmp& cmp, const Options& opts) {
+        while (m > 0 && hi - lo > 1) {
+            size_t mid = m / 2;
+            size_t k = ks[mid];
+            select(a + lo, hi - lo, k - lo, cmp, opts);
+            select_many(a, lo, k, ks, mid, cmp, opts);
+            lo = k + 1;
+            ks += mid + 1;
+            m -= mid + 1;
+        }
+    }
+} // namespace selection
 
 // ═══════════════════════════════════════════════════════════════════════════
-// 第二十二部分: 超标量采样分区
+// 第三十三部分: 融合排序去重
 // ═══════════════════════════════════════════════════════════════════════════
 
-namespace supersample {
+namespace dedup {
+    // 有序序列的游程压缩: 保留每组等价元素的第一个，freq非空时写入组大小
     template<typename T, typename Cmp>
-    struct Sampler {
-        static constexpr size_t OVERSAMPLING = config::OVERSAMPLING_FACTOR;
-        
-        static void sample(const T* data, size_t n, std::vector<T>& samples, 
-                          size_t num_buckets, Cmp& cmp) {
-            size_t num_samples = num_buckets * OVERSAMPLING;
-            samples.resize(num_samples);
-            
-            // 均匀采样
-            for (size_t i = 0; i < num_samples; ++i) {
-                size_t idx = (i * n) / num_samples;
-                samples[i] = data[idx];
-            }
-            
-            std::sort(samples.begin(), samples.end(), cmp);
-            
-            // 选择分位点作为枢纽
-            std::vector<T> pivots(num_buckets - 1);
-            for (size_t i = 0; i < num_buckets - 1; ++i) {
-                pivots[i] = samples[(i + 1) * OVERSAMPLING];
+    size_t unique_sorted(T* a, size_t n, size_t* freq, Cmp& cmp) {
+        if (n == 0) return 0;
+        size_t m = 0;
+        size_t run = 1;
+        for (size_t i = 1; i < n; ++i) {
+            if (cmp(a[m], a[i])) {
+                if (freq) freq[m] = run;
+                ++m;
+                if (m != i) a[m] = std::move(a[i]);
+                run = 1;
+            } else {
+                ++run;
             }
-            samples = std::move(pivots);
         }
-    };
+        if (freq) freq[m] = run;
+        return m + 1;
+    }
     
+    // 排序并去重，返回唯一值个数m (a[0..m)有序)
+    // 整数键: 计数排序直接从count[]输出，否则LSD基数排序在最后一轮散布时去重
     template<typename T, typename Cmp>
-    struct Classifier {
-        const std::vector<T>& pivots;
-        Cmp& cmp;
-        
-        Classifier(const std::vector<T>& p, Cmp& c) : pivots(p), cmp(c) {}
-        
-        FYX_INLINE size_t classify(const T& val) const noexcept {
-            // 对于小数量枢纽使用线性搜索（分支预测友好）
-            size_t num_pivots = pivots.size();
-            if (num_pivots <= 7) {
-                size_t b = 0;
-                while (b < num_pivots && !cmp(val, pivots[b])) ++b;
-                return b;
-            }
-            
-            // 二分搜索
-            size_t lo = 0, hi = num_pivots;
-            while (lo < hi) {
-                size_t mid = lo + (hi - lo) / 2;
-                if (cmp(pivots[mid], val)) lo = mid + 1;
-                else hi = mid;
+    size_t sort_unique(T* a, size_t n, size_t* freq, Cmp cmp, const Options& opts) {
+        if (n == 0) return 0;
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                      traits::is_default_less_v<T, Cmp>) {
+            bool par = false;
+#if FYX_ENABLE_PARALLEL
+            size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+            par = opts.parallel && nt > 1 && n >= opts.parallel_threshold * 2;
+#endif
+            // 并行排序比单线程融合路径更快
+            if (!par && n > config::SMALL) {
+                size_t m = 0;
+                if (counting::try_unique(a, n, freq, m)) return m;
+                if (radix::lsd_unique(a, n, freq, m)) return m;
             }
-            return lo;
         }
-        
-        void classify_batch(const T* data, size_t n, size_t* buckets) const noexcept {
-            for (size_t i = 0; i < n; ++i) {
-                buckets[i] = classify(data[i]);
+        Sorter<T>::sort(a, n, cmp, opts);
+        return unique_sorted(a, n, freq, cmp);
+    }
+} // namespace dedup
+
+// ═══════════════════════════════════════════════════════════════════════════
+// 第三十四部分: 字符串排序引擎 (MSD基数 + 多键快排)
+// ═══════════════════════════════════════════════════════════════════════════
+
+namespace strsort {
+    template<typename S>
+    inline constexpr bool is_cstring_v =
+        std::is_same_v<S, const char*> || std::is_same_v<S, char*>;
+    
+    template<typename S>
+    inline constexpr bool is_string_v =
+        std::is_same_v<S, std::string> || std::is_same_v<S, std::string_view> || is_cstring_v<S>;
+    
+    // 字符串引擎适用条件: string/string_view用默认比较，C字符串用CStringLess
+    template<typename S, typename Cmp>
+    inline constexpr bool use_engine_v =
+        (is_string_v<S> && !is_cstring_v<S> && traits::is_default_less_v<S, Cmp>) ||
+        (is_cstring_v<S> && std::is_same_v<std::decay_t<Cmp>, CStringLess>);
+    
+    // 第d个字符对应的桶: 0表示字符串已结束，其余为字节值+1
+    // 调用方保证前d个字符已比较过且相同，因此C字符串不会越过结尾
+    template<typename S>
+    FYX_INLINE unsigned char_at(const S& s, size_t d) noexcept {
+        if constexpr (is_cstring_v<S>) {
+            unsigned c = static_cast<unsigned char>(s[d]);
+            return c ? c + 1 : 0;
+        } else {
+            return d < s.size() ? static_cast<unsigned char>(s[d]) + 1u : 0u;
+        }
+    }
+    
+    // 从第d个字符开始比较
+    template<typename S>
+    FYX_INLINE bool less_from(const S& a, const S& b, size_t d) noexcept {
+        if constexpr (is_cstring_v<S>) {
+            return std::strcmp(a + d, b + d) < 0;
+        } else {
+            size_t la = a.size() - d;
+            size_t lb = b.size() - d;
+            int r = std::memcmp(a.data() + d, b.data() + d, la < lb ? la : lb);
+            return r < 0 || (r == 0 && la < lb);
+        }
+    }
+    
+    template<typename S>
+    void insertion_from(S* a, size_t n, size_t d) {
+        for (size_t i = 1; i < n; ++i) {
+            if (!less_from(a[i], a[i - 1], d)) continue;
+            S tmp = std::move(a[i]);
+            size_t j = i;
+            do {
+                a[j] = std::move(a[j - 1]);
+                --j;
+            } while (j > 0 && less_from(tmp, a[j - 1], d));
+            a[j] = std::move(tmp);
+        }
+    }
+    
+    // a[0..n)从第d个字符起的公共前缀长度
+    template<typename S>
+    size_t common_prefix(const S* a, size_t n, size_t d) noexcept {
+        if constexpr (is_cstring_v<S>) {
+            size_t l = std::strlen(a[0] + d);
+            for (size_t i = 1; i < n && l > 0; ++i) {
+                size_t j = 0;
+                while (j < l && a[i][d + j] == a[0][d + j]) ++j;
+                l = j;
             }
+            return l;
+        } else {
+            if (a[0].size() <= d) return 0;
+            size_t l = a[0].size() - d;
+            for (size_t i = 1; i < n && l > 0; ++i) {
+                if (a[i].size() <= d) return 0;
+                size_t m = std::min(l, a[i].size() - d);
+                const char* p = a[0].data() + d;
+                const char* q = a[i].data() + d;
+                size_t j = 0;
+                while (j < m && p[j] == q[j]) ++j;
+                l = j;
+            }
+            return l;
         }
+    }
+    
+    struct Task {
+        size_t lo;
+        size_t n;
+        size_t d;
     };
     
-    template<typename T, typename Cmp>
-    void partition(T* data, size_t n, size_t num_buckets, Cmp& cmp,
-                   std::vector<size_t>& bucket_starts, 
-                   std::vector<size_t>& bucket_sizes) {
-        
-        num_buckets = std::min(num_buckets, config::MAX_BUCKETS);
-        
-        if (num_buckets < 2) {
-            bucket_starts = {0};
-            bucket_sizes = {n};
-            return;
+    // 多键快排一步 (Bentley-Sedgewick): 按第d个字符三路划分，相等段进入下一个字符
+    template<typename S>
+    void mkqs_step(S* a, const Task& t, std::vector<Task>& stack) {
+        S* s = a + t.lo;
+        size_t n = t.n;
+        unsigned c0 = char_at(s[0], t.d);
+        unsigned c1 = char_at(s[n / 2], t.d);
+        unsigned c2 = char_at(s[n - 1], t.d);
+        unsigned pivot = std::max(std::min(c0, c1), std::min(std::max(c0, c1), c2));
+        
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt) {
+            unsigned c = char_at(s[i], t.d);
+            if (c < pivot) {
+                ops::swap(s[lt++], s[i++]);
+            } else if (c > pivot) {
+                ops::swap(s[i], s[--gt]);
+            } else {
+                ++i;
+            }
         }
         
-        std::vector<T> pivots;
-        Sampler<T, Cmp>::sample(data, n, pivots, num_buckets, cmp);
-        
-        Classifier<T, Cmp> classifier(pivots, cmp);
+        if (lt > 1) stack.push_back({t.lo, lt, t.d});
+        if (n - gt > 1) stack.push_back({t.lo + gt, n - gt, t.d});
+        if (pivot != 0 && gt - lt > 1) stack.push_back({t.lo + lt, gt - lt, t.d + 1});
+    }
+    
+    // MSD一步: 缓存第d个字符后用American Flag原地分发到257个桶
+    template<typename S>
+    void msd_step(S* a, uint16_t* oracle, const Task& t, std::vector<Task>& stack) {
+        constexpr size_t NB = 257;
+        S* s = a + t.lo;
+        uint16_t* ch = oracle + t.lo;
+        size_t n = t.n;
         
-        bucket_sizes.resize(num_buckets, 0);
+        size_t count[NB] = {};
+        for (size_t i = 0; i < n; ++i) {
+            ch[i] = static_cast<uint16_t>(char_at(s[i], t.d));
+            ++count[ch[i]];
+        }
         
-        // 计数
-        constexpr size_t BLOCK = 4096;
-        mem::Buffer<size_t> bucket_indices(n);
+        // 整段同一个字符: 一次跳过整个公共前缀，而不是逐字符重新分桶
+        if (count[ch[0]] == n) {
+            if (ch[0] != 0) stack.push_back({t.lo, n, t.d + 1 + common_prefix(s, n, t.d + 1)});
+            return;
+        }
         
-        if (bucket_indices) {
-            for (size_t i = 0; i < n; i += BLOCK) {
-                size_t block_size = std::min(BLOCK, n - i);
-                classifier.classify_batch(data + i, block_size, bucket_indices.data() + i);
-                for (size_t j = 0; j < block_size; ++j) {
-                    ++bucket_sizes[bucket_indices[i + j]];
-                }
-            }
-        } else {
-            for (size_t i = 0; i < n; ++i) {
-                ++bucket_sizes[classifier.classify(data[i])];
-            }
+        size_t start[NB + 1];
+        size_t next[NB];
+        start[0] = 0;
+        for (size_t b = 0; b < NB; ++b) {
+            start[b + 1] = start[b] + count[b];
+            next[b] = start[b];
         }
         
-        // 计算偏移
-        bucket_starts.resize(num_buckets + 1);
-        bucket_starts[0] = 0;
-        for (size_t i = 0; i < num_buckets; ++i) {
-            bucket_starts[i + 1] = bucket_starts[i] + bucket_sizes[i];
+        for (size_t b = 0; b < NB; ++b) {
+            while (next[b] < start[b + 1]) {
+                size_t i = next[b];
+                uint16_t c = ch[i];
+                if (c == b) {
+                    ++next[b];
+                    continue;
+                }
+                // 循环置换直到位置i放入属于桶b的元素
+                do {
+                    size_t j = next[c]++;
+                    ops::swap(s[i], s[j]);
+                    std::swap(ch[i], ch[j]);
+                    c = ch[i];
+                } while (c != b);
+                ++next[b];
+            }
         }
         
-        // 分发
-        mem::Buffer<T> buffer(n);
-        if (!buffer) {
-            std::stable_sort(data, data + n, cmp);
+        // 桶0中的字符串已全部结束，彼此相等
+        for (size_t b = 1; b < NB; ++b) {
+            if (count[b] > 1) stack.push_back({t.lo + start[b], count[b], t.d + 1});
+        }
+    }
+    
+    // 从深度d起排序 (调用方保证a[0..n)的前d个字符都相同)
+    template<typename S>
+    void sort_from(S* a, size_t n, size_t d) {
+        if (n < 2) return;
+        if (n <= config::STRING_INSERTION_THRESHOLD) {
+            insertion_from(a, n, d);
             return;
         }
         
-        std::vector<size_t> write_pos(bucket_starts.begin(), bucket_starts.end() - 1);
+        mem::Buffer<uint16_t> oracle(n > config::STRING_MKQS_THRESHOLD ? n : 0);
+        std::vector<Task> stack;
+        stack.push_back({0, n, d});
         
-        if (bucket_indices) {
-            for (size_t i = 0; i < n; ++i) {
-                size_t b = bucket_indices[i];
-                buffer[write_pos[b]++] = std::move(data[i]);
-            }
-        } else {
-            for (size_t i = 0; i < n; ++i) {
-                size_t b = classifier.classify(data[i]);
-                buffer[write_pos[b]++] = std::move(data[i]);
+        // 显式栈: 超长公共前缀也不会递归过深
+        while (!stack.empty()) {
+            Task t = stack.back();
+            stack.pop_back();
+            if (t.n <= config::STRING_INSERTION_THRESHOLD) {
+                insertion_from(a + t.lo, t.n, t.d);
+            } else if (t.n < config::STRING_MKQS_THRESHOLD || !oracle) {
+                mkqs_step(a, t, stack);
+            } else {
+                msd_step(a, oracle.data(), t, stack);
             }
         }
-        
-        std::memcpy(data, buffer.data(), n * sizeof(T));
-    }
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第二十三部分: PDQSort
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace pdq {
-    template<typename T, typename Cmp>
-    FYX_INLINE T& median3(T* a, T* b, T* c, Cmp& cmp) {
-        if (cmp(*b, *a)) ops::swap(*a, *b);
-        if (cmp(*c, *b)) ops::swap(*b, *c);
-        if (cmp(*b, *a)) ops::swap(*a, *b);
-        return *b;
     }
     
-    template<typename T, typename Cmp>
-    FYX_INLINE T& ninther(T* a, size_t n, Cmp& cmp) {
-        size_t s = n / 8;
-        median3(a, a + s, a + 2*s, cmp);
-        median3(a + (n/2 - s), a + n/2, a + (n/2 + s), cmp);
-        median3(a + (n - 2*s - 1), a + (n - s - 1), a + (n - 1), cmp);
-        return median3(a, a + n/2, a + n - 1, cmp);
+    // 从第d个字符起取8字节按大端打包 (不足补0): 整数比较即前8字节的字典序
+    template<typename S>
+    FYX_INLINE uint64_t load_prefix(const S& s, size_t d) noexcept {
+        const char* p;
+        size_t len;
+        if constexpr (is_cstring_v<S>) {
+            p = s + d;
+            len = 0;
+            while (len < 8 && p[len]) ++len;
+        } else {
+            p = s.data() + d;
+            len = s.size() - d;
+            if (len > 8) len = 8;
+        }
+        uint64_t r = 0;
+        for (size_t i = 0; i < len; ++i) r = (r << 8) | static_cast<unsigned char>(p[i]);
+        return len == 0 ? 0 : r << ((8 - len) * 8);
     }
     
-    template<typename T, typename Cmp>
-    std::pair<T*, T*> partition3(T* first, T* last, Cmp& cmp) {
-        size_t n = static_cast<size_t>(last - first);
-        
-        T* piv;
-        if (n >= 128) {
-            piv = &ninther(first, n, cmp);
+    // 按下标访问的公共前缀长度 (q[i].idx指向a中的字符串)
+    template<typename Src, typename P>
+    size_t common_prefix_idx(const Src& a, const P* q, size_t n, size_t d) noexcept {
+        using S = std::decay_t<decltype(a[0])>;
+        const S& s0 = a[q[0].idx];
+        size_t l;
+        if constexpr (is_cstring_v<S>) {
+            l = std::strlen(s0 + d);
         } else {
-            piv = &median3(first, first + n/2, last - 1, cmp);
-        }
-        
-        T pivot = *piv;
-        ops::swap(*first, *piv);
-        
-        T* lt = first;
-        T* gt = last;
-        T* i = first + 1;
-        
-        while (i < gt) {
-            if (cmp(*i, pivot)) {
-                ops::swap(*lt++, *i++);
-            } else if (cmp(pivot, *i)) {
-                ops::swap(*i, *--gt);
+            if (s0.size() <= d) return 0;
+            l = s0.size() - d;
+        }
+        for (size_t i = 1; i < n && l > 0; ++i) {
+            const S& si = a[q[i].idx];
+            size_t j = 0;
+            if constexpr (is_cstring_v<S>) {
+                while (j < l && si[d + j] == s0[d + j]) ++j;
             } else {
-                ++i;
+                if (si.size() <= d) return 0;
+                size_t m = std::min(l, si.size() - d);
+                while (j < m && si[d + j] == s0[d + j]) ++j;
             }
+            l = j;
         }
-        
-        return {lt, gt};
+        return l;
     }
     
-    template<typename T, typename Cmp>
-    void sort_impl(T* first, T* last, Cmp& cmp, int depth, bool left) {
-        while (true) {
-            size_t n = static_cast<size_t>(last - first);
+    // 前缀缓存排序: (8字节前缀, 下标)对交给64位基数排序，只有前缀相同的组才回看字符串
+    // 前缀末字节非0说明组内字符串的这8字节完全相同，可以跳到下一个8字节继续；
+    // 否则组内可能混有提前结束/含0字节的串，直接从深度d整串比较
+    // a可以是字符串数组，也可以是按下标现场构造string_view的视图 (如偏移量字符串池)
+    template<typename Src, typename Idx>
+    bool prefix_sort_pairs(const Src& a, ranking::KeyIndex<uint64_t, Idx>* pr, size_t n, size_t d0) {
+        using P = ranking::KeyIndex<uint64_t, Idx>;
+        assert(n == 0 || n - 1 <= static_cast<uint64_t>(std::numeric_limits<Idx>::max()));
+        
+        for (size_t i = 0; i < n; ++i) {
+            pr[i].key = load_prefix(a[i], d0);
+            pr[i].idx = static_cast<Idx>(i);
+        }
+        
+        std::vector<Task> stack;
+        stack.push_back({0, n, d0});
+        bool keys_loaded = true;
+        
+        while (!stack.empty()) {
+            Task t = stack.back();
+            stack.pop_back();
+            P* q = pr + t.lo;
+            size_t d = t.d;
+            auto cmp = [&a, d](const P& x, const P& y) { return less_from(a[x.idx], a[y.idx], d); };
             
-            if (n <= config::INSERTION_LIMIT) {
-                insertion::sort(first, n, cmp);
-                return;
+            if (t.n <= config::STRING_MKQS_THRESHOLD) {
+                pdq::sort(q, t.n, cmp);
+                continue;
             }
-            
-            if (depth == 0) { 
-                heap::sort(first, n, cmp); 
-                return; 
+            if (!keys_loaded) {
+                for (size_t i = 0; i < t.n; ++i) q[i].key = load_prefix(a[q[i].idx], d);
+            }
+            keys_loaded = false;
+            if (!ranking::lsd_pairs(q, t.n)) {
+                pdq::sort(q, t.n, cmp);
+                continue;
             }
-            --depth;
-            
-            auto [lt, gt] = partition3(first, last, cmp);
-            size_t ln = static_cast<size_t>(lt - first);
-            size_t rn = static_cast<size_t>(last - gt);
             
-            if (ln < rn) { 
-                sort_impl(first, lt, cmp, depth, left); 
-                first = gt; 
-                left = false; 
-            } else { 
-                sort_impl(gt, last, cmp, depth, false); 
-                last = lt; 
+            for (size_t i = 0; i < t.n;) {
+                size_t j = i + 1;
+                while (j < t.n && q[j].key == q[i].key) ++j;
+                if (j - i > 1) {
+                    if (q[i].key & 0xFF) {
+                        // 整段前缀都相同时顺带跳过更长的公共前缀 (如URL的协议和域名)
+                        size_t skip = (j - i == t.n) ? common_prefix_idx(a, q, t.n, d + 8) : 0;
+                        stack.push_back({t.lo + i, j - i, d + 8 + skip});
+                    } else {
+                        pdq::sort(q + i, j - i, cmp);
+                    }
+                }
+                i = j;
             }
         }
+        return true;
     }
     
-    template<typename T, typename Cmp>
-    void sort(T* a, size_t n, Cmp cmp) {
-        if (n <= 1) return;
-        int depth = 0; 
-        for (size_t m = n; m > 1; m >>= 1) ++depth;
-        sort_impl(a, a + n, cmp, depth * 2, true);
+    template<typename S, typename Idx>
+    bool prefix_sort_impl(S* a, size_t n, size_t d0) {
+        using P = ranking::KeyIndex<uint64_t, Idx>;
+        
+        mem::Buffer<P> pairs(n);
+        if (!pairs) return false;
+        P* pr = pairs.data();
+        prefix_sort_pairs(a, pr, n, d0);
+        
+        // 按置换一次性搬运字符串对象
+        std::vector<S> tmp;
+        tmp.reserve(n);
+        for (size_t i = 0; i < n; ++i) tmp.push_back(std::move(a[pr[i].idx]));
+        std::move(tmp.begin(), tmp.end(), a);
+        return true;
     }
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第二十四部分: 归并排序
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace merge {
-    template<typename T, typename Cmp>
-    void sort(T* a, size_t n, Cmp& cmp) {
-        if (n <= config::SMALL) { 
-            insertion::sort(a, n, cmp); 
-            return; 
+    
+    // 偏移量字符串池 (Arrow风格): 第i个串为buf[off[i], off[i+1])，按需构造string_view
+    template<typename Off>
+    struct ArenaView {
+        const char* buf;
+        const Off* off;
+        FYX_INLINE std::string_view operator[](size_t i) const noexcept {
+            return std::string_view(buf + off[i], static_cast<size_t>(off[i + 1] - off[i]));
         }
-        
-        mem::Buffer<T> buf(n);
-        if (!buf) { 
-            pdq::sort(a, n, cmp); 
-            return; 
+    };
+    
+    // 字符串池排序，perm[i]为排序后第i个串的原下标
+    template<typename Off, typename Idx>
+    bool arena_argsort(const char* buf, const Off* off, size_t n, Idx* perm) {
+        using P = ranking::KeyIndex<uint64_t, Idx>;
+        mem::Buffer<P> pairs(n);
+        if (!pairs) return false;
+        P* pr = pairs.data();
+        prefix_sort_pairs(ArenaView<Off>{buf, off}, pr, n, 0);
+        for (size_t i = 0; i < n; ++i) perm[i] = pr[i].idx;
+        return true;
+    }
+    
+    // 从已知公共前缀h开始比较，h更新为两串的LCP；返回-1/0/1
+    template<typename S>
+    FYX_INLINE int compare_lcp(const S& x, const S& y, size_t& h) noexcept {
+        if constexpr (is_cstring_v<S>) {
+            while (x[h] && x[h] == y[h]) ++h;
+            unsigned cx = static_cast<unsigned char>(x[h]);
+            unsigned cy = static_cast<unsigned char>(y[h]);
+            return cx < cy ? -1 : (cx > cy ? 1 : 0);
+        } else {
+            size_t m = std::min(x.size(), y.size());
+            while (h < m && x[h] == y[h]) ++h;
+            if (h == m) return x.size() < y.size() ? -1 : (x.size() > y.size() ? 1 : 0);
+            return static_cast<unsigned char>(x[h]) < static_cast<unsigned char>(y[h]) ? -1 : 1;
         }
-        
-        for (size_t width = 1; width < n; width *= 2) {
-            for (size_t i = 0; i < n; i += 2 * width) {
-                size_t left = i;
-                size_t mid = std::min(i + width, n);
-                size_t right = std::min(i + 2 * width, n);
-                
-                // 已经有序则跳过
-                if (mid < right && !cmp(a[mid], a[mid-1])) continue;
-                
-                size_t l = left, r = mid, k = left;
-                
-                for (size_t j = left; j < right; ++j) {
-                    buf[j] = std::move(a[j]);
-                }
-                
-                while (l < mid && r < right) {
-                    if (!cmp(buf[r], buf[l])) {
-                        a[k++] = std::move(buf[l++]);
-                    } else {
-                        a[k++] = std::move(buf[r++]);
-                    }
+    }
+    
+    // 归并时搬运的元素: 较大的std::string只搬指针，string_view/C字符串直接搬
+    template<typename S>
+    struct LcpItem {
+        static constexpr bool by_ptr = sizeof(S) > 2 * sizeof(void*);
+        using type = std::conditional_t<by_ptr, const S*, S>;
+        static FYX_INLINE const S& get(const type& e) noexcept {
+            if constexpr (by_ptr) return *e; else return e;
+        }
+    };
+    
+    // LCP归并: ha/hb为两段的LCP数组 (h[i] = lcp(s[i-1], s[i]))
+    // la/lb记录两段当前首元素与上一个输出元素的LCP，只有两者相等时才需要比较字符，
+    // 且从la处开始比较，已知相同的前缀不会重复比较。相等时取左段，保持稳定
+    template<typename S, typename E>
+    void lcp_merge(const E* A, const size_t* ha, size_t na, const E* B, const size_t* hb, size_t nb,
+                   E* out, size_t* ho) {
+        using It = LcpItem<S>;
+        size_t i = 0, j = 0, k = 0;
+        size_t la = 0, lb = 0;
+        while (i < na && j < nb) {
+            if (la > lb) {
+                out[k] = A[i];
+                ho[k++] = la;
+                la = ++i < na ? ha[i] : 0;
+            } else if (la < lb) {
+                out[k] = B[j];
+                ho[k++] = lb;
+                lb = ++j < nb ? hb[j] : 0;
+            } else {
+                size_t h = la;
+                if (compare_lcp(It::get(A[i]), It::get(B[j]), h) <= 0) {
+                    out[k] = A[i];
+                    ho[k++] = la;
+                    la = ++i < na ? ha[i] : 0;
+                    lb = h;
+                } else {
+                    out[k] = B[j];
+                    ho[k++] = lb;
+                    lb = ++j < nb ? hb[j] : 0;
+                    la = h;
                 }
-                while (l < mid) a[k++] = std::move(buf[l++]);
-                while (r < right) a[k++] = std::move(buf[r++]);
+            }
+        }
+        if (i < na) {
+            out[k] = A[i];
+            ho[k++] = la;
+            for (++i; i < na; ++i, ++k) {
+                out[k] = A[i];
+                ho[k] = ha[i];
+            }
+        }
+        if (j < nb) {
+            out[k] = B[j];
+            ho[k++] = lb;
+            for (++j; j < nb; ++j, ++k) {
+                out[k] = B[j];
+                ho[k] = hb[j];
             }
         }
     }
-}
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第二十五部分: 并行超采样排序实现 (修复版)
-// ═══════════════════════════════════════════════════════════════════════════
-
-#if FYX_ENABLE_PARALLEL
-namespace parallel {
-    template<typename T, typename Cmp>
-    void parallel_supersample(T* a, size_t n, Cmp cmp, const Options& opts) {
-        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
-        if (n < opts.parallel_threshold * 2 || nt <= 1) {
-            pdq::sort(a, n, cmp);
+    
+    // 稳定的LCP归并排序；lcp_out非空时写出结果的LCP数组 (lcp_out[0] = 0)
+    template<typename S>
+    void lcp_merge_sort(S* a, size_t n, size_t* lcp_out) {
+        using It = LcpItem<S>;
+        using E = typename It::type;
+        if (n == 0) return;
+        
+        mem::Buffer<E> e0(n), e1(n);
+        mem::Buffer<size_t> h0(n), h1(n);
+        if (!e0 || !e1 || !h0 || !h1) {
+            // 内存不足: 退化为稳定插入排序后直接计算LCP
+            insertion_from(a, n, 0);
+            if (lcp_out) {
+                lcp_out[0] = 0;
+                for (size_t i = 1; i < n; ++i) {
+                    size_t h = 0;
+                    compare_lcp(a[i - 1], a[i], h);
+                    lcp_out[i] = h;
+                }
+            }
             return;
         }
         
-        nt = std::min(nt, config::MAX_BUCKETS);
-        
-        std::vector<size_t> bucket_starts, bucket_sizes;
-        supersample::partition(a, n, nt, cmp, bucket_starts, bucket_sizes);
-        
-        // 修复：处理空桶和边界情况
-        if (bucket_sizes.empty()) {
-            pdq::sort(a, n, cmp);
-            return;
+        // 初始有序段: 稳定插入排序后直接计算段内LCP
+        constexpr size_t RUN = config::STRING_INSERTION_THRESHOLD;
+        E* src = e0.data();
+        E* dst = e1.data();
+        size_t* hs = h0.data();
+        size_t* hd = h1.data();
+        for (size_t i = 0; i < n; ++i) {
+            if constexpr (It::by_ptr) src[i] = a + i; else src[i] = a[i];
+        }
+        for (size_t lo = 0; lo < n; lo += RUN) {
+            size_t len = std::min(RUN, n - lo);
+            // insertion::sort对小段走排序网络，不稳定，这里单独写
+            for (size_t i = lo + 1; i < lo + len; ++i) {
+                E key = src[i];
+                size_t j = i;
+                while (j > lo && less_from(It::get(key), It::get(src[j - 1]), 0)) {
+                    src[j] = src[j - 1];
+                    --j;
+                }
+                src[j] = key;
+            }
+            hs[lo] = 0;
+            for (size_t i = lo + 1; i < lo + len; ++i) {
+                size_t l = 0;
+                compare_lcp(It::get(src[i - 1]), It::get(src[i]), l);
+                hs[i] = l;
+            }
         }
         
-        // 计算有效桶数
-        size_t valid_buckets = 0;
-        for (size_t sz : bucket_sizes) {
-            if (sz > 0) ++valid_buckets;
+        for (size_t width = RUN; width < n; width *= 2) {
+            for (size_t lo = 0; lo < n; lo += 2 * width) {
+                size_t mid = std::min(lo + width, n);
+                size_t hi = std::min(lo + 2 * width, n);
+                if (mid == hi) {
+                    std::memcpy(dst + lo, src + lo, (hi - lo) * sizeof(E));
+                    std::memcpy(hd + lo, hs + lo, (hi - lo) * sizeof(size_t));
+                    continue;
+                }
+                lcp_merge<S>(src + lo, hs + lo, mid - lo, src + mid, hs + mid, hi - mid,
+                             dst + lo, hd + lo);
+            }
+            std::swap(src, dst);
+            std::swap(hs, hd);
         }
         
-        if (valid_buckets == 0) {
-            return; // 数据已排序
+        if constexpr (It::by_ptr) {
+            // 按最终顺序一次性搬运字符串对象
+            std::vector<S> tmp;
+            tmp.reserve(n);
+            for (size_t i = 0; i < n; ++i) tmp.push_back(std::move(*const_cast<S*>(src[i])));
+            std::move(tmp.begin(), tmp.end(), a);
+        } else {
+            std::memcpy(a, src, n * sizeof(S));
         }
+        if (lcp_out) {
+            std::memcpy(lcp_out, hs, n * sizeof(size_t));
+            lcp_out[0] = 0;
+        }
+    }
+    
+    // 单线程入口 (调用方保证前d个字符都相同)
+    template<typename S>
+    void sort(S* a, size_t n, size_t d = 0) {
+        if (n >= config::STRING_PREFIX_MIN_SIZE) {
+            bool done = n <= UINT32_MAX ? prefix_sort_impl<S, uint32_t>(a, n, d)
+                                        : prefix_sort_impl<S, uint64_t>(a, n, d);
+            if (done) return;
+        }
+        sort_from(a, n, d);
+    }
+    
+#if FYX_ENABLE_PARALLEL
+    // 并行字符串样本排序: 分隔符取8字节前缀键，按完全二叉树(Eytzinger)布局无分支下降；
+    // 与分隔符前缀相等的元素进入单独的相等桶，这样桶之间的顺序只由前缀决定。
+    // rounds: 过大相等桶还可再并行递归的层数
+    // 分发缓冲与桶号共需n * (sizeof(S) + 2)字节；超出内存上限时不分配，改为按桶原地循环置换，
+    // 分类与桶内排序照样并行。返回顶层是否走了原地置换
+    template<typename S>
+    bool parallel_sort(S* a, size_t n, size_t d, size_t nt, int rounds = 4) {
+        const bool in_place = n * (sizeof(S) + sizeof(uint16_t)) > config::available_memory();
+        size_t levels = 4;
+        while (levels < 10 && (size_t(1) << levels) < nt * 8) ++levels;
+        const size_t K = (size_t(1) << levels) - 1;
+        const size_t NB = 2 * K + 1;
+        
+        // 采样并选出分隔符 (去重后用最大键补齐)
+        constexpr size_t OVERSAMPLE = 16;
+        size_t m = std::min(n, (K + 1) * OVERSAMPLE);
+        std::vector<uint64_t> sample(m);
+        size_t stride = n / m;
+        for (size_t i = 0; i < m; ++i) sample[i] = load_prefix(a[i * stride], d);
+        std::sort(sample.begin(), sample.end());
+        std::vector<uint64_t> spl;
+        spl.reserve(K);
+        for (size_t i = 1; i <= K; ++i) spl.push_back(sample[i * m / (K + 1)]);
+        spl.erase(std::unique(spl.begin(), spl.end()), spl.end());
+        spl.resize(K, UINT64_MAX);
+        
+        std::vector<uint64_t> tree(K + 1);
+        size_t pos = 0;
+        auto build = [&](auto& self, size_t i) -> void {
+            if (i > K) return;
+            self(self, 2 * i);
+            tree[i] = spl[pos++];
+            self(self, 2 * i + 1);
+        };
+        build(build, 1);
         
-        // 动态调整线程数
-        size_t actual_threads = std::min(nt, valid_buckets);
-        actual_threads = std::max(actual_threads, size_t(1));
-        
-        std::vector<std::thread> threads;
-        threads.reserve(actual_threads);
-        
-        std::atomic<size_t> next_bucket{0};
-        
-        auto worker = [&]() {
-            while (true) {
-                size_t b = next_bucket.fetch_add(1, std::memory_order_relaxed);
-                if (b >= bucket_sizes.size()) break;
-                
-                size_t start = bucket_starts[b];
-                size_t len = bucket_sizes[b];
-                
-                if (len > 1) {
-                    pdq::sort(a + start, len, cmp);
-                }
-            }
+        auto classify = [&](uint64_t key) -> size_t {
+            size_t i = 1;
+            for (size_t l = 0; l < levels; ++l) i = 2 * i + static_cast<size_t>(key > tree[i]);
+            size_t b = i - (K + 1);
+            return (b < K && key == spl[b]) ? 2 * b + 1 : 2 * b;
         };
         
-        for (size_t t = 0; t < actual_threads; ++t) {
-            threads.emplace_back(worker);
-        }
+        // 并行分类: 每个线程负责一段，记录桶号并统计本地直方图
+        std::vector<uint16_t> bucket_of(in_place ? 0 : n);
+        std::vector<size_t> hist(nt * NB, 0);
+        size_t chunk = (n + nt - 1) / nt;
+        auto run = [nt](auto&& fn) {
+            std::vector<std::thread> threads;
+            threads.reserve(nt);
+            for (size_t t = 0; t < nt; ++t) threads.emplace_back(fn, t);
+            for (auto& th : threads) th.join();
+        };
+        run([&](size_t t) {
+            size_t lo = t * chunk, hi = std::min(n, lo + chunk);
+            size_t* h = hist.data() + t * NB;
+            for (size_t i = lo; i < hi; ++i) {
+                size_t b = classify(load_prefix(a[i], d));
+                if (!in_place) bucket_of[i] = static_cast<uint16_t>(b);
+                ++h[b];
+            }
+        });
         
-        for (auto& th : threads) {
-            if (th.joinable()) {
-                th.join();
+        // 桶优先、线程其次的前缀和，得到每个线程在每个桶中的写入位置
+        std::vector<size_t> start(NB + 1, 0);
+        std::vector<size_t> offs(nt * NB);
+        size_t sum = 0;
+        for (size_t b = 0; b < NB; ++b) {
+            start[b] = sum;
+            for (size_t t = 0; t < nt; ++t) {
+                offs[t * NB + b] = sum;
+                sum += hist[t * NB + b];
             }
         }
-    }
-} // namespace parallel
-#endif // FYX_ENABLE_PARALLEL
-
-// ═══════════════════════════════════════════════════════════════════════════
-// 第二十六部分: 间接排序
-// ═══════════════════════════════════════════════════════════════════════════
-
-namespace indirect {
-    template<typename T, typename Cmp>
-    void sort(T* a, size_t n, Cmp& cmp) {
-        std::vector<size_t> idx(n);
-        std::iota(idx.begin(), idx.end(), size_t(0));
+        start[NB] = sum;
         
-        pdq::sort(idx.data(), idx.size(), 
-            [&](size_t i, size_t j) { return cmp(a[i], a[j]); });
-        
-        std::vector<bool> done(n, false);
-        for (size_t i = 0; i < n; ++i) {
-            if (done[i] || idx[i] == i) continue;
-            T tmp = std::move(a[i]);
-            size_t j = i;
-            while (idx[j] != i) {
-                a[j] = std::move(a[idx[j]]);
-                done[j] = true;
-                j = idx[j];
+        std::vector<S> out;
+        if (in_place) {
+            // American Flag式循环置换: 每次交换把一个元素送进它的桶，桶号现算不存
+            std::vector<size_t> next(start.begin(), start.end() - 1);
+            for (size_t b = 0; b < NB; ++b) {
+                while (next[b] < start[b + 1]) {
+                    size_t c = classify(load_prefix(a[next[b]], d));
+                    if (c == b) { ++next[b]; continue; }
+                    std::swap(a[next[b]], a[next[c]]);
+                    ++next[c];
+                }
             }
-            a[j] = std::move(tmp);
-            done[j] = true;
+        } else {
+            out.resize(n);
+            run([&](size_t t) {
+                size_t lo = t * chunk, hi = std::min(n, lo + chunk);
+                size_t* o = offs.data() + t * NB;
+                for (size_t i = lo; i < hi; ++i) out[o[bucket_of[i]]++] = std::move(a[i]);
+            });
         }
-    }
-    
-    template<typename T, typename Cmp>
-    void stable_sort(T* a, size_t n, Cmp& cmp) {
-        std::vector<size_t> idx(n);
-        std::iota(idx.begin(), idx.end(), size_t(0));
+        S* base = in_place ? a : out.data();
         
-        std::stable_sort(idx.begin(), idx.end(), 
-            [&](size_t i, size_t j) { return cmp(a[i], a[j]); });
+        // 相等桶的前缀末字节非0时，桶内8字节完全相同，可从d+8继续
+        auto depth_of = [&](size_t b) -> size_t {
+            return (b & 1) && (spl[b / 2] & 0xFF) ? d + 8 : d;
+        };
         
-        std::vector<bool> done(n, false);
-        for (size_t i = 0; i < n; ++i) {
-            if (done[i] || idx[i] == i) continue;
-            T tmp = std::move(a[i]);
-            size_t j = i;
-            while (idx[j] != i) {
-                a[j] = std::move(a[idx[j]]);
-                done[j] = true;
-                j = idx[j];
+        // 过大的相等桶 (如所有URL都以同样的8字节开头) 先原样搬回，稍后递归并行处理
+        std::vector<char> deferred(NB, 0);
+        for (size_t b = 1; b < NB && rounds > 0; b += 2) {
+            size_t len = start[b + 1] - start[b];
+            deferred[b] = depth_of(b) > d && len > n / nt && len >= config::PARALLEL_THRESHOLD * 2;
+        }
+        
+        // 各桶交给单线程字符串引擎，排好后搬回原数组
+        std::atomic<size_t> next{0};
+        run([&](size_t) {
+            for (size_t b; (b = next.fetch_add(1, std::memory_order_relaxed)) < NB;) {
+                size_t lo = start[b], len = start[b + 1] - lo;
+                if (len == 0) continue;
+                if (len > 1 && !deferred[b]) sort(base + lo, len, depth_of(b));
+                if (!in_place) std::move(base + lo, base + lo + len, a + lo);
             }
-            a[j] = std::move(tmp);
-            done[j] = true;
-        }
+        });
+        
+        // 递归前释放本层缓冲，峰值内存不随递归层数增长；
+        // 跳过桶内的整段公共前缀，每层至少前进到第一个有差异的字节
+        std::vector<S>().swap(out);
+        std::vector<uint16_t>().swap(bucket_of);
+        for (size_t b = 1; b < NB; b += 2) {
+            if (!deferred[b]) continue;
+            size_t len = start[b + 1] - start[b];
+            S* s = a + start[b];
+            parallel_sort(s, len, d + 8 + common_prefix(s, len, d + 8), nt, rounds - 1);
+        }
+        return in_place;
     }
-}
+#endif
+} // namespace strsort
 
 // ═══════════════════════════════════════════════════════════════════════════
-// 第二十七部分: 迭代器适配器
+// 第三十五部分: 定长字节键排序 (哈希/UUID/摘要)
 // ═══════════════════════════════════════════════════════════════════════════
 
-namespace iter_adapter {
-    template<typename It, typename Cmp>
-    void sort_non_contiguous(It first, It last, Cmp cmp) {
-        using T = iter_traits::value_type_t<It>;
-        auto n = std::distance(first, last);
-        if (n < 2) return;
-        
-        std::vector<T> tmp(first, last);
+namespace bytesort {
+    template<size_t N>
+    struct Record {
+        unsigned char b[N];
+    };
+    
+    // memcmp序比较，从第d个字节开始 (前d个字节调用方已保证相同)
+    template<size_t N>
+    FYX_INLINE bool less_from(const Record<N>& x, const Record<N>& y, size_t d) noexcept {
+        return std::memcmp(x.b + d, y.b + d, N - d) < 0;
+    }
+    
+    template<size_t N>
+    void insertion_from(Record<N>* a, size_t n, size_t d) noexcept {
+        for (size_t i = 1; i < n; ++i) {
+            if (!less_from(a[i], a[i - 1], d)) continue;
+            Record<N> tmp = a[i];
+            size_t j = i;
+            do {
+                a[j] = a[j - 1];
+                --j;
+            } while (j > 0 && less_from(tmp, a[j - 1], d));
+            a[j] = tmp;
+        }
+    }
+    
+    struct Task {
+        size_t lo;
+        size_t n;
+        size_t d;
+    };
+    
+    // American Flag原地分发第d个字节；返回各桶起点 (start[256] = n)
+    template<size_t N>
+    void partition_byte(Record<N>* a, size_t n, size_t d, size_t* start) noexcept {
+        size_t count[256] = {};
+        for (size_t i = 0; i < n; ++i) ++count[a[i].b[d]];
         
-        if constexpr (traits::is_radix_sortable_v<T> && traits::is_default_less_v<T, Cmp>) {
-            radix::sort(tmp.data(), static_cast<size_t>(n));
-        } else {
-            pdq::sort(tmp.data(), static_cast<size_t>(n), cmp);
+        size_t next[256];
+        start[0] = 0;
+        for (size_t b = 0; b < 256; ++b) {
+            start[b + 1] = start[b] + count[b];
+            next[b] = start[b];
         }
+        if (count[a[0].b[d]] == n) return;
         
-        std::copy(tmp.begin(), tmp.end(), first);
+        for (size_t b = 0; b < 256; ++b) {
+            while (next[b] < start[b + 1]) {
+                size_t i = next[b];
+                unsigned c = a[i].b[d];
+                if (c == b) {
+                    ++next[b];
+                    continue;
+                }
+                Record<N> cur = a[i];
+                do {
+                    size_t j = next[c]++;
+                    Record<N> tmp = a[j];
+                    a[j] = cur;
+                    cur = tmp;
+                    c = cur.b[d];
+                } while (c != b);
+                a[i] = cur;
+                ++next[b];
+            }
+        }
     }
     
-    template<typename It, typename Cmp>
-    void stable_sort_non_contiguous(It first, It last, Cmp cmp) {
-        using T = iter_traits::value_type_t<It>;
-        auto n = std::distance(first, last);
+    // MSD基数排序，小桶改用memcmp比较排序
+    template<size_t N>
+    void sort_from(Record<N>* a, size_t n, size_t d) {
+        std::vector<Task> stack;
+        stack.push_back({0, n, d});
+        size_t start[257];
+        
+        while (!stack.empty()) {
+            Task t = stack.back();
+            stack.pop_back();
+            Record<N>* s = a + t.lo;
+            if (t.d >= N || t.n < 2) continue;
+            
+            if (t.n <= config::STRING_INSERTION_THRESHOLD) {
+                insertion_from(s, t.n, t.d);
+                continue;
+            }
+            if (t.n <= config::BYTES_RADIX_THRESHOLD) {
+                size_t dd = t.d;
+                pdq::sort(s, t.n, [dd](const Record<N>& x, const Record<N>& y) {
+                    return less_from(x, y, dd);
+                });
+                continue;
+            }
+            
+            partition_byte(s, t.n, t.d, start);
+            for (size_t b = 0; b < 256; ++b) {
+                size_t len = start[b + 1] - start[b];
+                if (len > 1) stack.push_back({t.lo + start[b], len, t.d + 1});
+            }
+        }
+    }
+    
+    template<size_t N>
+    void sort(Record<N>* a, size_t n, const Options& opts) {
         if (n < 2) return;
-        
-        std::vector<T> tmp(first, last);
-        merge::sort(tmp.data(), static_cast<size_t>(n), cmp);
-        std::copy(tmp.begin(), tmp.end(), first);
+#if FYX_ENABLE_PARALLEL
+        size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+        if (opts.parallel && nt > 1 && n >= opts.parallel_threshold * 2) {
+            // 首字节分发后256个桶互不相关，由各线程领取
+            size_t start[257];
+            partition_byte(a, n, 0, start);
+            std::atomic<size_t> next{0};
+            std::vector<std::thread> threads;
+            threads.reserve(nt);
+            for (size_t t = 0; t < nt; ++t) {
+                threads.emplace_back([&]() {
+                    for (size_t b; (b = next.fetch_add(1, std::memory_order_relaxed)) < 256;) {
+                        size_t len = start[b + 1] - start[b];
+                        if (len > 1) sort_from(a + start[b], len, 1);
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+            return;
+        }
+#else
+        (void)opts;
+#endif
+        sort_from(a, n, 0);
     }
-}
+} // namespace bytesort
 
 } // namespace detail
 
@@ -3788,6 +8167,12 @@ struct Sorter {
             return;
         }
         
+        // 数值键的小数组直接走补齐的双调网络，省掉采样分析
+        // (网络不稳定: 浮点的+0/-0可能互换，稳定排序不走这里)
+        if constexpr (detail::traits::has_simd_small_sort_v<T> && detail::traits::is_default_less_v<T, Cmp>) {
+            if (n <= config::SIMD_NETWORK_LIMIT && !opts.stable && detail::simd::sort_small_simd(a, n)) return;
+        }
+        
         // 自适应分析
         auto profile = detail::adaptive::analyze(a, n, cmp);
         
@@ -3797,13 +8182,7 @@ struct Sorter {
         if (profile.is_reverse) { 
             std::reverse(a, a + n);
             // 完整验证
-            bool sorted = true;
-            for (size_t i = 1; i < n && sorted; ++i) {
-                if (cmp(a[i], a[i-1])) {
-                    sorted = false;
-                }
-            }
-            if (sorted) return;
+            if (detail::adaptive::sorted_prefix(a, n, cmp) == n) return;
             // 不是真正逆序，继续排序（此时数据已反转，可能需要再排）
         }
         
@@ -3811,7 +8190,14 @@ struct Sorter {
         if (opts.force_comparison) {
 #if FYX_ENABLE_PARALLEL
             if (opts.parallel && n >= opts.parallel_threshold * 2 && config::num_threads() > 1) {
-                detail::parallel::parallel_supersample(a, n, cmp, opts);
+                // 字符串并行时同样交给字符串引擎的样本排序 (见下方字符串分支)
+                if constexpr (detail::strsort::use_engine_v<T, Cmp>) {
+                    size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+                    if (nt > 1) detail::strsort::parallel_sort(a, n, 0, nt);
+                    else detail::pdq::sort(a, n, cmp);
+                } else {
+                    detail::parallel::parallel_supersample(a, n, cmp, opts);
+                }
                 return;
             }
 #endif
@@ -3821,10 +8207,13 @@ struct Sorter {
         
         // 稳定排序
         if (opts.stable) {
-            if constexpr (detail::traits::use_indirect_v<T>) {
+            if constexpr (detail::strsort::use_engine_v<T, Cmp>) {
+                detail::strsort::lcp_merge_sort(a, n, nullptr);
+            } else if constexpr (detail::traits::use_indirect_v<T>) {
                 detail::indirect::stable_sort(a, n, cmp);
             } else {
-                detail::merge::sort(a, n, cmp);
+                // 接近有序时analyze给出的是整段扫描的精确游程数
+                detail::merge::sort(a, n, cmp, profile.is_nearly_sorted ? profile.run_count : 0);
             }
             return;
         }
@@ -3833,18 +8222,55 @@ struct Sorter {
         if constexpr (detail::traits::is_radix_sortable_v<T>) {
             if constexpr (detail::traits::is_default_less_v<T, Cmp>) {
                 if (!opts.force_comparison) {
-#if FYX_ENABLE_PARALLEL
-                    if (opts.parallel && n >= opts.parallel_threshold * 2 && config::num_threads() > 1) {
-                        detail::parallel::parallel_radix(a, n, opts);
-                        return;
+                    // 整体变换一次，之后每轮计数/散布按无符号键处理，不再逐元素翻转符号位
+                    if constexpr (detail::keymap::needs_transform_v<T>) {
+                        using Key = typename detail::keymap::Mapper<T>::Key;
+                        if constexpr (std::is_integral_v<T>) {
+                            // 有符号整数与对应无符号类型可以互相别名: 原地换键，异常离开时同样换回原值
+                            if (opts.transform_keys) {
+                                Key* keys = reinterpret_cast<Key*>(a);
+                                struct Restore {
+                                    Key* keys; T* a; size_t n;
+                                    ~Restore() { detail::simd::from_keys(keys, a, n); }
+                                } restore{keys, a, n};
+                                detail::simd::to_keys(a, keys, n);
+                                radix_sort(keys, n, opts);
+                                return;
+                            }
+                        } else {
+                            // 浮点对象不能经整数左值访问: 键写进单独的数组排序后再解码回来；
+                            // 超出内存上限或分配失败时退回逐轮映射
+                            if (opts.transform_keys && n * sizeof(Key) <= config::available_memory()) {
+                                detail::mem::Buffer<Key> keys(n);
+                                if (keys) {
+                                    detail::simd::to_keys(a, keys.data(), n);
+                                    radix_sort(keys.data(), n, opts);
+                                    detail::simd::from_keys(keys.data(), a, n);
+                                    return;
+                                }
+                            }
+                        }
                     }
-#endif
-                    detail::radix::sort(a, n);
+                    radix_sort(a, n, opts);
                     return;
                 }
             }
         }
         
+        // 字符串: MSD基数 + 多键快排，避免整串比较
+        // (parallel_supersample每次比较都从头比整串，字符串用专门的样本排序)
+        if constexpr (detail::strsort::use_engine_v<T, Cmp>) {
+#if FYX_ENABLE_PARALLEL
+            size_t nt = opts.max_threads > 0 ? opts.max_threads : config::num_threads();
+            if (opts.parallel && nt > 1 && n >= opts.parallel_threshold * 2) {
+                detail::strsort::parallel_sort(a, n, 0, nt);
+                return;
+            }
+#endif
+            detail::strsort::sort(a, n);
+            return;
+        }
+        
         // 大对象间接排序
         if constexpr (detail::traits::use_indirect_v<T>) {
             detail::indirect::sort(a, n, cmp);
@@ -3862,10 +8288,25 @@ struct Sorter {
         detail::pdq::sort(a, n, cmp);
     }
     
+    template<typename U>
+    static void radix_sort(U* a, size_t n, const Options& opts) {
+#if FYX_ENABLE_PARALLEL
+        if (opts.parallel && n >= opts.parallel_threshold * 2 && config::num_threads() > 1) {
+            detail::parallel::parallel_radix(a, n, opts);
+            return;
+        }
+#else
+        (void)opts;
+#endif
+        detail::radix::sort(a, n);
+    }
+    
     template<typename Cmp = std::less<T>>
     static void stable_sort(T* a, size_t n, Cmp cmp = Cmp(), const Options& = Options::defaults()) {
         if (n < 2) return;
-        if constexpr (detail::traits::use_indirect_v<T>) {
+        if constexpr (detail::strsort::use_engine_v<T, Cmp>) {
+            detail::strsort::lcp_merge_sort(a, n, nullptr);
+        } else if constexpr (detail::traits::use_indirect_v<T>) {
             detail::indirect::stable_sort(a, n, cmp);
         } else {
             detail::merge::sort(a, n, cmp);
@@ -4010,73 +8451,125 @@ void stable_sort(It first, It last, Cmp cmp, const Options& opts = Options::defa
     }
 }
 
-// 部分排序
-template<typename It>
-void partial_sort(It first, It middle, It last) {
-    std::partial_sort(first, middle, last);
+// 稳定字符串排序并输出LCP数组: lcp[i]为排序后第i-1与第i个串的最长公共前缀长度，lcp[0] = 0
+// 适用于std::string / std::string_view / const char* (C字符串按内容排序)
+template<typename Container>
+std::vector<size_t> stable_sort_lcp(Container& c) {
+    using T = typename Container::value_type;
+    static_assert(detail::strsort::is_string_v<T>, "stable_sort_lcp requires string elements");
+    std::vector<size_t> lcp(c.size());
+    if constexpr (detail::traits::is_contiguous_v<Container>) {
+        detail::strsort::lcp_merge_sort(c.data(), c.size(), lcp.data());
+    } else {
+        std::vector<T> tmp(std::make_move_iterator(c.begin()), std::make_move_iterator(c.end()));
+        detail::strsort::lcp_merge_sort(tmp.data(), tmp.size(), lcp.data());
+        std::move(tmp.begin(), tmp.end(), c.begin());
+    }
+    return lcp;
 }
 
-template<typename It, typename Cmp>
-void partial_sort(It first, It middle, It last, Cmp cmp) {
-    std::partial_sort(first, middle, last, cmp);
+// 部分排序: 先选出第k名（基数选择/采样选择），再只排序前k个
+template<typename T, typename Cmp>
+void partial_sort(T* a, size_t k, size_t n, Cmp cmp, const Options& opts = Options::defaults()) {
+    if (n < 2 || k == 0) return;
+    if (k >= n) {
+        Sorter<T>::sort(a, n, cmp, opts);
+        return;
+    }
+    // 小规模或k远小于n时，堆方法几乎只有与堆顶的比较
+    if (n < config::PARTIAL_SORT_MIN_SIZE ||
+        k <= std::max(config::PARTIAL_SORT_HEAP_K, n / config::PARTIAL_SORT_HEAP_RATIO)) {
+        std::partial_sort(a, a + k, a + n, cmp);
+        return;
+    }
+    detail::selection::select(a, n, k - 1, cmp, opts);
+    Sorter<T>::sort(a, k - 1, cmp, opts);
 }
 
-// nth_element
 template<typename It>
-void nth_element(It first, It nth, It last) {
-    std::nth_element(first, nth, last);
+void partial_sort(It first, It middle, It last, const Options& opts = Options::defaults()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    if constexpr (detail::iter_traits::is_contiguous_v<It>) {
+        if (first == last) return;
+        partial_sort(&(*first), static_cast<size_t>(middle - first),
+                     static_cast<size_t>(last - first), std::less<T>{}, opts);
+    } else {
+        std::partial_sort(first, middle, last);
+    }
 }
 
 template<typename It, typename Cmp>
-void nth_element(It first, It nth, It last, Cmp cmp) {
-    std::nth_element(first, nth, last, cmp);
+void partial_sort(It first, It middle, It last, Cmp cmp, const Options& opts = Options::defaults()) {
+    if constexpr (detail::iter_traits::is_contiguous_v<It>) {
+        if (first == last) return;
+        partial_sort(&(*first), static_cast<size_t>(middle - first),
+                     static_cast<size_t>(last - first), cmp, opts);
+    } else {
+        std::partial_sort(first, middle, last, cmp);
+    }
 }
 
-// 检查是否已排序
-template<typename Container>
-bool is_sorted(const Container& c) {
-    if (c.size() <= 1) return true;
-    auto it = c.begin(); 
-    auto prev = *it++;
-    while (it != c.end()) { 
-        if (*it < prev) return false; 
-        prev = *it++; 
+// nth_element: 整数键走MSD基数选择，其余走采样选择
+template<typename It, typename Cmp>
+void nth_element(It first, It nth, It last, Cmp cmp, const Options& opts = Options::defaults()) {
+    if constexpr (detail::iter_traits::is_contiguous_v<It>) {
+        if (nth == last) return;
+        detail::selection::select(&(*first), static_cast<size_t>(last - first),
+                                  static_cast<size_t>(nth - first), cmp, opts);
+    } else {
+        std::nth_element(first, nth, last, cmp);
     }
-    return true;
 }
 
+template<typename It>
+void nth_element(It first, It nth, It last, const Options& opts = Options::defaults()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    nth_element(first, nth, last, std::less<T>{}, opts);
+}
+
+// 检查是否已排序 (连续存储时走向量化扫描)
 template<typename Container, typename Cmp>
 bool is_sorted(const Container& c, Cmp cmp) {
     if (c.size() <= 1) return true;
-    auto it = c.begin(); 
-    auto prev = *it++;
-    while (it != c.end()) { 
-        if (cmp(*it, prev)) return false; 
-        prev = *it++; 
+    if constexpr (detail::traits::is_contiguous_v<Container>) {
+        return detail::adaptive::sorted_prefix(c.data(), c.size(), cmp) == c.size();
+    } else {
+        auto it = c.begin(); 
+        auto prev = *it++;
+        while (it != c.end()) { 
+            if (cmp(*it, prev)) return false; 
+            prev = *it++; 
+        }
+        return true;
     }
-    return true;
 }
 
-template<typename It>
-bool is_sorted(It first, It last) {
-    if (first == last) return true;
-    auto prev = *first++;
-    while (first != last) {
-        if (*first < prev) return false;
-        prev = *first++;
-    }
-    return true;
+template<typename Container>
+bool is_sorted(const Container& c) {
+    using T = typename Container::value_type;
+    return fyx::is_sorted(c, std::less<T>{});
 }
 
 template<typename It, typename Cmp>
 bool is_sorted(It first, It last, Cmp cmp) {
     if (first == last) return true;
-    auto prev = *first++;
-    while (first != last) {
-        if (cmp(*first, prev)) return false;
-        prev = *first++;
+    if constexpr (detail::iter_traits::is_contiguous_v<It>) {
+        size_t n = static_cast<size_t>(last - first);
+        return detail::adaptive::sorted_prefix(&(*first), n, cmp) == n;
+    } else {
+        auto prev = *first++;
+        while (first != last) {
+            if (cmp(*first, prev)) return false;
+            prev = *first++;
+        }
+        return true;
     }
-    return true;
+}
+
+template<typename It>
+bool is_sorted(It first, It last) {
+    using T = typename std::iterator_traits<It>::value_type;
+    return fyx::is_sorted(first, last, std::less<T>{});
 }
 
 // argsort
@@ -4098,6 +8591,120 @@ std::vector<size_t> argsort(const Container& c, Cmp cmp) {
     return idx;
 }
 
+// 偏移量字符串池排序 (Arrow风格: offsets有n+1项，第i个串为buffer[offsets[i], offsets[i+1]))
+// perm[i]写入排序后第i个串的原下标；不为单个字符串分配内存，相等串的先后不保证。
+// Idx须能表示n-1，否则抛出std::length_error (截断后的结果不再是置换)
+template<typename Off, typename Idx>
+void sort_string_offsets(const char* buffer, const Off* offsets, size_t n, Idx* perm) {
+    static_assert(std::is_integral_v<Off> && std::is_unsigned_v<Off>, "offsets must be unsigned");
+    static_assert(std::is_integral_v<Idx>, "permutation index must be integral");
+    if (n == 0) return;
+    if (n - 1 > static_cast<uint64_t>(std::numeric_limits<Idx>::max())) {
+        throw std::length_error("fyx::sort_string_offsets: n exceeds the range of the index type");
+    }
+    if (detail::strsort::arena_argsort(buffer, offsets, n, perm)) return;
+    
+    detail::strsort::ArenaView<Off> view{buffer, offsets};
+    for (size_t i = 0; i < n; ++i) perm[i] = static_cast<Idx>(i);
+    std::sort(perm, perm + n, [&](Idx x, Idx y) { return view[x] < view[y]; });
+}
+
+template<typename Off>
+std::vector<size_t> sort_string_offsets(const char* buffer, const Off* offsets, size_t n) {
+    std::vector<size_t> perm(n);
+    if (n <= UINT32_MAX) {
+        std::vector<uint32_t> p32(n);
+        sort_string_offsets(buffer, offsets, n, p32.data());
+        std::copy(p32.begin(), p32.end(), perm.begin());
+    } else {
+        sort_string_offsets(buffer, offsets, n, perm.data());
+    }
+    return perm;
+}
+
+// 就地应用排序结果: 按排序后的顺序重写字符串池与偏移量 (池的起始位置offsets[0]不变)
+template<typename Off>
+void sort_string_offsets_inplace(char* buffer, Off* offsets, size_t n) {
+    if (n < 2) return;
+    std::vector<size_t> perm = sort_string_offsets(buffer, offsets, n);
+    
+    Off base = offsets[0];
+    std::vector<char> arena(static_cast<size_t>(offsets[n] - base));
+    std::vector<Off> new_off(n + 1);
+    Off pos = base;
+    for (size_t i = 0; i < n; ++i) {
+        size_t k = perm[i];
+        size_t len = static_cast<size_t>(offsets[k + 1] - offsets[k]);
+        new_off[i] = pos;
+        if (len) std::memcpy(arena.data() + (pos - base), buffer + offsets[k], len);
+        pos = static_cast<Off>(pos + len);
+    }
+    new_off[n] = pos;
+    if (!arena.empty()) std::memcpy(buffer + base, arena.data(), arena.size());
+    std::copy(new_off.begin(), new_off.end(), offsets);
+}
+
+// 定长字节键排序: ptr指向n条连续的N字节记录，按memcmp序排序 (SHA摘要、UUID等)
+template<size_t N>
+void sort_bytes(void* ptr, size_t n, const Options& opts = Options::defaults()) {
+    static_assert(N > 0, "key width must be positive");
+    static_assert(sizeof(detail::bytesort::Record<N>) == N, "unexpected record padding");
+    detail::bytesort::sort(static_cast<detail::bytesort::Record<N>*>(ptr), n, opts);
+}
+
+// 排名: rank[i] 为 c[i] 在排序结果中的名次（从0开始）
+using RankMethod = detail::ranking::Method;
+
+template<typename Container>
+std::vector<size_t> rank(const Container& c, RankMethod method = RankMethod::Ordinal) {
+    using T = typename Container::value_type;
+    std::vector<size_t> r(c.size());
+    detail::ranking::compute(c, std::less<T>{}, method, nullptr, r.data());
+    return r;
+}
+
+template<typename Container, typename Cmp>
+std::vector<size_t> rank(const Container& c, Cmp cmp, RankMethod method = RankMethod::Ordinal) {
+    std::vector<size_t> r(c.size());
+    detail::ranking::compute(c, cmp, method, nullptr, r.data());
+    return r;
+}
+
+// 同时返回argsort置换与名次（逆置换），二者在同一遍扫描中产生
+template<typename Container>
+std::pair<std::vector<size_t>, std::vector<size_t>>
+argsort_with_rank(const Container& c, RankMethod method = RankMethod::Ordinal) {
+    using T = typename Container::value_type;
+    std::vector<size_t> idx(c.size()), r(c.size());
+    detail::ranking::compute(c, std::less<T>{}, method, idx.data(), r.data());
+    return {std::move(idx), std::move(r)};
+}
+
+template<typename Container, typename Cmp>
+std::pair<std::vector<size_t>, std::vector<size_t>>
+argsort_with_rank(const Container& c, Cmp cmp, RankMethod method = RankMethod::Ordinal) {
+    std::vector<size_t> idx(c.size()), r(c.size());
+    detail::ranking::compute(c, cmp, method, idx.data(), r.data());
+    return {std::move(idx), std::move(r)};
+}
+
+// 分段排序: offsets为CSR风格偏移（长度为段数+1），各段独立排序
+template<typename Container, typename OffContainer>
+void segmented_sort(Container& data, const OffContainer& offsets,
+                    const Options& opts = Options::defaults()) {
+    using T = typename Container::value_type;
+    if (offsets.size() < 2) return;
+    detail::segmented::sort(data.data(), offsets.data(), offsets.size() - 1,
+                            std::less<T>{}, opts);
+}
+
+template<typename Container, typename OffContainer, typename Cmp>
+void segmented_sort(Container& data, const OffContainer& offsets, Cmp cmp,
+                    const Options& opts = Options::defaults()) {
+    if (offsets.size() < 2) return;
+    detail::segmented::sort(data.data(), offsets.data(), offsets.size() - 1, cmp, opts);
+}
+
 // 按索引重排
 template<typename Container>
 void reorder(Container& c, const std::vector<size_t>& indices) {
@@ -4139,11 +8746,18 @@ size_t unique(Container& c, Pred pred) {
     return new_size;
 }
 
-// 排序并唯一化
+// 排序并唯一化 (整数键在计数/基数排序内部直接去重)
 template<typename Container>
 size_t sort_unique(Container& c, const Options& opts = Options::defaults()) {
-    sort(c, opts);
-    return unique(c);
+    using T = typename Container::value_type;
+    if constexpr (detail::traits::is_contiguous_v<Container> && std::is_integral_v<T>) {
+        size_t m = detail::dedup::sort_unique(c.data(), c.size(), nullptr, std::less<T>{}, opts);
+        c.resize(m);
+        return m;
+    } else {
+        sort(c, opts);
+        return unique(c);
+    }
 }
 
 template<typename Container, typename Cmp>
@@ -4154,13 +8768,31 @@ size_t sort_unique(Container& c, Cmp cmp, const Options& opts = Options::default
     });
 }
 
+// 排序去重并计数: 返回(升序唯一值, 对应出现次数)
+template<typename Container, typename Cmp>
+auto sort_unique_count(const Container& c, Cmp cmp, const Options& opts = Options::defaults())
+    -> std::pair<std::vector<typename Container::value_type>, std::vector<size_t>> {
+    std::vector<typename Container::value_type> values(c.begin(), c.end());
+    std::vector<size_t> counts(values.size());
+    size_t m = detail::dedup::sort_unique(values.data(), values.size(), counts.data(), cmp, opts);
+    values.resize(m);
+    counts.resize(m);
+    return {std::move(values), std::move(counts)};
+}
+
+template<typename Container>
+auto sort_unique_count(const Container& c, const Options& opts = Options::defaults())
+    -> std::pair<std::vector<typename Container::value_type>, std::vector<size_t>> {
+    return sort_unique_count(c, std::less<typename Container::value_type>{}, opts);
+}
+
 // 中位数
 template<typename Container>
-auto median(Container& c) -> typename Container::value_type {
+auto median(Container& c, const Options& opts = Options::defaults()) -> typename Container::value_type {
     if (c.empty()) return typename Container::value_type{};
     size_t n = c.size();
     auto mid = c.begin() + static_cast<std::ptrdiff_t>(n / 2);
-    std::nth_element(c.begin(), mid, c.end());
+    nth_element(c.begin(), mid, c.end(), opts);
     if (n % 2 == 1) return *mid;
     auto mid_prev = std::max_element(c.begin(), mid);
     return (*mid_prev + *mid) / 2;
@@ -4168,27 +8800,82 @@ auto median(Container& c) -> typename Container::value_type {
 
 // 第k小元素
 template<typename Container>
-auto kth_element(Container& c, size_t k) -> typename Container::value_type {
+auto kth_element(Container& c, size_t k, const Options& opts = Options::defaults())
+    -> typename Container::value_type {
     if (c.empty() || k >= c.size()) return typename Container::value_type{};
     auto it = c.begin() + static_cast<std::ptrdiff_t>(k);
-    std::nth_element(c.begin(), it, c.end());
+    nth_element(c.begin(), it, c.end(), opts);
     return *it;
 }
 
 template<typename Container, typename Cmp>
-auto kth_element(Container& c, size_t k, Cmp cmp) -> typename Container::value_type {
+auto kth_element(Container& c, size_t k, Cmp cmp, const Options& opts = Options::defaults())
+    -> typename Container::value_type {
     if (c.empty() || k >= c.size()) return typename Container::value_type{};
     auto it = c.begin() + static_cast<std::ptrdiff_t>(k);
-    std::nth_element(c.begin(), it, c.end(), cmp);
+    nth_element(c.begin(), it, c.end(), cmp, opts);
     return *it;
 }
 
+// 多个名次一次选出: 返回值与ks一一对应；结束后每个名次都已就位
+template<typename Container>
+auto kth_elements(Container& c, const std::vector<size_t>& ks,
+                  const Options& opts = Options::defaults())
+    -> std::vector<typename Container::value_type> {
+    using T = typename Container::value_type;
+    std::vector<T> out;
+    out.reserve(ks.size());
+    size_t n = c.size();
+    std::vector<size_t> order;
+    order.reserve(ks.size());
+    for (size_t k : ks) {
+        if (k < n) order.push_back(k);
+    }
+    std::sort(order.begin(), order.end());
+    order.erase(std::unique(order.begin(), order.end()), order.end());
+    
+    if constexpr (detail::traits::is_contiguous_v<Container>) {
+        std::less<T> cmp;
+        detail::selection::select_many(c.data(), 0, n, order.data(), order.size(), cmp, opts);
+    } else {
+        std::vector<T> tmp(c.begin(), c.end());
+        std::less<T> cmp;
+        detail::selection::select_many(tmp.data(), 0, n, order.data(), order.size(), cmp, opts);
+        std::copy(tmp.begin(), tmp.end(), c.begin());
+    }
+    
+    auto base = c.begin();
+    for (size_t k : ks) {
+        out.push_back(k < n ? *(base + static_cast<std::ptrdiff_t>(k)) : T{});
+    }
+    return out;
+}
+
+// 分位数 (最近名次: round(q * (n-1)))，例如 quantiles(lat, {0.5, 0.99, 0.999})
+template<typename Container>
+auto quantiles(Container& c, const std::vector<double>& qs,
+               const Options& opts = Options::defaults())
+    -> std::vector<typename Container::value_type> {
+    if (c.empty()) return std::vector<typename Container::value_type>(qs.size());
+    size_t last = c.size() - 1;
+    std::vector<size_t> ks;
+    ks.reserve(qs.size());
+    for (double q : qs) {
+        q = std::min(1.0, std::max(0.0, q));
+        ks.push_back(std::min(last, static_cast<size_t>(q * static_cast<double>(last) + 0.5)));
+    }
+    return kth_elements(c, ks, opts);
+}
+
 // 版本信息
 inline const char* version() { return FYX_VERSION; }
 inline int version_major() { return FYX_VERSION_MAJOR; }
 inline int version_minor() { return FYX_VERSION_MINOR; }
 inline int version_patch() { return FYX_VERSION_PATCH; }
 
+// 运行时选定的SIMD内核级别 ("AVX-512" / "AVX2" / "SSE4.2" / "Scalar")
+inline const char* simd_level() { return detail::simd::isa_name(detail::simd::active_isa()); }
+
 } // namespace fyx
 
 #endif // FYX_SORT_V9_HPP
@@ -4204,6 +8891,8 @@ inline int version_patch() { return FYX_VERSION_PATCH; }
 #include <chrono>
 #include <random>
 #include <deque>
+#include <map>
+#include <string>
 
 struct Large { 
     int key; 
@@ -4213,27 +8902,102 @@ struct Large {
 };
 
 template<typename T, typename Gen>
-void bench(const char* name, size_t n, Gen gen, int runs = 5) {
+void bench(const char* name, size_t n, Gen gen, int runs = 5) {
+    double fyx_time = 0, std_time = 0;
+    bool correct = true;
+    std::mt19937 rng(42);
+    
+    for (int r = 0; r < runs; ++r) {
+        std::vector<T> data(n);
+        for (auto& x : data) x = gen(rng);
+        auto a = data, b = data;
+        
+        auto t1 = std::chrono::high_resolution_clock::now();
+        fyx::sort(a);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        fyx_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        
+        t1 = std::chrono::high_resolution_clock::now();
+        std::sort(b.begin(), b.end());
+        t2 = std::chrono::high_resolution_clock::now();
+        std_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        
+        if (!fyx::is_sorted(a) || a != b) correct = false;
+    }
+    
+    double speedup = std_time / fyx_time;
+    const char* status = correct ? "? OK" : "? FAIL";
+    
+    std::cout << std::setw(22) << name << " │ " 
+              << std::setw(10) << n << " │ "
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << fyx_time/runs << " ms │ "
+              << std::setw(10) << std_time/runs << " ms │ "
+              << std::setw(7) << speedup << "x │ "
+              << status << "\n";
+}
+
+template<typename T, typename Gen>
+void bench_partial(const char* name, size_t n, double ratio, Gen gen, int runs = 5) {
+    double fyx_time = 0, std_time = 0;
+    bool correct = true;
+    std::mt19937 rng(42);
+    size_t k = std::max<size_t>(1, static_cast<size_t>(n * ratio));
+    
+    for (int r = 0; r < runs; ++r) {
+        std::vector<T> data(n);
+        for (auto& x : data) x = gen(rng);
+        auto a = data, b = data;
+        
+        auto t1 = std::chrono::high_resolution_clock::now();
+        fyx::partial_sort(a.begin(), a.begin() + k, a.end());
+        auto t2 = std::chrono::high_resolution_clock::now();
+        fyx_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        
+        t1 = std::chrono::high_resolution_clock::now();
+        std::partial_sort(b.begin(), b.begin() + k, b.end());
+        t2 = std::chrono::high_resolution_clock::now();
+        std_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        
+        if (!std::equal(a.begin(), a.begin() + k, b.begin())) correct = false;
+    }
+    
+    double speedup = std_time / fyx_time;
+    const char* status = correct ? "? OK" : "? FAIL";
+    
+    std::cout << std::setw(22) << name << " │ " 
+              << std::setw(10) << k << " │ "
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << fyx_time/runs << " ms │ "
+              << std::setw(10) << std_time/runs << " ms │ "
+              << std::setw(7) << speedup << "x │ "
+              << status << "\n";
+}
+
+// pdq模式对比: 自定义比较器绕开基数/向量快排，直接测pdq::sort对输入模式的适应性
+template<typename T, typename Gen>
+void bench_pattern(const char* name, size_t n, Gen gen, int runs = 5) {
     double fyx_time = 0, std_time = 0;
     bool correct = true;
     std::mt19937 rng(42);
+    auto cmp = [](const T& x, const T& y) { return x < y; };
     
     for (int r = 0; r < runs; ++r) {
         std::vector<T> data(n);
-        for (auto& x : data) x = gen(rng);
+        for (size_t i = 0; i < n; ++i) data[i] = gen(rng, i, n);
         auto a = data, b = data;
         
         auto t1 = std::chrono::high_resolution_clock::now();
-        fyx::sort(a);
+        fyx::detail::pdq::sort(a.data(), n, cmp);
         auto t2 = std::chrono::high_resolution_clock::now();
         fyx_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
         
         t1 = std::chrono::high_resolution_clock::now();
-        std::sort(b.begin(), b.end());
+        std::sort(b.begin(), b.end(), cmp);
         t2 = std::chrono::high_resolution_clock::now();
         std_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
         
-        if (!fyx::is_sorted(a) || a != b) correct = false;
+        if (a != b) correct = false;
     }
     
     double speedup = std_time / fyx_time;
@@ -4248,6 +9012,43 @@ void bench(const char* name, size_t n, Gen gen, int runs = 5) {
               << status << "\n";
 }
 
+#ifdef FYX_AVX512CD_KERNELS
+// 直方图内核对比: 分散计数器 vs 冲突检测，以及histogram_512实际选用的版本
+template<typename T, typename Gen>
+void bench_histogram(const char* name, size_t n, Gen gen, int runs = 20) {
+    namespace S5 = fyx::detail::simd512;
+    std::mt19937 rng(42);
+    std::vector<T> data(n);
+    for (auto& x : data) x = gen(rng);
+    
+    alignas(64) size_t h1[256], h2[256];
+    double split_time = 0, conflict_time = 0;
+    for (int r = 0; r < runs; ++r) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        S5::histogram_split_512(data.data(), n, h1, 0);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        S5::histogram_conflict_512(data.data(), n, h2, 0);
+        auto t3 = std::chrono::high_resolution_clock::now();
+        split_time += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        conflict_time += std::chrono::duration<double, std::milli>(t3 - t2).count();
+    }
+#ifdef FYX_CONFLICT_HISTOGRAM
+    bool skewed = S5::histogram_skewed(data.data(), n, 0);
+#else
+    bool skewed = false;   // 未开启时histogram_512总是用分散计数器
+#endif
+    const char* status = std::equal(h1, h1 + 256, h2) ? "? OK" : "? FAIL";
+    
+    std::cout << std::setw(22) << name << " │ "
+              << std::setw(10) << n << " │ "
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << split_time/runs << " ms │ "
+              << std::setw(10) << conflict_time/runs << " ms │ "
+              << std::setw(8) << (skewed ? "冲突检测" : "分散计数") << " │ "
+              << status << "\n";
+}
+#endif
+
 int main() {
     std::cout << R"(
 ╔═══════════════════════════════════════════════════════════════════════════════╗
@@ -4269,16 +9070,17 @@ int main() {
     std::cout << "  线程数: " << fyx::config::num_threads() << "\n";
     std::cout << "  SIMD宽度: " << FYX_SIMD_WIDTH << " 字节\n";
 #ifdef FYX_AVX512_FULL
-    std::cout << "  SIMD: AVX-512 (完整)\n";
+    std::cout << "  编译期SIMD: AVX-512 (完整)\n";
 #elif defined(FYX_AVX512)
-    std::cout << "  SIMD: AVX-512\n";
+    std::cout << "  编译期SIMD: AVX-512\n";
 #elif defined(FYX_AVX2)
-    std::cout << "  SIMD: AVX2\n";
+    std::cout << "  编译期SIMD: AVX2\n";
 #elif defined(FYX_SSE42)
-    std::cout << "  SIMD: SSE4.2\n";
+    std::cout << "  编译期SIMD: SSE4.2\n";
 #else
-    std::cout << "  SIMD: 标量\n";
+    std::cout << "  编译期SIMD: 标量\n";
 #endif
+    std::cout << "  运行时内核: " << fyx::simd_level() << "\n";
     std::cout << "\n";
     
     // ═══════════════════════════════════════════════════════════════════
@@ -4321,6 +9123,343 @@ int main() {
         return true;
     });
     
+    test("运行时ISA分派 (各级内核一致)", [&]() {
+        namespace S = fyx::detail::simd;
+        using S::Isa;
+        for (Isa isa : {Isa::Scalar, Isa::SSE42, Isa::AVX2, Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            auto k = S::make_kernels<int32_t>(isa);
+            auto kd = S::make_kernels<double>(isa);
+            std::vector<int32_t> a(1000);
+            for (auto& x : a) x = static_cast<int32_t>(rng());
+            auto mm = k.find_minmax(a.data(), a.size());
+            auto ref = std::minmax_element(a.begin(), a.end());
+            if (mm.first != *ref.first || mm.second != *ref.second) return false;
+            
+            size_t h1[256] = {}, h2[256] = {};
+            k.histogram(a.data(), a.size(), h1, 8);
+            S::histogram_scalar(a.data(), a.size(), h2, 8);
+            if (!std::equal(h1, h1 + 256, h2)) return false;
+            
+            size_t off[256], pos = 0;
+            for (int b = 0; b < 256; ++b) { off[b] = pos; pos += h1[b]; }
+            std::vector<int32_t> out(a.size()), out2(a.size());
+            size_t off2[256];
+            std::copy(off, off + 256, off2);
+            k.scatter(a.data(), out.data(), a.size(), off, 8);
+            S::scatter_scalar(a.data(), out2.data(), a.size(), off2, 8);
+            if (out != out2) return false;
+            
+            for (size_t n : {8, 16, 32, 64, 128}) {
+                std::vector<int32_t> s(a.begin(), a.begin() + n), r = s;
+                if (k.sort_small(s.data(), n)) {
+                    std::sort(r.begin(), r.end());
+                    if (s != r) return false;
+                }
+                std::vector<double> d(n);
+                for (auto& x : d) x = static_cast<double>(static_cast<int32_t>(rng()));
+                std::vector<double> rd = d;
+                if (kd.sort_small(d.data(), n)) {
+                    std::sort(rd.begin(), rd.end());
+                    if (d != rd) return false;
+                }
+            }
+        }
+        return std::string(fyx::simd_level()).size() > 0;
+    });
+
+    test("SSE4.2内核 (极值/直方图/网络/有序前缀)", [&]() {
+        namespace S = fyx::detail::simd;
+        auto check = [&](auto tag, S::Isa isa) {
+            using T = decltype(tag);
+            auto k = S::make_kernels<T>(isa);
+            for (size_t n : {0, 1, 5, 17, 100, 1001}) {
+                std::vector<T> a(n);
+                for (auto& x : a) {
+                    uint64_t r = (static_cast<uint64_t>(rng()) << 32) | rng();
+                    if constexpr (std::is_floating_point_v<T>) x = static_cast<T>(static_cast<int32_t>(r)) / 3;
+                    else std::memcpy(&x, &r, sizeof(T));
+                }
+                if (n > 0) {
+                    auto mm = k.find_minmax(a.data(), n);
+                    auto ref = std::minmax_element(a.begin(), a.end());
+                    if (mm.first != *ref.first || mm.second != *ref.second) return false;
+                }
+                size_t h1[256] = {}, h2[256] = {};
+                k.histogram(a.data(), n, h1, 0);
+                S::histogram_scalar(a.data(), n, h2, 0);
+                if (!std::equal(h1, h1 + 256, h2)) return false;
+                
+                // 有序前缀: 整体有序、在各位置插入一处逆序
+                std::sort(a.begin(), a.end());
+                if (k.sorted_prefix(a.data(), n) != n) return false;
+                for (size_t p = 1; p < n; p += 7) {
+                    auto b = a;
+                    if (!(b[p] < b[p - 1]) && b[p - 1] < b[n - 1]) {
+                        b[p - 1] = b[n - 1];
+                        if (k.sorted_prefix(b.data(), n) != static_cast<size_t>(
+                                std::is_sorted_until(b.begin(), b.end()) - b.begin())) return false;
+                    }
+                }
+            }
+            return true;
+        };
+        for (S::Isa isa : {S::Isa::Scalar, S::Isa::SSE42, S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            if (!check(int8_t{}, isa) || !check(uint8_t{}, isa) || !check(int16_t{}, isa) ||
+                !check(uint16_t{}, isa) || !check(int32_t{}, isa) || !check(uint32_t{}, isa) ||
+                !check(int64_t{}, isa) || !check(uint64_t{}, isa) || !check(float{}, isa) ||
+                !check(double{}, isa)) return false;
+        }
+        if (S::active_isa() < S::Isa::SSE42) return true;
+        auto k = S::make_kernels<int32_t>(S::Isa::SSE42);
+        for (size_t n : {4, 8, 16}) {
+            for (int rep = 0; rep < 200; ++rep) {
+                std::vector<int32_t> a(n);
+                for (auto& x : a) x = static_cast<int32_t>(rng() % 8) - 4;
+                auto r = a;
+                std::sort(r.begin(), r.end());
+                if (!k.sort_small(a.data(), n) || a != r) return false;
+            }
+        }
+        return std::string(S::isa_name(S::Isa::SSE42)) == "SSE4.2";
+    });
+
+    test("有序性扫描 (前缀/游程/is_sorted)", [&]() {
+        namespace S = fyx::detail::simd;
+        auto check = [&](auto tag, S::Isa isa) {
+            using T = decltype(tag);
+            auto k = S::make_kernels<T>(isa);
+            for (size_t n : {0, 1, 2, 31, 64, 65, 300, 1000}) {
+                // 小值域随机游走: 相等、上升、下降混杂，游程长短不一
+                std::vector<T> a(n);
+                int v = 0;
+                for (auto& x : a) { v += static_cast<int>(rng() % 5) - 2; x = static_cast<T>(v & 63); }
+                size_t desc = 0, ascn = 0;
+                for (size_t i = 1; i < n; ++i) { desc += a[i] < a[i - 1]; ascn += a[i - 1] < a[i]; }
+                if (k.count_descents(a.data(), n) != desc || k.count_ascents(a.data(), n) != ascn) return false;
+                for (size_t from = 0; from < n; from += 1 + rng() % 97) {
+                    const T* p = a.data() + from;
+                    size_t m = n - from;
+                    if (k.sorted_prefix(p, m) != static_cast<size_t>(std::is_sorted_until(p, p + m) - p)) return false;
+                    if (k.reverse_prefix(p, m) != static_cast<size_t>(
+                            std::is_sorted_until(p, p + m, std::greater<T>()) - p)) return false;
+                }
+                std::sort(a.begin(), a.end(), std::greater<T>());
+                if (k.reverse_prefix(a.data(), n) != n || k.count_ascents(a.data(), n) != 0) return false;
+            }
+            return true;
+        };
+        for (S::Isa isa : {S::Isa::Scalar, S::Isa::SSE42, S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            if (!check(int8_t{}, isa) || !check(uint8_t{}, isa) || !check(int16_t{}, isa) ||
+                !check(uint16_t{}, isa) || !check(int32_t{}, isa) || !check(uint32_t{}, isa) ||
+                !check(int64_t{}, isa) || !check(uint64_t{}, isa) || !check(float{}, isa) ||
+                !check(double{}, isa)) return false;
+        }
+        
+        // 接近有序时游程数为精确值；公共is_sorted各重载
+        std::vector<int32_t> a(100000);
+        std::iota(a.begin(), a.end(), 0);
+        for (size_t i = 1000; i < a.size(); i += 1000) std::swap(a[i - 1], a[i]);
+        std::less<int32_t> lt;
+        auto prof = fyx::detail::adaptive::analyze(a.data(), a.size(), lt);
+        if (prof.is_sorted || prof.run_count != 100) return false;
+        std::vector<double> d = {3.0, 2.0, 2.0, -1.0};
+        std::deque<int> l = {1, 2, 2, 5};
+        return !fyx::is_sorted(a) && !fyx::is_sorted(a.begin(), a.end()) &&
+               fyx::is_sorted(a.begin(), a.begin() + 999) &&
+               fyx::is_sorted(d, std::greater<double>()) && !fyx::is_sorted(d) &&
+               fyx::is_sorted(d.data(), d.data() + d.size(), std::greater<>()) &&
+               fyx::is_sorted(l) && fyx::is_sorted(l.begin(), l.end(), std::less<int>());
+    });
+
+    test("冲突检测直方图 (均匀/倾斜分布)", [&]() {
+#ifdef FYX_AVX512CD_KERNELS
+        namespace S = fyx::detail::simd;
+        namespace S5 = fyx::detail::simd512;
+        if (S::active_isa() != S::Isa::AVX512 || !fyx::cpu::get_features().avx512cd) return true;
+        auto check = [&](auto tag) {
+            using T = decltype(tag);
+            for (int skew : {0, 1}) {
+                std::vector<T> a(10007);
+                for (auto& x : a) {
+                    uint64_t r = (static_cast<uint64_t>(rng()) << 32) | rng();
+                    if (skew && rng() % 10 < 9) r = 0x0707070707070707ULL;
+                    if constexpr (std::is_floating_point_v<T>) x = static_cast<T>(static_cast<int64_t>(r)) / T(7);
+                    else std::memcpy(&x, &r, sizeof(T));
+                }
+                if (S5::histogram_skewed(a.data(), a.size(), 0) != (skew == 1)) return false;
+                for (int shift = 0; shift < static_cast<int>(sizeof(T) * 8); shift += 8) {
+                    size_t h1[256] = {}, h2[256] = {}, h3[256] = {};
+                    S5::histogram_conflict_512(a.data(), a.size(), h1, shift);
+                    S5::histogram_512(a.data(), a.size(), h2, shift);
+                    S::histogram_scalar(a.data(), a.size(), h3, shift);
+                    if (!std::equal(h1, h1 + 256, h3) || !std::equal(h2, h2 + 256, h3)) return false;
+                }
+            }
+            return true;
+        };
+        return check(int8_t{}) && check(uint16_t{}) && check(int32_t{}) && check(uint32_t{}) &&
+               check(float{}) && check(int64_t{}) && check(double{});
+#else
+        return true;
+#endif
+    });
+
+    test("基数键变换 (往返/与Mapper一致)", [&]() {
+        namespace S = fyx::detail::simd;
+        auto check = [&](auto tag, S::Isa isa) {
+            using T = decltype(tag);
+            using M = fyx::detail::keymap::Mapper<T>;
+            using K = typename M::Key;
+            std::vector<T> a(301);
+            for (auto& x : a) {
+                uint64_t r = (static_cast<uint64_t>(rng()) << 32) | rng();
+                std::memcpy(&x, &r, sizeof(T));   // 浮点包含NaN/无穷/非规格化数
+            }
+            if constexpr (std::is_floating_point_v<T>) {
+                a[0] = T(-0.0); a[1] = T(0.0);
+                a[2] = -std::numeric_limits<T>::infinity();
+            }
+            auto orig = a;
+            auto k = S::make_kernels<T>(isa);
+            std::vector<K> keys(a.size());
+            k.to_keys(a.data(), keys.data(), a.size());
+            for (size_t i = 0; i < a.size(); ++i) if (keys[i] != M::to_key(orig[i])) return false;
+            std::vector<T> back(a.size());
+            k.from_keys(keys.data(), back.data(), a.size());
+            if (std::memcmp(back.data(), orig.data(), a.size() * sizeof(T)) != 0) return false;
+            if constexpr (std::is_integral_v<T>) {
+                // 整数原地往返
+                k.to_keys(a.data(), reinterpret_cast<K*>(a.data()), a.size());
+                for (size_t i = 0; i < a.size(); ++i) if (static_cast<K>(a[i]) != M::to_key(orig[i])) return false;
+                k.from_keys(reinterpret_cast<K*>(a.data()), a.data(), a.size());
+            }
+            return std::memcmp(a.data(), orig.data(), a.size() * sizeof(T)) == 0;
+        };
+        for (S::Isa isa : {S::Isa::Scalar, S::Isa::SSE42, S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            if (!check(float{}, isa) || !check(double{}, isa) || !check(int8_t{}, isa) ||
+                !check(int16_t{}, isa) || !check(int32_t{}, isa) || !check(int64_t{}, isa)) return false;
+        }
+        
+        // 开关变换结果逐位一致 (含±0与负数)
+        std::vector<double> d(200000);
+        for (auto& x : d) x = (rng() % 8 == 0) ? ((rng() & 1) ? -0.0 : 0.0)
+                                               : static_cast<double>(static_cast<int32_t>(rng())) / 16;
+        std::vector<int64_t> v(200000);
+        for (auto& x : v) x = static_cast<int64_t>((static_cast<uint64_t>(rng()) << 32) | rng());
+        auto d1 = d, d2 = d;
+        auto v1 = v, v2 = v;
+        fyx::Options on = fyx::Options::sequential(), off = on;
+        off.transform_keys = false;
+        fyx::sort(d1, on);
+        fyx::sort(d2, off);
+        fyx::sort(v1, on);
+        fyx::sort(v2, off);
+        std::sort(v.begin(), v.end());
+        return std::memcmp(d1.data(), d2.data(), d.size() * sizeof(double)) == 0 &&
+               v1 == v && v2 == v && std::is_sorted(d1.begin(), d1.end());
+    });
+
+    test("SIMD小数组排序 (8~64位整数)", [&]() {
+        namespace S = fyx::detail::simd;
+        for (S::Isa isa : {S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            auto check = [&](auto tag) {
+                using T = decltype(tag);
+                auto k = S::make_kernels<T>(isa);
+                for (size_t n = 2; n <= fyx::config::SIMD_RANK_SORT_LIMIT; ++n) {
+                    for (int iter = 0; iter < 8; ++iter) {
+                        std::vector<T> a(n);
+                        for (auto& x : a) x = static_cast<T>(iter % 2 ? rng() % 4 : rng());
+                        auto b = a;
+                        std::sort(b.begin(), b.end());
+                        if (k.sort_small(a.data(), n) && a != b) return false;
+                    }
+                }
+                return true;
+            };
+            if (!check(int8_t{}) || !check(uint8_t{}) || !check(int16_t{}) || !check(uint16_t{}) ||
+                !check(int32_t{}) || !check(uint32_t{}) || !check(int64_t{}) || !check(uint64_t{}) ||
+                !check(char{}) || !check(static_cast<long long>(0))) return false;
+        }
+        std::vector<int16_t> v(5000);
+        for (auto& x : v) x = static_cast<int16_t>(rng());
+        auto w = v;
+        fyx::sort(v, fyx::Options::comparison_only());
+        std::sort(w.begin(), w.end());
+        return v == w;
+    });
+    
+    test("补齐双调网络 (任意n ≤ 256，不越界)", [&]() {
+        namespace S = fyx::detail::simd;
+        auto check = [&](auto tag, S::Isa isa) {
+            using T = decltype(tag);
+            auto k = S::make_kernels<T>(isa);
+            for (size_t n = 2; n <= fyx::config::SIMD_NETWORK_LIMIT; n += 1 + n / 16) {
+                for (int iter = 0; iter < 4; ++iter) {
+                    // 末尾留哨兵检查掩码写回没有越界
+                    std::vector<T> a(n + 16, static_cast<T>(7));
+                    for (size_t i = 0; i < n; ++i) {
+                        uint64_t r = iter % 2 ? rng() % 5 : (static_cast<uint64_t>(rng()) << 32) | rng();
+                        if constexpr (std::is_floating_point_v<T>) a[i] = static_cast<T>(static_cast<int64_t>(r)) / 3;
+                        else std::memcpy(&a[i], &r, sizeof(T));
+                    }
+                    auto b = a;
+                    std::sort(b.begin(), b.begin() + n);
+                    bool done = k.sort_small(a.data(), n);
+                    if (done && a != b) return false;
+                    if (!done && isa >= S::Isa::AVX2) return false;
+                }
+            }
+            return true;
+        };
+        for (S::Isa isa : {S::Isa::SSE42, S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            if (!check(int8_t{}, isa) || !check(uint16_t{}, isa) || !check(int32_t{}, isa) ||
+                !check(uint32_t{}, isa) || !check(int64_t{}, isa) || !check(uint64_t{}, isa) ||
+                !check(float{}, isa) || !check(double{}, isa)) return false;
+        }
+        // 含NaN的浮点交给标量路径；公共入口的小数组同样走网络
+        std::vector<double> d(37);
+        for (auto& x : d) x = static_cast<double>(rng() % 100);
+        d[5] = std::numeric_limits<double>::quiet_NaN();
+        if (S::active_isa() >= S::Isa::AVX2 && S::kernels<double>().sort_small(d.data(), d.size())) return false;
+        for (size_t n : {17, 100, 255}) {
+            std::vector<float> f(n);
+            for (auto& x : f) x = static_cast<float>(static_cast<int32_t>(rng())) / 7;
+            auto g = f;
+            fyx::sort(f);
+            std::sort(g.begin(), g.end());
+            if (f != g) return false;
+        }
+        // ±0比较相等，==查不出丢失/复制的-0.0: 按位模式比较输入输出的多重集
+        auto zeros = [&](auto tag) {
+            using T = decltype(tag);
+            using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            auto bits = [](const std::vector<T>& v) {
+                std::vector<U> r(v.size());
+                if (!v.empty()) std::memcpy(r.data(), v.data(), v.size() * sizeof(T));
+                std::sort(r.begin(), r.end());
+                return r;
+            };
+            for (size_t n : {8, 16, 100, 200, 256}) {
+                std::vector<T> v(n);
+                for (auto& x : v) {
+                    uint32_t r = rng() % 4;
+                    x = r == 0 ? T(-0.0) : r == 1 ? T(0.0) : static_cast<T>(static_cast<int>(rng() % 7) - 3);
+                }
+                auto u = v;
+                fyx::sort(u);
+                if (!std::is_sorted(u.begin(), u.end()) || bits(u) != bits(v)) return false;
+            }
+            return true;
+        };
+        return zeros(float{}) && zeros(double{});
+    });
+    
     test("大数组 (1M)", [&]() {
         std::vector<int> a(1000000);
         for (auto& x : a) x = static_cast<int>(rng());
@@ -4351,7 +9490,75 @@ int main() {
         auto b = a; fyx::sort(a); std::sort(b.begin(), b.end());
         return a == b;
     });
-    
+
+    test("向量化快排 (force_comparison)", [&]() {
+        auto check = [&](auto tag) {
+            using T = decltype(tag);
+            for (size_t n : {255, 256, 1000, 4099, 100000}) {
+                for (int pat = 0; pat < 4; ++pat) {
+                    std::vector<T> a(n);
+                    for (size_t i = 0; i < n; ++i) {
+                        switch (pat) {
+                            case 0: a[i] = static_cast<T>(rng()); break;
+                            case 1: a[i] = static_cast<T>(rng() % 4); break;
+                            case 2: a[i] = static_cast<T>(i < n / 2 ? i : n - i); break;
+                            default: a[i] = static_cast<T>(7); break;
+                        }
+                    }
+                    auto b = a;
+                    fyx::sort(a, fyx::Options::comparison_only());
+                    std::sort(b.begin(), b.end());
+                    if (a != b) return false;
+                }
+            }
+            return true;
+        };
+        if (!check(int32_t{}) || !check(uint32_t{}) || !check(int64_t{}) ||
+            !check(uint64_t{}) || !check(float{}) || !check(double{})) return false;
+
+        // NaN不满足严格弱序，只要求结果仍是原数据的一个排列
+        std::vector<double> d(5000);
+        for (auto& x : d) x = (rng() % 10 == 0) ? std::nan("") : static_cast<double>(rng() % 1000);
+        auto e = d;
+        fyx::sort(d, fyx::Options::comparison_only());
+        auto key = [](double x) { return std::isnan(x) ? 1e300 : x; };
+        std::vector<double> kd, ke;
+        for (double x : d) kd.push_back(key(x));
+        for (double x : e) ke.push_back(key(x));
+        std::sort(kd.begin(), kd.end());
+        std::sort(ke.begin(), ke.end());
+        if (kd != ke) return false;
+
+        std::vector<int> g(20000);
+        for (auto& x : g) x = static_cast<int>(rng());
+        auto h = g;
+        fyx::sort(g, std::greater<int>());
+        std::sort(h.begin(), h.end(), std::greater<int>());
+        return g == h;
+    });
+
+    test("向量化分区 (AVX2置换表/AVX-512压缩)", [&]() {
+        namespace S = fyx::detail::simd;
+        for (S::Isa isa : {S::Isa::AVX2, S::Isa::AVX512}) {
+            if (isa > S::active_isa()) break;
+            auto check = [&](auto tag) {
+                using T = decltype(tag);
+                for (size_t n : {256, 263, 5000, 70001}) {
+                    std::vector<T> a(n);
+                    for (auto& x : a) x = static_cast<T>(rng() % (n / 2));
+                    auto b = a;
+                    if (!fyx::detail::vqsort::sort(a.data(), n, isa)) return false;
+                    std::sort(b.begin(), b.end());
+                    if (a != b) return false;
+                }
+                return true;
+            };
+            if (!check(int32_t{}) || !check(uint32_t{}) || !check(int64_t{}) ||
+                !check(uint64_t{}) || !check(float{}) || !check(double{})) return false;
+        }
+        return true;
+    });
+
     test("已排序", [&]() {
         std::vector<int> a(100000);
         std::iota(a.begin(), a.end(), 0);
@@ -4381,7 +9588,139 @@ int main() {
             if (a[i].k == a[i-1].k && a[i].v < a[i-1].v) return false;
         return true;
     });
+
+    test("SIMD流式归并 (merge::sort整数键)", [&]() {
+        namespace D = fyx::detail;
+        auto check = [&](auto tag) {
+            using T = decltype(tag);
+            for (int iter = 0; iter < 300; ++iter) {
+                size_t na = rng() % 150, nb = rng() % 150;
+                std::vector<T> a(na), b(nb), ref(na + nb);
+                for (auto& x : a) x = static_cast<T>(iter % 3 ? rng() : rng() % 3);
+                for (auto& x : b) x = static_cast<T>(iter % 5 ? rng() : std::numeric_limits<T>::max());
+                std::sort(a.begin(), a.end());
+                std::sort(b.begin(), b.end());
+                std::merge(a.begin(), a.end(), b.begin(), b.end(), ref.begin());
+                std::vector<T> out(na + nb);
+                D::merge::merge_runs(a.data(), na, b.data(), nb, out.data());
+                if (out != ref) return false;
+#ifdef FYX_AVX2_KERNELS
+                if (D::simd::active_isa() >= D::simd::Isa::AVX2 && na && nb) {
+                    std::fill(out.begin(), out.end(), T{});
+                    D::merge::merge_stream_256(a.data(), na, b.data(), nb, out.data());
+                    if (out != ref) return false;
+                }
+#endif
+            }
+            std::vector<T> v(100000);
+            for (auto& x : v) x = static_cast<T>(rng());
+            auto w = v;
+            std::less<T> cmp;
+            D::merge::sort(v.data(), v.size(), cmp);
+            std::sort(w.begin(), w.end());
+            return v == w;
+        };
+        return check(int32_t{}) && check(uint32_t{}) && check(int64_t{}) && check(uint64_t{});
+    });
     
+    test("自然游程归并 (powersort/飞驰，稳定)", [&]() {
+        namespace D = fyx::detail;
+        struct KV { int k; int v; };
+        auto by_key = [](const KV& x, const KV& y) { return x.k < y.k; };
+        for (size_t n : {2, 7, 31, 33, 64, 65, 1000, 50000}) {
+            for (int d = 0; d < 6; ++d) {
+                std::vector<KV> a(n);
+                for (size_t i = 0; i < n; ++i) {
+                    int k;
+                    switch (d) {
+                        case 0: k = static_cast<int>(rng() % 100); break;
+                        case 1: k = static_cast<int>((i % 997) / 3); break;        // 有序块拼接
+                        case 2: k = -static_cast<int>(i / 5); break;               // 非严格递减
+                        case 3: k = static_cast<int>(i < n / 2 ? i : i - n / 2); break;
+                        case 4: k = static_cast<int>(i % 2 ? i : n + i); break;    // 两段交错
+                        default: k = static_cast<int>(i % 500 ? i / 7 : rng() % 100); break;
+                    }
+                    a[i] = {k, static_cast<int>(i)};
+                }
+                auto b = a;
+                size_t calls = 0;
+                auto counted = [&](const KV& x, const KV& y) { ++calls; return by_key(x, y); };
+                D::merge::sort(a.data(), n, counted);
+                std::stable_sort(b.begin(), b.end(), by_key);
+                for (size_t i = 0; i < n; ++i) {
+                    if (a[i].k != b[i].k || a[i].v != b[i].v) return false;
+                }
+                // 两段有序拼接: 游程识别 + 一次归并，比较次数线性 (小n整段按最短游程插入)
+                if (d == 3 && n >= 1000 && calls > 3 * n) return false;
+            }
+        }
+        // 非平凡类型经暂存区搬移
+        std::vector<std::string> s(20000);
+        for (size_t i = 0; i < s.size(); ++i) s[i] = std::to_string(i % 4000 < 2000 ? i : rng() % 1000);
+        auto t = s;
+        std::less<std::string> sl;
+        D::merge::sort(s.data(), s.size(), sl);
+        std::stable_sort(t.begin(), t.end());
+        if (s != t) return false;
+        // 整数键: 有序块拼接走自然游程 + SIMD归并
+        std::vector<int64_t> x(100000);
+        for (size_t i = 0; i < x.size(); ++i) x[i] = static_cast<int64_t>(i % 3000) * 7 - static_cast<int64_t>(i / 3000);
+        auto y = x;
+        std::less<int64_t> il;
+        D::merge::sort(x.data(), x.size(), il);
+        std::sort(y.begin(), y.end());
+        return x == y;
+    });
+    
+    test("有界内存稳定排序 (暂存区受限)", [&]() {
+        namespace D = fyx::detail;
+        struct KV { int k; int v; };
+        auto by_key = [](const KV& x, const KV& y) { return x.k < y.k; };
+        auto make = [&](size_t n, int d) {
+            std::vector<KV> a(n);
+            for (size_t i = 0; i < n; ++i) {
+                int k = d == 0 ? static_cast<int>(rng() % 50)
+                      : d == 1 ? static_cast<int>(i % 777)
+                               : static_cast<int>(i % 2 ? i : n - i);
+                a[i] = {k, static_cast<int>(i)};
+            }
+            return a;
+        };
+        auto same = [](const std::vector<KV>& x, const std::vector<KV>& y) {
+            for (size_t i = 0; i < x.size(); ++i) {
+                if (x[i].k != y[i].k || x[i].v != y[i].v) return false;
+            }
+            return true;
+        };
+        // 暂存区从零到√n: 放不下的归并靠切分旋转完成
+        for (size_t n : {100, 5000, 60000}) {
+            for (int d = 0; d < 3; ++d) {
+                for (size_t cap : {size_t(0), size_t(3), static_cast<size_t>(std::sqrt(double(n)))}) {
+                    auto a = make(n, d);
+                    auto b = a;
+                    std::vector<KV> buf(cap + 1);
+                    D::merge::natural_sort<false>(a.data(), n, buf.data(), cap, by_key);
+                    std::stable_sort(b.begin(), b.end(), by_key);
+                    if (!same(a, b)) return false;
+                }
+            }
+        }
+        // 内存上限压低后公共接口仍然稳定，整数键照样排好
+        size_t saved = fyx::config::available_memory();
+        fyx::config::set_memory_limit(4096);
+        auto a = make(200000, 0);
+        auto b = a;
+        fyx::stable_sort(a, by_key);
+        std::stable_sort(b.begin(), b.end(), by_key);
+        std::vector<int64_t> x(200000);
+        for (auto& v : x) v = static_cast<int64_t>(rng());
+        auto y = x;
+        fyx::stable_sort(x);
+        fyx::config::set_memory_limit(saved);
+        std::sort(y.begin(), y.end());
+        return same(a, b) && x == y;
+    });
+
     test("并行排序", [&]() {
         std::vector<int> a(1000000);
         for (auto& x : a) x = static_cast<int>(rng());
@@ -4400,6 +9739,101 @@ int main() {
         return a == b;
     });
     
+    test("分块无分支分区 (pdq各种分布)", [&]() {
+        namespace P = fyx::detail::pdq;
+        auto lt = [](int a, int b) { return a < b; };
+        // 分区本身: 枢轴左侧全小于、右侧全不小于
+        for (size_t n : {3, 65, 129, 1000, 4099}) {
+            std::vector<int> a(n);
+            for (auto& x : a) x = static_cast<int>(rng() % (n / 2 + 1));
+            P::choose_pivot(a.data(), n, lt);
+            int pv = a[0];
+            int* mid = P::partition_right_branchless(a.data(), a.data() + n, lt).first;
+            if (*mid != pv) return false;
+            for (int* q = a.data(); q < mid; ++q) if (!(*q < pv)) return false;
+            for (int* q = mid; q < a.data() + n; ++q) if (*q < pv) return false;
+        }
+        auto fill = [&](std::vector<int>& a, int d) {
+            size_t n = a.size();
+            for (size_t i = 0; i < n; ++i) {
+                switch (d) {
+                    case 0: a[i] = static_cast<int>(rng()); break;
+                    case 1: a[i] = static_cast<int>(rng() % 4); break;
+                    case 2: a[i] = static_cast<int>(i); break;
+                    case 3: a[i] = static_cast<int>(n - i); break;
+                    case 4: a[i] = static_cast<int>(i < n / 2 ? i : n - i); break;
+                    default: a[i] = static_cast<int>(i % 100); break;
+                }
+            }
+        };
+        for (int d = 0; d < 6; ++d) {
+            std::vector<int> a(30000);
+            fill(a, d);
+            std::vector<std::pair<int, int>> pr(a.size());
+            std::vector<std::string> str(3000);
+            for (size_t i = 0; i < a.size(); ++i) pr[i] = {a[i], static_cast<int>(i)};
+            for (size_t i = 0; i < str.size(); ++i) str[i] = std::to_string(a[i]);
+            auto b = a;
+            auto pb = pr;
+            auto sb = str;
+            P::sort(a.data(), a.size(), lt);
+            P::sort(pr.data(), pr.size(), [](const auto& x, const auto& y) { return x.first < y.first; });
+            P::sort(str.data(), str.size(), std::less<std::string>());
+            std::sort(b.begin(), b.end());
+            std::sort(sb.begin(), sb.end());
+            if (a != b || str != sb) return false;
+            for (size_t i = 0; i < pr.size(); ++i) if (pr[i].first != b[i]) return false;
+            std::sort(pr.begin(), pr.end());
+            std::sort(pb.begin(), pb.end());
+            if (pr != pb) return false;
+        }
+        return true;
+    });
+    
+    test("模式破坏 (pdq过偏分区/近似有序)", [&]() {
+        namespace D = fyx::detail;
+        auto lt = [](int a, int b) { return a < b; };
+        // 限量插入: 搬移不超过上限时排好并返回true，否则中途放弃
+        std::vector<int> p = {1, 2, 4, 3, 5, 6, 8, 7};
+        if (!D::insertion::partial_sort(p.data(), p.size(), lt) || !std::is_sorted(p.begin(), p.end())) return false;
+        std::vector<int> q = {9, 8, 7, 6, 5, 4, 3, 2, 1};
+        if (D::insertion::partial_sort(q.data(), q.size(), lt)) return false;
+        // 无哨兵检查的插入排序依赖a[-1]
+        std::vector<int> g = {0, 5, 3, 3, 9, 1, 7, 2, 8, 4, 6, 1};
+        D::insertion::sort_unguarded(g.data() + 1, g.size() - 1, lt);
+        if (!std::is_sorted(g.begin(), g.end())) return false;
+        
+        const size_t n = 50000;
+        size_t lg = 0;
+        for (size_t m = n; m > 1; m >>= 1) ++lg;
+        for (int d = 0; d < 8; ++d) {
+            std::vector<int> a(n);
+            for (size_t i = 0; i < n; ++i) {
+                switch (d) {
+                    case 0: a[i] = static_cast<int>(i); break;
+                    case 1: a[i] = static_cast<int>(n - i); break;
+                    case 2: a[i] = static_cast<int>(i); break;
+                    case 3: a[i] = static_cast<int>(i < n / 2 ? i : n - i); break;
+                    case 4: a[i] = static_cast<int>(i < n / 2 ? n / 2 - i : i - n / 2); break;
+                    case 5: a[i] = static_cast<int>(i % 1000); break;
+                    case 6: a[i] = static_cast<int>((i * 2 + (i & 1) * n) % (n + 1)); break;
+                    default: a[i] = static_cast<int>(i % 2 ? i : n - i); break;
+                }
+            }
+            if (d == 2) for (int k = 0; k < 8; ++k) std::swap(a[rng() % n], a[rng() % n]);
+            auto b = a;
+            size_t calls = 0;
+            auto counted = [&calls](int x, int y) { ++calls; return x < y; };
+            D::pdq::sort(a.data(), n, counted);
+            std::sort(b.begin(), b.end());
+            if (a != b) return false;
+            // 有序/逆序/近似有序应接近线性；其余模式不得退化到平方级
+            size_t bound = d <= 2 ? 8 * n : 3 * n * lg;
+            if (calls > bound) return false;
+        }
+        return true;
+    });
+    
     test("大对象排序", [&]() {
         std::vector<Large> a(1000);
         for (int i = 0; i < 1000; ++i) a[i].key = static_cast<int>(rng() % 10000);
@@ -4420,6 +9854,343 @@ int main() {
         std::sort(b.begin(), b.end());
         return a == b;
     });
+
+    test("排名/逆置换 (rank)", [&]() {
+        for (size_t n : {10, 5000}) {
+            std::vector<int> a(n);
+            for (auto& x : a) x = static_cast<int>(rng() % 50) - 25;
+            auto [idx, ord] = fyx::argsort_with_rank(a);
+            auto mn = fyx::rank(a, fyx::RankMethod::Min);
+            auto dn = fyx::rank(a, std::less<int>{}, fyx::RankMethod::Dense);
+            for (size_t i = 0; i < n; ++i) {
+                if (ord[idx[i]] != i) return false;
+                if (i > 0 && (a[idx[i]] < a[idx[i-1]] ||
+                              (a[idx[i]] == a[idx[i-1]] && idx[i] < idx[i-1]))) return false;
+                size_t less = 0;
+                std::vector<int> seen;
+                for (size_t j = 0; j < n; ++j) {
+                    if (a[j] < a[i]) { ++less; seen.push_back(a[j]); }
+                }
+                std::sort(seen.begin(), seen.end());
+                size_t distinct = static_cast<size_t>(std::unique(seen.begin(), seen.end()) - seen.begin());
+                if (mn[i] != less || dn[i] != distinct) return false;
+            }
+        }
+        // ±0相等: 基数路径 (默认比较) 与比较路径的三种名次须一致，且与n无关
+        for (size_t n : {10, 100}) {
+            std::vector<double> z(n);
+            const double vals[] = {-1.0, -0.0, 0.0, 1.0};
+            for (auto& x : z) x = vals[rng() % 4];
+            auto cmp = [](double x, double y) { return x < y; };
+            for (auto m : {fyx::RankMethod::Ordinal, fyx::RankMethod::Min, fyx::RankMethod::Dense}) {
+                if (fyx::rank(z, m) != fyx::rank(z, cmp, m)) return false;
+            }
+        }
+        return true;
+    });
+
+    test("分段排序 (segmented)", [&]() {
+        std::vector<uint32_t> offsets = {0};
+        while (offsets.back() < 200000) {
+            offsets.push_back(offsets.back() + 2 + static_cast<uint32_t>(rng() % 499));
+        }
+        offsets.push_back(offsets.back() + 20000);
+        std::vector<int> a(offsets.back());
+        for (auto& x : a) x = static_cast<int>(rng());
+        auto b = a;
+        fyx::segmented_sort(a, offsets);
+        for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+            std::sort(b.begin() + offsets[s], b.begin() + offsets[s + 1]);
+        }
+        if (a != b) return false;
+        
+        // 稳定模式: 只按键比较，等键元素须保持原有次序 (各级段长都要覆盖)
+        std::vector<std::pair<int, int>> p(offsets.back());
+        for (size_t i = 0; i < p.size(); ++i) p[i] = {static_cast<int>(rng() % 5), static_cast<int>(i)};
+        auto q = p;
+        auto key_less = [](const std::pair<int, int>& x, const std::pair<int, int>& y) { return x.first < y.first; };
+        fyx::segmented_sort(p, offsets, key_less, fyx::Options::stable_sort());
+        for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+            std::stable_sort(q.begin() + offsets[s], q.begin() + offsets[s + 1], key_less);
+        }
+        return p == q;
+    });
+
+    test("部分排序 (partial_sort)", [&]() {
+        for (size_t k : {1, 20, 1000, 50000, 99999, 100000}) {
+            std::vector<int64_t> a(100000);
+            for (auto& x : a) x = static_cast<int64_t>(rng() % 20000) - 10000;
+            std::vector<std::pair<int, int>> p(a.size());
+            for (size_t i = 0; i < p.size(); ++i) p[i] = {static_cast<int>(a[i] % 97), static_cast<int>(i)};
+            auto b = a;
+            auto q = p;
+            fyx::partial_sort(a.begin(), a.begin() + k, a.end());
+            fyx::partial_sort(p.begin(), p.begin() + k, p.end(), std::greater<>{});
+            std::sort(b.begin(), b.end());
+            std::sort(q.begin(), q.end(), std::greater<>{});
+            if (!std::equal(b.begin(), b.begin() + k, a.begin())) return false;
+            if (!std::equal(q.begin(), q.begin() + k, p.begin())) return false;
+        }
+        return true;
+    });
+    
+    test("字符串排序 (MSD + 多键快排)", [&]() {
+        const char* hosts[] = {"https://a.com/", "https://a.com/x/", "https://b.org/", "http://"};
+        for (size_t n : {5, 100, 3000, 60000}) {
+            std::vector<std::string> a(n);
+            for (auto& x : a) {
+                x = (rng() % 4 == 0) ? std::string() : hosts[rng() % 4];
+                size_t len = rng() % 12;
+                for (size_t j = 0; j < len; ++j) x.push_back(static_cast<char>(rng() % 4 == 0 ? 0 : 'a' + rng() % 3));
+            }
+            auto b = a;
+            fyx::sort(a);
+            std::sort(b.begin(), b.end());
+            if (a != b) return false;
+            
+            std::vector<std::string_view> v(b.rbegin(), b.rend());
+            fyx::sort(v);
+            if (!std::equal(v.begin(), v.end(), b.begin())) return false;
+            
+            std::vector<const char*> c;
+            for (auto& x : b) c.push_back(x.c_str());
+            std::shuffle(c.begin(), c.end(), rng);
+            fyx::sort(c, fyx::CStringLess{});
+            if (!std::is_sorted(c.begin(), c.end(), fyx::CStringLess{})) return false;
+        }
+        return true;
+    });
+    
+    test("并行字符串样本排序", [&]() {
+        fyx::Options par;
+        par.max_threads = 4;
+        for (int kind = 0; kind < 4; ++kind) {
+            std::vector<std::string> a(150000);
+            for (auto& x : a) {
+                // 0: 共同前缀超过8字节 (触发相等桶递归) 1: 随机 2: 大量重复 3: 数百字节的共同前缀
+                if (kind == 0) x = "https://example.com/";
+                if (kind == 3) x.assign(300, 'p');
+                size_t len = kind == 2 ? 3 : rng() % 16;
+                for (size_t j = 0; j < len; ++j) x.push_back(static_cast<char>('a' + rng() % (kind == 2 ? 2 : 26)));
+            }
+            auto b = a;
+            std::sort(b.begin(), b.end());
+            auto c = a;
+            fyx::sort(a, par);
+            if (a != b) return false;
+            
+            std::vector<const char*> p;
+            for (auto& x : c) p.push_back(x.c_str());
+            fyx::sort(p, fyx::CStringLess{}, par);
+            for (size_t i = 0; i < p.size(); ++i) if (b[i] != p[i]) return false;
+        }
+        // 强制比较也不能让短串 (SSO) 走按字节搬运; 非平凡类型直接调用超采样分发同样须保持完整
+        {
+            std::vector<std::string> s(150000);
+            for (auto& x : s) x = std::to_string(rng() % 100000);
+            auto r = s;
+            std::sort(r.begin(), r.end());
+            auto t = s;
+            fyx::Options fc = par;
+            fc.force_comparison = true;
+            fyx::sort(s, fc);
+            if (s != r) return false;
+            fyx::detail::parallel::parallel_supersample(t.data(), t.size(), std::greater<std::string>(), par);
+            if (!std::equal(t.begin(), t.end(), r.rbegin())) return false;
+        }
+        // 分发缓冲超出内存上限: 仍走并行样本排序，改为原地置换分发
+        size_t saved = fyx::config::available_memory();
+        std::vector<std::string> a(200000);
+        for (auto& x : a) {
+            x = rng() % 2 ? "https://example.com/" : "";
+            for (size_t j = rng() % 16; j > 0; --j) x.push_back(static_cast<char>('a' + rng() % 26));
+        }
+        auto b = a;
+        std::sort(b.begin(), b.end());
+        auto c = a;
+        std::vector<std::string_view> v(c.begin(), c.end());
+        fyx::config::set_memory_limit(a.size() * sizeof(std::string_view));
+        bool in_place = fyx::detail::strsort::parallel_sort(a.data(), a.size(), 0, 4);
+        bool view_in_place = fyx::detail::strsort::parallel_sort(v.data(), v.size(), 0, 4);
+        bool views_ok = true;
+        for (size_t i = 0; i < v.size(); ++i) views_ok &= v[i] == b[i];
+        fyx::sort(c, par);
+        fyx::config::set_memory_limit(saved);
+        return in_place && view_in_place && views_ok && a == b && c == b;
+    });
+    
+    test("定长字节键 (sort_bytes)", [&]() {
+        auto check = [&](auto width_tag, size_t n, int alphabet, size_t threads) {
+            constexpr size_t N = decltype(width_tag)::value;
+            std::vector<unsigned char> buf(n * N);
+            for (auto& c : buf) c = static_cast<unsigned char>(rng() % alphabet);
+            std::vector<std::array<unsigned char, N>> ref(n);
+            if (n) std::memcpy(ref.data(), buf.data(), buf.size());
+            std::sort(ref.begin(), ref.end());
+            fyx::Options o;
+            o.max_threads = threads;
+            fyx::sort_bytes<N>(buf.data(), n, o);
+            return n == 0 || std::memcmp(ref.data(), buf.data(), buf.size()) == 0;
+        };
+        for (size_t n : {0, 1, 40, 1000, 100000}) {
+            if (!check(std::integral_constant<size_t, 16>{}, n, 256, 1)) return false;
+            if (!check(std::integral_constant<size_t, 20>{}, n, 3, 1)) return false;
+            if (!check(std::integral_constant<size_t, 32>{}, n, 256, 4)) return false;
+            if (!check(std::integral_constant<size_t, 5>{}, n, 2, 4)) return false;
+        }
+        return true;
+    });
+    
+    test("偏移量字符串池 (sort_string_offsets)", [&]() {
+        for (size_t n : {0, 1, 300, 20000}) {
+            std::string pool;
+            std::vector<uint32_t> off32{0};
+            std::vector<std::string> ref;
+            for (size_t i = 0; i < n; ++i) {
+                std::string x = (rng() % 2) ? "key:" : "";
+                size_t len = rng() % 14;
+                for (size_t j = 0; j < len; ++j) x.push_back(static_cast<char>('a' + rng() % 3));
+                pool += x;
+                off32.push_back(static_cast<uint32_t>(pool.size()));
+                ref.push_back(x);
+            }
+            std::vector<uint64_t> off64(off32.begin(), off32.end());
+            
+            auto perm = fyx::sort_string_offsets(pool.data(), off32.data(), n);
+            std::vector<std::string> sorted_ref = ref;
+            std::sort(sorted_ref.begin(), sorted_ref.end());
+            for (size_t i = 0; i < n; ++i) if (ref[perm[i]] != sorted_ref[i]) return false;
+            
+            fyx::sort_string_offsets_inplace(pool.data(), off64.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                if (pool.compare(off64[i], off64[i + 1] - off64[i], sorted_ref[i]) != 0) return false;
+            }
+        }
+        
+        // 下标类型装不下n-1时拒绝，而不是写出截断的伪置换
+        std::string pool;
+        std::vector<uint32_t> off{0};
+        for (size_t i = 0; i < 600; ++i) {
+            pool.push_back(static_cast<char>('a' + rng() % 26));
+            off.push_back(static_cast<uint32_t>(pool.size()));
+        }
+        std::vector<uint8_t> p8(600);
+        fyx::sort_string_offsets(pool.data(), off.data(), 256, p8.data());
+        std::vector<bool> seen(256, false);
+        for (size_t i = 0; i < 256; ++i) seen[p8[i]] = true;
+        if (std::find(seen.begin(), seen.end(), false) != seen.end()) return false;
+        try {
+            fyx::sort_string_offsets(pool.data(), off.data(), 600, p8.data());
+            return false;
+        } catch (const std::length_error&) {}
+        return true;
+    });
+    
+    test("LCP稳定归并 (stable_sort_lcp)", [&]() {
+        for (size_t n : {1, 17, 500, 20000}) {
+            std::vector<std::string> pool(n);
+            for (auto& x : pool) {
+                size_t len = rng() % 10;
+                for (size_t j = 0; j < len; ++j) x.push_back(static_cast<char>('a' + rng() % 3));
+            }
+            // 两份内容相同、地址不同的string_view，可以检验稳定性
+            std::vector<std::string> copy = pool;
+            std::vector<std::string_view> v;
+            for (size_t i = 0; i < n; ++i) { v.push_back(pool[i]); v.push_back(copy[i]); }
+            std::shuffle(v.begin(), v.end(), rng);
+            auto ref = v;
+            std::stable_sort(ref.begin(), ref.end());
+            
+            auto lcp = fyx::stable_sort_lcp(v);
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (v[i] != ref[i] || v[i].data() != ref[i].data()) return false;
+                size_t h = 0;
+                if (i > 0) while (h < v[i].size() && h < v[i-1].size() && v[i][h] == v[i-1][h]) ++h;
+                if (lcp[i] != h) return false;
+            }
+            
+            std::vector<std::string_view> w(ref.rbegin(), ref.rend());
+            fyx::stable_sort(w);
+            if (w != ref) return false;
+        }
+        return true;
+    });
+    
+    test("融合去重 (sort_unique_count)", [&]() {
+        // 小值域走计数路径，大值域走LSD去重路径，负数/跨零/全相等都覆盖
+        for (uint64_t range : {1ull, 1000ull, 1ull << 40}) {
+            for (size_t n : {0, 1, 100, 5000, 200000}) {
+                std::vector<int64_t> a(n);
+                for (auto& x : a) x = static_cast<int64_t>(rng() % range) - static_cast<int64_t>(range / 2);
+                auto [vals, cnts] = fyx::sort_unique_count(a);
+                std::map<int64_t, size_t> ref;
+                for (auto x : a) ++ref[x];
+                if (vals.size() != ref.size() || cnts.size() != ref.size()) return false;
+                size_t i = 0;
+                for (auto& [v, c] : ref) {
+                    if (vals[i] != v || cnts[i] != c) return false;
+                    ++i;
+                }
+                auto b = a;
+                if (fyx::sort_unique(b) != ref.size() || b != vals) return false;
+            }
+        }
+        std::vector<uint16_t> u(70000);
+        for (auto& x : u) x = static_cast<uint16_t>(rng());
+        auto su = fyx::sort_unique_count(u);
+        std::vector<std::string> s = {"b", "a", "c", "a", "b", "a"};
+        auto ss = fyx::sort_unique_count(s);
+        return std::accumulate(su.second.begin(), su.second.end(), size_t(0)) == u.size() &&
+               std::is_sorted(su.first.begin(), su.first.end()) &&
+               ss.first == std::vector<std::string>{"a", "b", "c"} &&
+               ss.second == std::vector<size_t>{3, 2, 1};
+    });
+    
+    test("选择/分位数 (nth_element)", [&]() {
+        std::vector<uint32_t> lat(300000);
+        for (auto& x : lat) x = static_cast<uint32_t>(rng() % 5000 + (rng() % 100 == 0 ? rng() % 1000000 : 0));
+        auto ref = lat;
+        std::sort(ref.begin(), ref.end());
+        
+        auto a = lat;
+        fyx::nth_element(a.begin(), a.begin() + 12345, a.end());
+        if (a[12345] != ref[12345]) return false;
+        for (size_t i = 0; i < 12345; ++i) if (a[i] > a[12345]) return false;
+        for (size_t i = 12346; i < a.size(); ++i) if (a[i] < a[12345]) return false;
+        
+        auto q = fyx::quantiles(lat, {0.5, 0.99, 0.0, 1.0, 0.999});
+        size_t last = ref.size() - 1;
+        if (q[0] != ref[static_cast<size_t>(0.5 * last + 0.5)] ||
+            q[1] != ref[static_cast<size_t>(0.99 * last + 0.5)]) return false;
+        if (q[2] != ref[0] || q[3] != ref[last]) return false;
+        if (q[4] != ref[static_cast<size_t>(0.999 * last + 0.5)]) return false;
+        
+        std::vector<double> d(100001);
+        for (auto& x : d) x = static_cast<double>(rng() % 100000) / 7.0;
+        auto dr = d;
+        std::sort(dr.begin(), dr.end());
+        if (fyx::median(d) != dr[50000] || fyx::kth_element(d, 777) != dr[777]) return false;
+        
+        // 低并行阈值: 区间/子桶不足两块时并行直方图须退回顺序计数
+        fyx::Options po; po.max_threads = 4; po.parallel_threshold = 1000;
+        for (size_t m : {2047, 4096, 20000}) {
+            std::vector<int8_t> b(m);
+            std::vector<int16_t> h(m);
+            for (auto& x : b) x = static_cast<int8_t>(rng());
+            for (auto& x : h) x = static_cast<int16_t>(rng());
+            auto br = b; std::sort(br.begin(), br.end());
+            auto hr = h; std::sort(hr.begin(), hr.end());
+            auto b1 = b;
+            fyx::nth_element(b1.begin(), b1.begin() + m / 3, b1.end(), po);
+            if (b1[m / 3] != br[m / 3]) return false;
+            auto h1 = h;
+            fyx::nth_element(h1.begin(), h1.begin() + m / 2, h1.end(), po);
+            if (h1[m / 2] != hr[m / 2]) return false;
+            fyx::partial_sort(h.begin(), h.begin() + 100, h.end(), po);
+            if (!std::equal(h.begin(), h.begin() + 100, hr.begin())) return false;
+        }
+        return true;
+    });
     
     if (!all_ok) {
         std::cout << "\n!!! 测试失败 !!!\n";
@@ -4469,6 +10240,78 @@ int main() {
     
     for (size_t n : {5000, 20000, 50000})
         bench<Large>("Large(256B)", n, [](auto& g) { Large l; l.key = static_cast<int>(g()); return l; });
+    std::cout << std::string(85, '─') << "\n";
+    
+    for (size_t n : {10000, 100000, 1000000})
+        bench<std::string>("string(URL)", n, [](auto& g) {
+            std::string s = "https://example.com/item/";
+            for (int j = 0, len = static_cast<int>(g() % 24); j < len; ++j) s.push_back(static_cast<char>('a' + g() % 26));
+            return s;
+        });
+    for (size_t n : {100000, 1000000})
+        bench<std::string>("string(随机8-20B)", n, [](auto& g) {
+            std::string s;
+            for (int j = 0, len = static_cast<int>(8 + g() % 13); j < len; ++j) s.push_back(static_cast<char>('a' + g() % 26));
+            return s;
+        });
+    std::cout << std::string(85, '─') << "\n";
+    
+    for (double ratio : {0.001, 0.01, 0.1, 0.5})
+        bench_partial<int>("partial_sort k/n", 1000000, ratio, [](auto& g) { return static_cast<int>(g()); });
+    for (double ratio : {0.001, 0.01, 0.1, 0.5})
+        bench_partial<double>("partial_sort(double)", 1000000, ratio, [](auto& g) {
+            return std::uniform_real_distribution<>(-1e9, 1e9)(g);
+        });
+
+    std::cout << "\n" << std::setw(22) << "pdq模式(自定义比较)" << " │ "
+              << std::setw(10) << "大小" << " │ "
+              << std::setw(14) << "FYX" << " │ "
+              << std::setw(14) << "std" << " │ "
+              << std::setw(9) << "加速比" << " │ 状态\n";
+    std::cout << std::string(85, '─') << "\n";
+    {
+        const size_t n = 1000000;
+        bench_pattern<int>("随机", n, [](auto& g, size_t, size_t) { return static_cast<int>(g()); });
+        bench_pattern<int>("有序", n, [](auto&, size_t i, size_t) { return static_cast<int>(i); });
+        bench_pattern<int>("逆序", n, [](auto&, size_t i, size_t m) { return static_cast<int>(m - i); });
+        bench_pattern<int>("近似有序(1%扰动)", n, [](auto& g, size_t i, size_t) {
+            return static_cast<int>(g() % 100 == 0 ? g() : i);
+        });
+        bench_pattern<int>("风琴管", n, [](auto&, size_t i, size_t m) {
+            return static_cast<int>(i < m / 2 ? i : m - i);
+        });
+        bench_pattern<int>("锯齿(周期1000)", n, [](auto&, size_t i, size_t) { return static_cast<int>(i % 1000); });
+        bench_pattern<int>("少量不同值(16)", n, [](auto& g, size_t, size_t) { return static_cast<int>(g() % 16); });
+    }
+
+#ifdef FYX_AVX512CD_KERNELS
+    if (fyx::detail::simd::active_isa() == fyx::detail::simd::Isa::AVX512 &&
+        fyx::cpu::get_features().avx512cd) {
+        std::cout << "\n" << std::setw(22) << "直方图" << " │ "
+                  << std::setw(10) << "大小" << " │ "
+                  << std::setw(14) << "分散计数" << " │ "
+                  << std::setw(14) << "冲突检测" << " │ "
+                  << std::setw(8) << "选用" << " │ 状态\n";
+        std::cout << std::string(85, '─') << "\n";
+        const size_t n = 1000000;
+        bench_histogram<uint32_t>("u32均匀", n, [](auto& g) { return static_cast<uint32_t>(g()); });
+        bench_histogram<uint32_t>("u32倾斜(90%同值)", n, [](auto& g) {
+            return g() % 10 < 9 ? 7u : static_cast<uint32_t>(g());
+        });
+        bench_histogram<uint32_t>("u32指数分布", n, [](auto& g) {
+            return static_cast<uint32_t>(std::exponential_distribution<>(0.1)(g));
+        });
+        bench_histogram<uint32_t>("u32单值", n, [](auto&) { return 7u; });
+        bench_histogram<uint64_t>("u64均匀", n, [](auto& g) { return (uint64_t(g()) << 32) | g(); });
+        bench_histogram<uint64_t>("u64倾斜(90%同值)", n, [](auto& g) {
+            return g() % 10 < 9 ? uint64_t(7) : (uint64_t(g()) << 32) | g();
+        });
+        bench_histogram<uint8_t>("u8均匀", n, [](auto& g) { return static_cast<uint8_t>(g()); });
+        bench_histogram<uint8_t>("u8倾斜(90%同值)", n, [](auto& g) {
+            return static_cast<uint8_t>(g() % 10 < 9 ? 7 : g());
+        });
+    }
+#endif
     
     std::cout << "\n═══════════════════════════════════════════════════════════\n";
     std::cout << "                    测试完成！\n";